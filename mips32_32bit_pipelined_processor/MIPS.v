@@ -20,127 +20,991 @@
 //////////////////////////////////////////////////////////////////////////////////
 
 
-module MIPS(input clk1 , input clk2
+module MIPS #(parameter FORWARDING = 1 ,
+    parameter BPRED = 1 ,          // dynamic branch prediction in IF
+    parameter BTB_ENTRIES = 16 ,   // branch target buffer , power of two >= 2
+    parameter PHT_ENTRIES = 64 ,   // 2-bit saturating counters , power of two >= 2
+    parameter RAS_ENTRIES = 8 ,    // return-address stack , 0 (JR always through the BTB) or a power of two >= 2
+    parameter EARLY_BRANCH = 0 ,   // resolve BEQZ/BNEQZ/JR in ID instead of EX
+    parameter IMEM_DEPTH = 1024 ,  // instruction / data memory size in words , power of two
+    parameter DMEM_DEPTH = 1024 ,
+    parameter IMEM_INIT = "" ,     // optional $readmemh images
+    parameter DMEM_INIT = "" ,
+    parameter ICACHE = 0 ,         // fetch through ICACHE (icache.v) from a slow IMEM line port
+    parameter IC_SETS = 16 ,
+    parameter IC_WAYS = 2 ,
+    parameter IC_LINE_WORDS = 4 ,
+    parameter IMEM_LATENCY = 8 ,   // clk1 cycles per IMEM line read
+    parameter DCACHE = 0 ,         // loads / stores through DCACHE (dcache.v) to a slow DMEM line port
+    parameter DC_SETS = 16 ,
+    parameter DC_WAYS = 2 ,
+    parameter DC_LINE_WORDS = 4 ,
+    parameter DC_SB_ENTRIES = 4 ,  // coalescing store buffer words
+    parameter DMEM_LATENCY = 8 ,   // clk2 cycles per DMEM line read / write
+    parameter MUL_LATENCY = 0 ,    // 0 : MUL in the EX ALU , n : n-stage multiplier in the MDU
+    parameter DUAL_ISSUE = 0 ,     // fetch two words , issue a second ALU op beside the first
+    parameter OOO_COMPLETE = 0 ,   // a D-cache load miss leaves MEM and completes out of order
+    parameter DC_MSHRS = 4 ,       // load misses outstanding at once with OOO_COMPLETE
+    parameter DMEM_AXI = 0 ,       // with DCACHE : refills / write-backs as AXI4 bursts on M_AXI_* instead of DMEM
+    parameter FQ_DEPTH = 0 ,       // fetch queue entries behind IF_ID , 0 : IF holds while ID stalls
+    parameter LB_ENTRIES = 0 ,     // loop buffer words , 0 or a power of two >= 2
+    parameter EXC_VECTOR = 32'h100 // IMEM word address of the trap handler
+    ) (input clk1 , input clk2 ,
+    input reset ,  // ACTIVE HIGH , hold it across at least one clk1 and one clk2 edge
+    input irq ,    // external interrupt , a rising edge is latched on clk1 (tie low when unused)
 
+    // AXI4 master (DMEM_AXI) , clocked by clk2 , byte addresses
+    output [31:0] M_AXI_ARADDR , output [7:0] M_AXI_ARLEN , output [2:0] M_AXI_ARSIZE , output [1:0] M_AXI_ARBURST ,
+    output M_AXI_ARVALID , input M_AXI_ARREADY ,
+    input [31:0] M_AXI_RDATA , input [1:0] M_AXI_RRESP , input M_AXI_RLAST , input M_AXI_RVALID , output M_AXI_RREADY ,
+    output [31:0] M_AXI_AWADDR , output [7:0] M_AXI_AWLEN , output [2:0] M_AXI_AWSIZE , output [1:0] M_AXI_AWBURST ,
+    output M_AXI_AWVALID , input M_AXI_AWREADY ,
+    output [31:0] M_AXI_WDATA , output [3:0] M_AXI_WSTRB , output M_AXI_WLAST , output M_AXI_WVALID , input M_AXI_WREADY ,
+    input [1:0] M_AXI_BRESP , input M_AXI_BVALID , output M_AXI_BREADY
     );
     reg [31:0] PC, IF_ID_IR , IF_ID_NPC;
     reg [31:0] ID_EX_IR , ID_EX_NPC , ID_EX_A , ID_EX_B , ID_EX_IMM ;
-    reg [31:0] EX_MEM_B, EX_MEM_IR , EX_MEM_COND , EX_MEM_ALUOUT;
+    reg [31:0] EX_MEM_B, EX_MEM_IR , EX_MEM_COND , EX_MEM_ALUOUT , EX_MEM_NPC;
+    reg IF_ID_PRED , ID_EX_PRED , EX_MEM_PRED;   // fetch went down the predicted-taken path
+    reg [31:0] IF_ID_PTGT , ID_EX_PTGT , EX_MEM_PTGT;   // ... to this target
+    reg IF_ID_VALID;                             // 0 : fetch stalled , ID decodes a bubble
     reg [31:0] MEM_WB_LMD , MEM_WB_IR , MEM_WB_ALUOUT;
     reg [2:0] ID_EX_TYPE , EX_MEM_TYPE , MEM_WB_TYPE ;
+    // second slot (DUAL_ISSUE) : an ALU op issued with the one above , NOP otherwise
+    reg [31:0] IF_ID_IR2 , ID_EX_IR2 , ID_EX_A2 , ID_EX_B2 , ID_EX_IMM2 , EX_MEM_IR2 , EX_MEM_ALUOUT2 ,
+               MEM_WB_IR2 , MEM_WB_ALUOUT2;
+    reg IF_ID_VALID2;                            // IF_ID_IR2 is the word after IF_ID_IR on the fetched path
+    reg [2:0] ID_EX_TYPE2 , EX_MEM_TYPE2 , MEM_WB_TYPE2;
     
     reg[31:0] Reg [31:0];
-    reg [31:0] Mem [1023:0];
     parameter ADD = 6'b000000 , SUB = 6'b000001 , AND  = 6'b000010 , OR = 6'b000011 ,
-    SLT = 6'b000100, MUL = 6'b000101, HLT = 6'b111111 , 
+    SLT = 6'b000100, MUL = 6'b000101, DIV = 6'b000110 , REM = 6'b000111 , HLT = 6'b111111 , 
     LW = 6'b001000 , SW = 6'b001001 , ADDI = 6'b001010 , SUBI = 6'b001011,
-    SLTI = 6'b001100 , BNEQZ = 6'b001101 , BEQZ = 6'b001110 ;
+    SLTI = 6'b001100 , BNEQZ = 6'b001101 , BEQZ = 6'b001110 ,
+    J = 6'b010000 , JAL = 6'b010001 , JR = 6'b010010 , ERET = 6'b010011 ,
+    ADDB = 6'b010100 , SUBB = 6'b010101 , ADDH = 6'b010110 , SUBH = 6'b010111 , ADDUSB = 6'b011000 ,
+    ADDUSH = 6'b011001 , CMPEQB = 6'b011010 , CMPEQH = 6'b011011 , CMPLTB = 6'b011100 , CMPLTH = 6'b011101 ,
+    SUMB = 6'b011110 , LOOP = 6'b011111 ;
     
-    parameter RR_ALU = 3'B000 , RM_ALU = 3'b001 , LOAD = 3'b010 , STORE = 3'b011, BRANCH = 3'b100, HALT = 3'b101;
+    parameter RR_ALU = 3'B000 , RM_ALU = 3'b001 , LOAD = 3'b010 , STORE = 3'b011, BRANCH = 3'b100, HALT = 3'b101,
+    NOP = 3'b110 ,  // bubble : squashed or stalled slot, never writes anything
+    MDU = 3'b111;   // handed to the multiply / divide unit in EX , written back by it
+    
+    // PACKED SIMD ALU
+    // RR_ALU ops on four byte or two halfword lanes of rs and rt : ADD / SUB
+    // wrap in the lane , ADDUS saturates at its maximum , CMPEQ / CMPLT
+    // (unsigned) give an all-ones lane when true. SUMB adds the four bytes
+    // of rs to rt , a byte checksum or , after a CMPEQB and an AND with
+    // 32'h01010101 , a match count.
+    function [31:0] SIMD;
+    input [5:0] op; input [31:0] a , b;
+    integer l;
+    reg [8:0] s8;
+    reg [16:0] s16;
+    begin
+    SIMD = 0;
+    for (l = 0; l < 4; l = l + 1) begin
+    s8 = a[l*8 +: 8] + b[l*8 +: 8];
+    case (op)
+    ADDB : SIMD[l*8 +: 8] = s8[7:0];
+    SUBB : SIMD[l*8 +: 8] = a[l*8 +: 8] - b[l*8 +: 8];
+    ADDUSB : SIMD[l*8 +: 8] = s8[8] ? 8'hff : s8[7:0];
+    CMPEQB : SIMD[l*8 +: 8] = (a[l*8 +: 8] == b[l*8 +: 8]) ? 8'hff : 8'h00;
+    CMPLTB : SIMD[l*8 +: 8] = (a[l*8 +: 8] < b[l*8 +: 8]) ? 8'hff : 8'h00;
+    endcase
+    end
+    for (l = 0; l < 2; l = l + 1) begin
+    s16 = a[l*16 +: 16] + b[l*16 +: 16];
+    case (op)
+    ADDH : SIMD[l*16 +: 16] = s16[15:0];
+    SUBH : SIMD[l*16 +: 16] = a[l*16 +: 16] - b[l*16 +: 16];
+    ADDUSH : SIMD[l*16 +: 16] = s16[16] ? 16'hffff : s16[15:0];
+    CMPEQH : SIMD[l*16 +: 16] = (a[l*16 +: 16] == b[l*16 +: 16]) ? 16'hffff : 16'h0000;
+    CMPLTH : SIMD[l*16 +: 16] = (a[l*16 +: 16] < b[l*16 +: 16]) ? 16'hffff : 16'h0000;
+    endcase
+    end
+    if (op == SUMB) SIMD = a[7:0] + a[15:8] + a[23:16] + a[31:24] + b;
+    end
+    endfunction
     reg HALTED;
     reg BRANCH_TAKEN ;
+    reg HAZARD_STALL;          // ID inserted a bubble , IF_ID_IR is held on the next clk1 (IF holds PC or queues)
+    reg [31:0] STALL_CYCLES;   // number of bubbles inserted by the interlock
+    reg [31:0] BP_BRANCHES , BP_HITS;   // resolved branches , of which correctly predicted
+    reg [31:0] FETCH_STALLS;            // clk1 cycles IF waited on the instruction cache
+    reg MEM_BUSY;                       // MEM waited on the data cache , IF and EX hold on the next clk1
+    reg [31:0] MEM_STALLS;              // clk2 cycles MEM waited on the data cache
+    reg [31:0] CYCLES , RETIRED;        // clk1 periods since reset , WB commits
+    reg [31:0] BRANCH_FLUSHES;          // fetch redirects (BRANCH_TAKEN pulses)
+    reg [31:0] MDU_STALLS;              // ID bubbles waiting on the multiply / divide unit
+    reg [31:0] ISSUE_PAIRS;             // ID issues that filled both slots
+    reg [31:0] TRAPS;                   // traps taken , interrupts and reserved instructions
+    reg [31:0] LB_HITS;                 // fetches served by the loop buffer , IMEM / I-cache not read
+    reg [31:0] FQ_STALLS_HIDDEN;        // FETCH_STALLS cycles ID still took an instruction from the fetch queue
+                                        // (I-cache misses , so 0 without ICACHE) ; the queue moves fetches , it saves none
     
-        always@(posedge clk1)begin  //if stage (instruction stage )
-        if (HALTED == 0)begin 
-        if (((EX_MEM_IR[31:26] == BEQZ) && (EX_MEM_COND==1) )|| ((EX_MEM_IR[31:26] == BNEQZ)&& (EX_MEM_COND ==0)))
-        begin 
-        IF_ID_IR <= Mem[EX_MEM_ALUOUT];
-        BRANCH_TAKEN <= 1'b1;
-        IF_ID_NPC <= EX_MEM_ALUOUT +1;
-        PC <= EX_MEM_ALUOUT +1;
+    // PERFORMANCE COUNTERS
+    // Mapped read-only at PERF_BASE + n , e.g. LW R1, -256(R0) reads CYCLES.
+    // Loads there bypass DMEM / DCACHE and stores there are dropped.
+    //   0 CYCLES        1 RETIRED      2 BRANCH_FLUSHES  3 STALL_CYCLES
+    //   4 MEM_STALLS    5 FETCH_STALLS 6 BP_BRANCHES     7 BP_HITS
+    //   8 MDU_STALLS    9 ISSUE_PAIRS  10 TRAPS
+    // followed by the trap registers (read / write , see TRAPS below)
+    //  11 STATUS        12 CAUSE       13 EPC
+    // and the front end's
+    //  14 LB_HITS       15 FQ_STALLS_HIDDEN
+    parameter PERF_BASE = 32'hFFFFFF00;  // 16 words
+    wire PERF_ACCESS = (EX_MEM_ALUOUT[31:4] == PERF_BASE[31:4]);
+    reg [31:0] PERF_RDATA;
+    
+    // BRANCH PREDICTOR
+    // The BTB holds the target of taken branches (tag = upper PC bits) and the
+    // PHT a 2-bit saturating counter per PC index. Fetch follows the BTB
+    // target when the entry hits and the counter is 1x. Both are trained when
+    // the branch resolves.
+    localparam BTB_BITS = $clog2(BTB_ENTRIES) , PHT_BITS = $clog2(PHT_ENTRIES);
+    reg [BTB_ENTRIES-1:0] BTB_VALID;
+    reg [31-BTB_BITS:0] BTB_TAG [0:BTB_ENTRIES-1];
+    reg [31:0] BTB_TARGET [0:BTB_ENTRIES-1];
+    reg [1:0] PHT [0:PHT_ENTRIES-1];
+    integer i;
+    
+    // RETURN-ADDRESS STACK
+    // J / JAL carry their target , IF follows them on the fetch edge and they
+    // never redirect. JAL also pushes its NPC and JR R31 pops the top as its
+    // predicted target (any other JR goes through the BTB like a branch).
+    // RAS_SP is the next free entry and wraps , the oldest return is lost
+    // when the calls nest deeper. Every fetched instruction carries the
+    // pointer after its own push / pop (*_RASP) ; a redirect restarts from
+    // the resolving one's , which undoes what the wrong path did. An entry a
+    // wrong-path JAL overwrote is above the restored top and pushed again
+    // before it is read.
+    localparam RAS_N = (RAS_ENTRIES > 1) ? RAS_ENTRIES : 2 , RAS_BITS = $clog2(RAS_N);
+    reg [31:0] RAS [0:RAS_N-1];
+    reg [RAS_BITS-1:0] RAS_SP , IF_ID_RASP , ID_EX_RASP , EX_MEM_RASP;
+    
+    // HARDWARE LOOP
+    // LOOP rs, end : the instructions after it up to and including end run
+    // rs times. IF compares FETCH_PC with LOOP_END ; on a match it counts the
+    // iteration down and , while the count stays above 0 , fetches
+    // LOOP_START next the way it follows a J , so the body ends with no
+    // branch , no counter update and no bubble. LOOP sets the registers where
+    // a branch resolves : from ID with EARLY_BRANCH , in time for the fetch
+    // right behind it (see FETCH QUEUE) , otherwise from EX_MEM with a
+    // redirect to the body's start (one squashed slot per loop , not per
+    // iteration). Like the RAS
+    // pointer , every fetched instruction carries the count after its own
+    // fetch (*_LCNT) and whether it was the end (*_LEND) , so a redirect or
+    // trap puts back the count the wrong path used up. With DUAL_ISSUE the
+    // end is never fetched as the second word. The end must not be a branch
+    // or jump , loops do not nest.
+    reg [31:0] LOOP_START , LOOP_END , LOOP_COUNT;
+    reg [31:0] IF_ID_LCNT , ID_EX_LCNT , EX_MEM_LCNT;
+    reg IF_ID_LEND , ID_EX_LEND , EX_MEM_LEND;
+    wire EX_MEM_LOOP = (EX_MEM_TYPE == BRANCH) && (EX_MEM_IR[31:26] == LOOP);
+    
+    // FETCH QUEUE
+    // With FQ_DEPTH > 0 IF keeps fetching while ID stalls , into FQ behind
+    // IF_ID (FQ[0] next , FQ_COUNT taken) , and ID takes from the queue while
+    // IF waits on an I-cache miss (FQ_STALLS_HIDDEN). Each entry is everything
+    // IF hands to ID (FETCH_ENTRY). A redirect , a trap or an ID_SPLIT refetch
+    // empties it , and so does LOOP from ID when the body's first words are
+    // already queued : it redirects to them like LOOP from EX_MEM. With the
+    // ideal IMEM IF delivers a word per cycle anyway and nothing changes but
+    // the order IMEM is read in.
+    // LOOP BUFFER
+    // LB_ENTRIES words of the loop IF is in : a taken fetch (predicted branch
+    // , J , LOOP end) back to at most LB_ENTRIES - 1 words before itself
+    // makes [target , itself] the buffer's range. Words in the range fill as
+    // they are fetched , from then on a fetch in the range (both words of a
+    // wide fetch) comes from the buffer and IMEM / the I-cache are not read
+    // (LB_HITS). IMEM is read-only , so the copies stay good until another
+    // loop takes the buffer.
+    localparam FQ_N = (FQ_DEPTH > 0) ? FQ_DEPTH : 1;
+    localparam FQ_W = 32 + 32 + 1 + 32 + 1 + 32 + RAS_BITS + 32 + 1;
+    reg [FQ_W-1:0] FQ [0:FQ_N-1];
+    reg [$clog2(FQ_N+1)-1:0] FQ_COUNT;
+    localparam LB_N = (LB_ENTRIES > 1) ? LB_ENTRIES : 2 , LB_BITS = $clog2(LB_N);
+    reg [31:0] LB_WORD [0:LB_N-1];
+    reg [LB_N-1:0] LB_VALID;
+    reg [31:0] LB_START , LB_END;
+    
+    // BRANCH RESOLUTION
+    // The resolved branch is checked against the path fetch took and on a
+    // mispredict fetch is redirected on the next clk1.
+    // EARLY_BRANCH = 0 : resolved from EX_MEM_COND / EX_MEM_ALUOUT. The
+    //   wrong-path instruction is in EX on that clk1 edge and is squashed.
+    // EARLY_BRANCH = 1 : resolved by ID (ID_RES_*) on the clk2 edge right after
+    //   the branch was fetched , so the next fetch already takes the right path
+    //   and nothing is squashed. A load one ahead of the branch costs a bubble.
+    // JR resolves like a taken branch whose target is rs , a predicted one
+    // also redirects when the target was wrong. ERET is a JR to EPC.
+    reg ID_RES_VALID , ID_RES_TAKEN , ID_RES_PRED;
+    reg [31:0] ID_RES_NPC , ID_RES_TARGET , ID_RES_PTGT;
+    reg [RAS_BITS-1:0] ID_RES_RASP;
+    reg ID_RES_LOOP;
+    reg [31:0] ID_RES_LCNT , ID_RES_COUNT;
+    wire EX_MEM_JUMP = (EX_MEM_IR[31:26] == J) || (EX_MEM_IR[31:26] == JAL);
+    wire EX_MEM_TAKEN = ((EX_MEM_IR[31:26] == BEQZ) && (EX_MEM_COND==1)) || ((EX_MEM_IR[31:26] == BNEQZ) && (EX_MEM_COND==0)) ||
+                        (EX_MEM_IR[31:26] == JR) || (EX_MEM_IR[31:26] == ERET);
+    wire RESOLVE_VALID = EARLY_BRANCH ? ID_RES_VALID : ((EX_MEM_TYPE == BRANCH) && !EX_MEM_JUMP && !EX_MEM_LOOP);
+    wire RESOLVE_TAKEN = EARLY_BRANCH ? ID_RES_TAKEN : EX_MEM_TAKEN;
+    wire RESOLVE_PRED = EARLY_BRANCH ? ID_RES_PRED : EX_MEM_PRED;
+    wire [31:0] RESOLVE_PTGT = EARLY_BRANCH ? ID_RES_PTGT : EX_MEM_PTGT;
+    wire [RAS_BITS-1:0] RESOLVE_RASP = EARLY_BRANCH ? ID_RES_RASP : EX_MEM_RASP;
+    wire [31:0] RESOLVE_LCNT = EARLY_BRANCH ? ID_RES_LCNT : EX_MEM_LCNT;
+    wire [31:0] RESOLVE_NPC = EARLY_BRANCH ? ID_RES_NPC : EX_MEM_NPC;
+    wire [31:0] RESOLVE_TARGET = EARLY_BRANCH ? ID_RES_TARGET : EX_MEM_ALUOUT;
+    wire [31:0] RESOLVE_PC = RESOLVE_NPC - 1;
+    wire LOOP_REDIRECT = EARLY_BRANCH ? (ID_RES_LOOP && (FQ_COUNT != 0)) : EX_MEM_LOOP;   // refetch the body
+    wire BRANCH_REDIRECT = (RESOLVE_VALID && ((RESOLVE_TAKEN != RESOLVE_PRED) ||
+                                              (RESOLVE_TAKEN && (RESOLVE_PTGT != RESOLVE_TARGET)))) || LOOP_REDIRECT;
+    wire [31:0] REDIRECT_PC = RESOLVE_TAKEN ? RESOLVE_TARGET : RESOLVE_NPC;
+    
+    // TRAPS
+    // A trap is taken on the clk1 edge where the instruction in EX_MEM leaves
+    // WB , so it is precise : everything older has retired , the one behind
+    // in ID_EX is squashed like a branch shadow and fetch goes to EXC_VECTOR.
+    // An unknown opcode (reserved instruction) decodes to a bubble marked
+    // *_EXC , it traps in its own place with EPC at it and CAUSE 10. An irq
+    // edge is taken behind the next instruction that leaves WB while
+    // STATUS.IE is set and STATUS.EXL clear , with EPC where the program
+    // would have gone next and CAUSE 0. Every trap sets EXL (no interrupt
+    // until it clears) ; ERET jumps to EPC and clears it. The handler finds
+    // the registers in the counter range , a store there writes STATUS
+    // ({EXL , IE}) or EPC. A trap is never taken on a HLT , after HALTED or
+    // while MEM waits on the data cache.
+    reg STATUS_IE , STATUS_EXL;
+    reg [31:0] CAUSE , EPC;
+    reg IRQ_LAST , IRQ_PENDING;
+    reg ID_EX_EXC , EX_MEM_EXC;
+    wire EX_MEM_ERET = (EX_MEM_TYPE == BRANCH) && (EX_MEM_IR[31:26] == ERET);
+    wire CSR_STORE = (EX_MEM_TYPE == STORE) && PERF_ACCESS && !MEM_BUSY && (HALTED == 0);
+    wire [31:0] EX_MEM_NEXT = (EX_MEM_TYPE2 != NOP) ? EX_MEM_NPC + 1 : (EX_MEM_LEND && (EX_MEM_LCNT != 0)) ? LOOP_START :
+                              (EX_MEM_TYPE != BRANCH) ? EX_MEM_NPC :
+                              EX_MEM_JUMP ? {EX_MEM_NPC[31:26] , EX_MEM_IR[25:0]} : EX_MEM_TAKEN ? EX_MEM_ALUOUT : EX_MEM_NPC;
+    wire TRAP_INT = IRQ_PENDING && STATUS_IE && !STATUS_EXL && (EX_MEM_TYPE != NOP) && (EX_MEM_TYPE != HALT);
+    wire TRAP = !reset && (HALTED == 0) && !MEM_BUSY && (EX_MEM_EXC || TRAP_INT);
+    wire [31:0] TRAP_EPC = EX_MEM_EXC ? EX_MEM_NPC - 1 : EX_MEM_NEXT;
+    wire [31:0] ERET_EPC = (CSR_STORE && (EX_MEM_ALUOUT[3:0] == 4'd13)) ? EX_MEM_B : EPC;   // EPC as of this clk1 edge
+    
+    wire EX_SQUASH = TRAP || (!EARLY_BRANCH && BRANCH_REDIRECT);
+    wire FETCH_REDIRECT = BRANCH_REDIRECT || TRAP;
+    
+    // MEMORIES
+    // Harvard : IF reads IMEM at FETCH_PC , MEM reads / writes DMEM on clk2.
+    // With ICACHE the fetch goes through the cache and IMEM only answers line
+    // refills , IMEM_LATENCY cycles each ; IF retries FETCH_PC until it hits.
+    // With DCACHE loads and stores go through the cache on clk2 and DMEM only
+    // answers line refills / write-backs , DMEM_LATENCY cycles each. A load
+    // miss or a full store buffer freezes the pipe (MEM_STALL , MEM_BUSY).
+    // DMEM_AXI (with DCACHE) : the refills / write-backs go out on M_AXI_*
+    // through AXI_MASTER (axi_master.v) instead , one INCR burst of
+    // DC_LINE_WORDS beats per line , and DMEM is left idle.
+    // DUAL_ISSUE : IMEM reads {FETCH_PC+1 , FETCH_PC} (a 64-bit port) into
+    // IF_ID_IR / IF_ID_IR2 and PC steps by two. When ID issues only the first
+    // (ID_SPLIT) the next fetch starts again at the second , so a pair that
+    // cannot issue together costs nothing over single issue. Fetch through
+    // the I-cache stays one word wide.
+    reg ID_SPLIT;
+    localparam FETCH_WIDE = DUAL_ISSUE && !ICACHE;
+    wire [31:0] FETCH_PC = TRAP ? EXC_VECTOR : BRANCH_REDIRECT ? REDIRECT_PC : ID_SPLIT ? IF_ID_NPC : PC;
+    wire FQ_FLUSH = FETCH_REDIRECT || ID_SPLIT;
+    wire FETCH_GO = (HALTED == 0) && !MEM_BUSY && (FETCH_REDIRECT || HAZARD_STALL == 0 || FQ_COUNT != FQ_DEPTH);
+    wire LB_IN = (LB_ENTRIES > 0) && (FETCH_PC >= LB_START) && (FETCH_PC <= LB_END);
+    wire LB_IN2 = (LB_ENTRIES > 0) && (FETCH_PC + 1 >= LB_START) && (FETCH_PC + 1 <= LB_END);
+    wire LB_HIT = LB_IN && LB_VALID[FETCH_PC[LB_BITS-1:0]] && (!FETCH_WIDE || (LB_IN2 && LB_VALID[FETCH_PC[LB_BITS-1:0] + 1'b1]));
+    wire [31:0] IMEM_DATA , IMEM_DATA2 , DMEM_RDATA , IC_RDATA , IC_MEM_ADDR;
+    wire [32*IC_LINE_WORDS-1:0] IC_MEM_LINE;
+    wire IC_HIT , IC_MEM_REQ , IC_MEM_DONE;
+    wire IC_REQ = ICACHE && !reset && FETCH_GO && !LB_HIT;
+    wire FETCH_READY = LB_HIT || (ICACHE ? IC_HIT : 1'b1);
+    wire [31:0] FETCH_DATA = LB_HIT ? LB_WORD[FETCH_PC[LB_BITS-1:0]] : ICACHE ? IC_RDATA : IMEM_DATA;
+    wire [31:0] FETCH_DATA2 = LB_HIT ? LB_WORD[FETCH_PC[LB_BITS-1:0] + 1'b1] : IMEM_DATA2;
+    wire DMEM_WE = !DCACHE && !reset && (HALTED == 0) && (EX_MEM_TYPE == STORE) && (BRANCH_TAKEN == 0) && !PERF_ACCESS;
+    wire [31:0] DC_RDATA , DC_MEM_ADDR;
+    wire [32*DC_LINE_WORDS-1:0] DC_MEM_WLINE , DC_MEM_LINE;
+    wire DC_READY , DC_FLUSHED , DC_MEM_REQ , DC_MEM_WE , DC_MEM_DONE;
+    wire DC_LOAD = DCACHE && !reset && (HALTED == 0) && (EX_MEM_TYPE == LOAD) && !PERF_ACCESS;
+    wire DC_STORE = DCACHE && !reset && (HALTED == 0) && (EX_MEM_TYPE == STORE) && (BRANCH_TAKEN == 0) && !PERF_ACCESS;
+    // OOO_COMPLETE : a load that misses does not freeze the pipe. It is taken
+    // into one of the DC_MSHRS miss registers of the cache and leaves MEM as
+    // an MDU-type slot that writes nothing in WB ; the port stays free for
+    // hits and further misses. The word comes back on DC_FILL_* and goes to
+    // Reg[] through the late write port (see the MDU) , its rd is on the
+    // scoreboard (LM_PENDING) meanwhile. MEM only waits while every MSHR is
+    // taken.
+    reg LM_TAKEN;              // DC_FILL_* written back on the last clk1
+    wire DC_MISS , DC_FILL_VALID;
+    wire [4:0] DC_FILL_TAG;
+    wire [31:0] DC_FILL_DATA , LM_PENDING;
+    wire LM_START = OOO_COMPLETE && DC_LOAD && DC_MISS && DC_READY;
+    wire MEM_STALL = (DC_LOAD || DC_STORE) && !DC_READY;
+    wire [31:0] LOAD_DATA = PERF_ACCESS ? PERF_RDATA : DCACHE ? DC_RDATA : DMEM_RDATA;
+    wire MEM_SYNCED = !DCACHE || DC_FLUSHED;   // after HALTED : DMEM (the AXI slave) holds every store
+    localparam DC_AXI = DMEM_AXI && DCACHE;
+    wire [32*DC_LINE_WORDS-1:0] DMEM_LINE , AXI_LINE;
+    wire DMEM_DONE , AXI_DONE;
+    assign DC_MEM_LINE = DC_AXI ? AXI_LINE : DMEM_LINE;
+    assign DC_MEM_DONE = DC_AXI ? AXI_DONE : DMEM_DONE;
+    
+    IMEM #(.DEPTH(IMEM_DEPTH), .INIT_FILE(IMEM_INIT), .LINE_WORDS(IC_LINE_WORDS), .LATENCY(IMEM_LATENCY)) imem (
+        .addr(FETCH_PC), .data(IMEM_DATA), .data2(IMEM_DATA2),
+        .clk(clk1), .reset(reset), .line_req(IC_MEM_REQ), .line_addr(IC_MEM_ADDR), .line_data(IC_MEM_LINE), .line_done(IC_MEM_DONE));
+    ICACHE #(.SETS(IC_SETS), .WAYS(IC_WAYS), .LINE_WORDS(IC_LINE_WORDS)) icache (
+        .clk(clk1), .reset(reset), .req(IC_REQ), .addr(FETCH_PC), .hit(IC_HIT), .rdata(IC_RDATA),
+        .mem_req(IC_MEM_REQ), .mem_addr(IC_MEM_ADDR), .mem_line(IC_MEM_LINE), .mem_done(IC_MEM_DONE));
+    DMEM #(.DEPTH(DMEM_DEPTH), .INIT_FILE(DMEM_INIT), .LINE_WORDS(DC_LINE_WORDS), .LATENCY(DMEM_LATENCY)) dmem (
+        .clk(clk2), .addr(EX_MEM_ALUOUT), .rdata(DMEM_RDATA), .we(DMEM_WE), .wdata(EX_MEM_B),
+        .reset(reset), .line_req(DC_MEM_REQ && !DC_AXI), .line_we(DC_MEM_WE), .line_addr(DC_MEM_ADDR),
+        .line_wdata(DC_MEM_WLINE), .line_data(DMEM_LINE), .line_done(DMEM_DONE));
+    AXI_MASTER #(.LINE_WORDS(DC_LINE_WORDS)) axi (
+        .clk(clk2), .reset(reset), .line_req(DC_MEM_REQ && DC_AXI), .line_we(DC_MEM_WE), .line_addr(DC_MEM_ADDR),
+        .line_wdata(DC_MEM_WLINE), .line_data(AXI_LINE), .line_done(AXI_DONE),
+        .ARADDR(M_AXI_ARADDR), .ARLEN(M_AXI_ARLEN), .ARSIZE(M_AXI_ARSIZE), .ARBURST(M_AXI_ARBURST),
+        .ARVALID(M_AXI_ARVALID), .ARREADY(M_AXI_ARREADY), .RDATA(M_AXI_RDATA), .RRESP(M_AXI_RRESP),
+        .RLAST(M_AXI_RLAST), .RVALID(M_AXI_RVALID), .RREADY(M_AXI_RREADY),
+        .AWADDR(M_AXI_AWADDR), .AWLEN(M_AXI_AWLEN), .AWSIZE(M_AXI_AWSIZE), .AWBURST(M_AXI_AWBURST),
+        .AWVALID(M_AXI_AWVALID), .AWREADY(M_AXI_AWREADY), .WDATA(M_AXI_WDATA), .WSTRB(M_AXI_WSTRB),
+        .WLAST(M_AXI_WLAST), .WVALID(M_AXI_WVALID), .WREADY(M_AXI_WREADY),
+        .BRESP(M_AXI_BRESP), .BVALID(M_AXI_BVALID), .BREADY(M_AXI_BREADY), .ERRORS());
+    DCACHE #(.SETS(DC_SETS), .WAYS(DC_WAYS), .LINE_WORDS(DC_LINE_WORDS), .SB_ENTRIES(DC_SB_ENTRIES),
+             .MSHRS(OOO_COMPLETE ? DC_MSHRS : 0)) dcache (
+        .clk(clk2), .reset(reset), .load(DC_LOAD), .store(DC_STORE), .addr(EX_MEM_ALUOUT), .wdata(EX_MEM_B),
+        .ready(DC_READY), .rdata(DC_RDATA), .miss(DC_MISS), .tag(EX_MEM_IR[20:16]),
+        .fill_valid(DC_FILL_VALID), .fill_tag(DC_FILL_TAG), .fill_data(DC_FILL_DATA), .fill_ack(LM_TAKEN),
+        .pending(LM_PENDING), .flush(HALTED == 1'b1), .flushed(DC_FLUSHED),
+        .mem_req(DC_MEM_REQ), .mem_we(DC_MEM_WE), .mem_addr(DC_MEM_ADDR), .mem_wline(DC_MEM_WLINE),
+        .mem_line(DC_MEM_LINE), .mem_done(DC_MEM_DONE));
+    
+    wire BTB_HIT = BTB_VALID[FETCH_PC[BTB_BITS-1:0]] && (BTB_TAG[FETCH_PC[BTB_BITS-1:0]] == FETCH_PC[31:BTB_BITS]);
+    wire PREDICT_TAKEN = BPRED && BTB_HIT && PHT[FETCH_PC[PHT_BITS-1:0]][1];
+    wire [31:0] FETCH_NPC = FETCH_PC + 1;
+    wire FETCH_JUMP = (FETCH_DATA[31:26] == J) || (FETCH_DATA[31:26] == JAL);
+    wire FETCH_CALL = (RAS_ENTRIES > 0) && (FETCH_DATA[31:26] == JAL);
+    wire FETCH_RET = (RAS_ENTRIES > 0) && (FETCH_DATA[31:26] == JR) && (FETCH_DATA[25:21] == 5'd31);
+    wire [RAS_BITS-1:0] RAS_BASE = TRAP ? EX_MEM_RASP : BRANCH_REDIRECT ? RESOLVE_RASP : RAS_SP;
+    // loop registers as of this fetch : LOOP setting them up , or the count
+    // put back to the trapping / redirecting instruction's
+    wire LOOP_SET = EARLY_BRANCH ? (ID_RES_LOOP && !TRAP) : EX_MEM_LOOP;
+    wire [31:0] LP_START = LOOP_SET ? RESOLVE_NPC : LOOP_START;
+    wire [31:0] LP_END = LOOP_SET ? RESOLVE_TARGET : LOOP_END;
+    wire [31:0] LP_COUNT = LOOP_SET ? (EARLY_BRANCH ? ID_RES_COUNT : EX_MEM_B) :
+                           TRAP ? EX_MEM_LCNT + (EX_MEM_EXC && EX_MEM_LEND) :   // a reserved end is fetched again
+                           BRANCH_REDIRECT ? RESOLVE_LCNT : LOOP_COUNT;
+    wire LOOP_HIT = (LP_COUNT != 0) && (FETCH_PC == LP_END);
+    wire LOOP_BACK = LOOP_HIT && (LP_COUNT != 1);
+    wire LOOP_TAIL = FETCH_WIDE && (LP_COUNT != 0) && (FETCH_NPC == LP_END);   // fetch one word , the end next
+    wire FETCH_TAKEN = LOOP_BACK || FETCH_JUMP || FETCH_RET || PREDICT_TAKEN;
+    wire [31:0] FETCH_TARGET = LOOP_BACK ? LP_START : FETCH_JUMP ? {FETCH_NPC[31:26] , FETCH_DATA[25:0]} :
+                               FETCH_RET ? RAS[RAS_BASE - 1'b1] : BTB_TARGET[FETCH_PC[BTB_BITS-1:0]];
+    wire [RAS_BITS-1:0] RAS_NEXT = RAS_BASE + FETCH_CALL - FETCH_RET;
+    wire [31:0] LOOP_NEXT = LP_COUNT - LOOP_HIT;
+    wire FETCH_VALID2 = FETCH_WIDE && !FETCH_TAKEN && !LOOP_TAIL;
+    wire [FQ_W-1:0] FETCH_ENTRY = {FETCH_DATA , FETCH_DATA2 , FETCH_VALID2 , FETCH_NPC , FETCH_TAKEN , FETCH_TARGET ,
+                                   RAS_NEXT , LOOP_NEXT , LOOP_HIT};
+    wire LB_CAPTURE = (LB_ENTRIES > 0) && FETCH_TAKEN && (FETCH_TARGET <= FETCH_PC) && (FETCH_PC - FETCH_TARGET < LB_ENTRIES) &&
+                      !((FETCH_TARGET == LB_START) && (FETCH_PC == LB_END));
+    
+    // FORWARDING UNIT
+    // On the clk1 edge that runs EX, the producer one ahead of the EX
+    // instruction sits in EX_MEM and (after its clk2 MEM) in MEM_WB ; anything
+    // older has already been written back before the consumer's ID read Reg[].
+    // EX_MEM only carries a result for ALU ops and JAL (the link , to R31) ,
+    // a load's data is in MEM_WB_LMD.
+    // With DUAL_ISSUE each of those holds a pair ; its second slot is the
+    // younger instruction and wins. Both slots of the pair in EX never depend
+    // on each other.
+    wire EX_MEM_LINK = (EX_MEM_TYPE == BRANCH) && (EX_MEM_IR[31:26] == JAL);
+    wire MEM_WB_LINK = (MEM_WB_TYPE == BRANCH) && (MEM_WB_IR[31:26] == JAL);
+    wire [4:0] EX_MEM_RD = EX_MEM_LINK ? 5'd31 : (EX_MEM_TYPE == RR_ALU) ? EX_MEM_IR[15:11] : EX_MEM_IR[20:16];
+    wire [4:0] MEM_WB_RD = MEM_WB_LINK ? 5'd31 : (MEM_WB_TYPE == RR_ALU) ? MEM_WB_IR[15:11] : MEM_WB_IR[20:16];
+    wire EX_MEM_FWD = FORWARDING && ((EX_MEM_TYPE == RR_ALU) || (EX_MEM_TYPE == RM_ALU) || EX_MEM_LINK) && (EX_MEM_RD != 5'b00000);
+    wire MEM_WB_FWD = FORWARDING && ((MEM_WB_TYPE == RR_ALU) || (MEM_WB_TYPE == RM_ALU) || (MEM_WB_TYPE == LOAD) || MEM_WB_LINK)
+                      && (MEM_WB_RD != 5'b00000);
+    wire [31:0] MEM_WB_RESULT = (MEM_WB_TYPE == LOAD) ? MEM_WB_LMD : MEM_WB_ALUOUT;
+    wire [4:0] EX_MEM_RD2 = (EX_MEM_TYPE2 == RR_ALU) ? EX_MEM_IR2[15:11] : EX_MEM_IR2[20:16];
+    wire [4:0] MEM_WB_RD2 = (MEM_WB_TYPE2 == RR_ALU) ? MEM_WB_IR2[15:11] : MEM_WB_IR2[20:16];
+    wire EX_MEM_FWD2 = FORWARDING && (EX_MEM_TYPE2 != NOP) && (EX_MEM_RD2 != 5'b00000);
+    wire MEM_WB_FWD2 = FORWARDING && (MEM_WB_TYPE2 != NOP) && (MEM_WB_RD2 != 5'b00000);
+    
+    wire [31:0] EX_A = (EX_MEM_FWD2 && (EX_MEM_RD2 == ID_EX_IR[25:21])) ? EX_MEM_ALUOUT2 :
+                       (EX_MEM_FWD && (EX_MEM_RD == ID_EX_IR[25:21])) ? EX_MEM_ALUOUT :
+                       (MEM_WB_FWD2 && (MEM_WB_RD2 == ID_EX_IR[25:21])) ? MEM_WB_ALUOUT2 :
+                       (MEM_WB_FWD && (MEM_WB_RD == ID_EX_IR[25:21])) ? MEM_WB_RESULT : ID_EX_A;
+    wire [31:0] EX_B = (EX_MEM_FWD2 && (EX_MEM_RD2 == ID_EX_IR[20:16])) ? EX_MEM_ALUOUT2 :
+                       (EX_MEM_FWD && (EX_MEM_RD == ID_EX_IR[20:16])) ? EX_MEM_ALUOUT :
+                       (MEM_WB_FWD2 && (MEM_WB_RD2 == ID_EX_IR[20:16])) ? MEM_WB_ALUOUT2 :
+                       (MEM_WB_FWD && (MEM_WB_RD == ID_EX_IR[20:16])) ? MEM_WB_RESULT : ID_EX_B;
+    wire [31:0] EX_A2 = (EX_MEM_FWD2 && (EX_MEM_RD2 == ID_EX_IR2[25:21])) ? EX_MEM_ALUOUT2 :
+                        (EX_MEM_FWD && (EX_MEM_RD == ID_EX_IR2[25:21])) ? EX_MEM_ALUOUT :
+                        (MEM_WB_FWD2 && (MEM_WB_RD2 == ID_EX_IR2[25:21])) ? MEM_WB_ALUOUT2 :
+                        (MEM_WB_FWD && (MEM_WB_RD == ID_EX_IR2[25:21])) ? MEM_WB_RESULT : ID_EX_A2;
+    wire [31:0] EX_B2 = (EX_MEM_FWD2 && (EX_MEM_RD2 == ID_EX_IR2[20:16])) ? EX_MEM_ALUOUT2 :
+                        (EX_MEM_FWD && (EX_MEM_RD == ID_EX_IR2[20:16])) ? EX_MEM_ALUOUT :
+                        (MEM_WB_FWD2 && (MEM_WB_RD2 == ID_EX_IR2[20:16])) ? MEM_WB_ALUOUT2 :
+                        (MEM_WB_FWD && (MEM_WB_RD == ID_EX_IR2[20:16])) ? MEM_WB_RESULT : ID_EX_B2;
+    
+    // HAZARD DETECTION UNIT
+    // Compares the source fields of IF_ID_IR with the destination of the
+    // instruction one ahead (in ID_EX). A producer two or more ahead has been
+    // written back before ID reads Reg[] , so one bubble always suffices.
+    // A LOAD's data reaches MEM_WB_LMD on the clk2 edge before the consumer's
+    // EX , so with the bypass on there is nothing left to interlock ; without
+    // it every one-ahead RAW , load or ALU , gets the bubble.
+    wire ID_EX_LINK = (ID_EX_TYPE == BRANCH) && (ID_EX_IR[31:26] == JAL);
+    wire [4:0] ID_EX_RD = ID_EX_LINK ? 5'd31 : (ID_EX_TYPE == RR_ALU) ? ID_EX_IR[15:11] : ID_EX_IR[20:16];
+    wire ID_EX_WRITES = (ID_EX_TYPE == RR_ALU) || (ID_EX_TYPE == RM_ALU) || (ID_EX_TYPE == LOAD) || ID_EX_LINK;
+    wire IF_ID_USES_RS = (IF_ID_IR[31:26] != HLT) && (IF_ID_IR[31:26] != J) && (IF_ID_IR[31:26] != JAL) &&
+                         (IF_ID_IR[31:26] != ERET);
+    wire IF_ID_SIMD = (IF_ID_IR[31:26] >= ADDB) && (IF_ID_IR[31:26] <= SUMB);
+    wire IF_ID_USES_RT = (IF_ID_IR[31:26] == ADD) || (IF_ID_IR[31:26] == SUB) || (IF_ID_IR[31:26] == AND) ||
+                         (IF_ID_IR[31:26] == OR) || (IF_ID_IR[31:26] == SLT) || (IF_ID_IR[31:26] == MUL) ||
+                         (IF_ID_IR[31:26] == DIV) || (IF_ID_IR[31:26] == REM) || (IF_ID_IR[31:26] == SW) || IF_ID_SIMD;
+    wire RAW_ONE_AHEAD = ID_EX_WRITES && (ID_EX_RD != 5'b00000) &&
+                         ((IF_ID_USES_RS && (IF_ID_IR[25:21] == ID_EX_RD)) || (IF_ID_USES_RT && (IF_ID_IR[20:16] == ID_EX_RD)));
+    wire [4:0] ID_EX_RD2 = (ID_EX_TYPE2 == RR_ALU) ? ID_EX_IR2[15:11] : ID_EX_IR2[20:16];
+    wire RAW_ONE_AHEAD2 = (ID_EX_TYPE2 != NOP) && (ID_EX_RD2 != 5'b00000) &&
+                          ((IF_ID_USES_RS && (IF_ID_IR[25:21] == ID_EX_RD2)) || (IF_ID_USES_RT && (IF_ID_IR[20:16] == ID_EX_RD2)));
+    
+    // MULTIPLY / DIVIDE UNIT
+    // DIV / REM (and MUL when MUL_LATENCY > 0) leave EX as MDU slots that
+    // write nothing and finish here : MUL in a MUL_LATENCY deep multiplier
+    // pipeline that takes one per cycle , DIV / REM in a radix-2 divider that
+    // takes 32 clk1 cycles and one operation at a time. Results come back
+    // through the late Reg[] write port on clk1 , which OOO_COMPLETE load
+    // misses share : a multiply has priority , then a load , and a finished
+    // divide waits in DIV_DONE for a free slot.
+    // MDU_PENDING and the outstanding loads (and the one missing in MEM right
+    // now) make up the scoreboard , one bit per register with a result still
+    // to come. ID holds an instruction that reads or writes a pending
+    // register (or the one an MDU slot in ID_EX is about to claim) , a divide
+    // while the divider is taken , and HLT until the unit is empty ;
+    // independent instructions keep issuing and completing around them.
+    // Unsigned , like SLT : x / 0 = 32'hffffffff and x % 0 = x.
+    localparam MUL_STAGES = (MUL_LATENCY > 0) ? MUL_LATENCY : 1;
+    reg [31:0] MDU_PENDING;
+    reg [MUL_STAGES-1:0] MUL_V;
+    reg [4:0] MUL_RD [0:MUL_STAGES-1];
+    reg [31:0] MUL_P [0:MUL_STAGES-1];
+    reg DIV_BUSY , DIV_DONE , DIV_REM;
+    reg [5:0] DIV_COUNT;
+    reg [4:0] DIV_RD;
+    reg [31:0] DIV_Q , DIV_R , DIV_D;
+    integer m;
+    
+    wire ID_EX_DIV = (ID_EX_IR[31:26] == DIV) || (ID_EX_IR[31:26] == REM);
+    wire MDU_ISSUE = (ID_EX_TYPE == MDU) && !EX_SQUASH && !MEM_BUSY && (HALTED == 0) && (MEM_WB_TYPE != HALT);
+    wire MUL_WB = (MUL_LATENCY > 0) && MUL_V[MUL_STAGES-1];
+    wire LM_WB = DC_FILL_VALID && !MUL_WB;
+    wire DIV_WB = DIV_DONE && !MUL_WB && !LM_WB;
+    wire MDU_WB = MUL_WB || DIV_WB;
+    wire [4:0] MDU_WB_RD = MUL_WB ? MUL_RD[MUL_STAGES-1] : DIV_RD;
+    wire [31:0] MDU_WB_DATA = MUL_WB ? MUL_P[MUL_STAGES-1] : DIV_REM ? DIV_R : DIV_Q;
+    wire LATE_WB = MDU_WB || LM_WB;
+    wire [4:0] LATE_WB_RD = LM_WB ? DC_FILL_TAG : MDU_WB_RD;
+    wire [31:0] LATE_WB_DATA = LM_WB ? DC_FILL_DATA : MDU_WB_DATA;
+    wire [32:0] DIV_SHIFT = {DIV_R , DIV_Q[31]};
+    wire [33:0] DIV_DIFF = {1'b0 , DIV_SHIFT} - {2'b00 , DIV_D};
+    
+    wire [31:0] MDU_REGS = (MDU_PENDING | ((ID_EX_TYPE == MDU) ? (32'b1 << ID_EX_IR[15:11]) : 32'b0) |
+                            LM_PENDING |
+                            (LM_START ? (32'b1 << EX_MEM_IR[20:16]) : 32'b0)) & ~32'b1;
+    wire IF_ID_WRITES_RD = (IF_ID_IR[31:26] == ADD) || (IF_ID_IR[31:26] == SUB) || (IF_ID_IR[31:26] == AND) ||
+                           (IF_ID_IR[31:26] == OR) || (IF_ID_IR[31:26] == SLT) || (IF_ID_IR[31:26] == MUL) ||
+                           (IF_ID_IR[31:26] == DIV) || (IF_ID_IR[31:26] == REM) || IF_ID_SIMD;
+    wire IF_ID_WRITES_RT = (IF_ID_IR[31:26] == ADDI) || (IF_ID_IR[31:26] == SUBI) || (IF_ID_IR[31:26] == SLTI) ||
+                           (IF_ID_IR[31:26] == LW);
+    wire IF_ID_HALT = !IF_ID_WRITES_RD && !IF_ID_WRITES_RT && (IF_ID_IR[31:26] != SW) &&
+                      (IF_ID_IR[31:26] != BEQZ) && (IF_ID_IR[31:26] != BNEQZ) &&
+                      (IF_ID_IR[31:26] != J) && (IF_ID_IR[31:26] != JAL) && (IF_ID_IR[31:26] != JR) &&
+                      (IF_ID_IR[31:26] != ERET) && (IF_ID_IR[31:26] != LOOP);   // HLT or an unknown opcode
+    wire MDU_HAZARD = (IF_ID_USES_RS && MDU_REGS[IF_ID_IR[25:21]]) || (IF_ID_USES_RT && MDU_REGS[IF_ID_IR[20:16]]) ||
+                      (IF_ID_WRITES_RD && MDU_REGS[IF_ID_IR[15:11]]) || (IF_ID_WRITES_RT && MDU_REGS[IF_ID_IR[20:16]]) ||
+                      ((IF_ID_IR[31:26] == JAL) && MDU_REGS[31]) ||
+                      (((IF_ID_IR[31:26] == DIV) || (IF_ID_IR[31:26] == REM)) && (DIV_BUSY || DIV_DONE || ((ID_EX_TYPE == MDU) && ID_EX_DIV))) ||
+                      (IF_ID_HALT && ((MDU_REGS != 0) || (LM_PENDING != 0) || LM_START || (ID_EX_TYPE == MDU) || DIV_BUSY || DIV_DONE || ((MUL_LATENCY > 0) && (MUL_V != 0))));
+    
+    // With EARLY_BRANCH the branch (or JR) itself reads its operand in ID : an
+    // ALU result one ahead is taken from EX_MEM_ALUOUT (EX ran on the clk1
+    // edge before) but a load's data only arrives on this clk2 edge. ERET
+    // reads EPC , it waits for a store ahead of it (which may write EPC) to
+    // leave EX_MEM. LOOP reads its count the same way.
+    wire IF_ID_BRANCH = (IF_ID_IR[31:26] == BEQZ) || (IF_ID_IR[31:26] == BNEQZ) || (IF_ID_IR[31:26] == JR) ||
+                        (IF_ID_IR[31:26] == ERET) || (IF_ID_IR[31:26] == LOOP);
+    wire ERET_WAIT = EARLY_BRANCH && (IF_ID_IR[31:26] == ERET) && ((ID_EX_TYPE == STORE) || (EX_MEM_TYPE == STORE));
+    wire ID_STALL = IF_ID_VALID && (MDU_HAZARD || ERET_WAIT ||
+                    (FORWARDING ? (EARLY_BRANCH && IF_ID_BRANCH && RAW_ONE_AHEAD && (ID_EX_TYPE == LOAD)) :
+                                  (RAW_ONE_AHEAD || RAW_ONE_AHEAD2)));
+    
+    wire [31:0] ID_BR_A = (EX_MEM_FWD2 && (EX_MEM_RD2 == IF_ID_IR[25:21])) ? EX_MEM_ALUOUT2 :
+                          (EX_MEM_FWD && (EX_MEM_RD == IF_ID_IR[25:21])) ? EX_MEM_ALUOUT :
+                          (IF_ID_IR[25:21] == 5'b00000) ? 0 : Reg[IF_ID_IR[25:21]];
+    wire ID_BR_TAKEN = ((IF_ID_IR[31:26] == BEQZ) && (ID_BR_A == 0)) || ((IF_ID_IR[31:26] == BNEQZ) && (ID_BR_A != 0)) ||
+                       (IF_ID_IR[31:26] == JR) || (IF_ID_IR[31:26] == ERET);
+    
+    // PAIR CHECK (DUAL_ISSUE)
+    // IF_ID_IR2 issues beside IF_ID_IR when it is a single-cycle ALU op (one
+    // memory port , one branch unit , one MDU port : those only go first) ,
+    // the first is no branch (the second would sit in its shadow) , HLT or
+    // MDU op , the second neither reads nor writes the first's destination
+    // and it clears the same checks as the first against ID_EX and the
+    // scoreboard. ID reads four registers for a pair and WB writes two.
+    wire IF_ID_RR2 = (IF_ID_IR2[31:26] == ADD) || (IF_ID_IR2[31:26] == SUB) || (IF_ID_IR2[31:26] == AND) ||
+                     (IF_ID_IR2[31:26] == OR) || (IF_ID_IR2[31:26] == SLT) ||
+                     ((IF_ID_IR2[31:26] >= ADDB) && (IF_ID_IR2[31:26] <= SUMB));
+    wire IF_ID_RM2 = (IF_ID_IR2[31:26] == ADDI) || (IF_ID_IR2[31:26] == SUBI) || (IF_ID_IR2[31:26] == SLTI);
+    wire [4:0] IF_ID_RD2 = IF_ID_RR2 ? IF_ID_IR2[15:11] : IF_ID_IR2[20:16];
+    wire [4:0] IF_ID_RD = IF_ID_WRITES_RD ? IF_ID_IR[15:11] : IF_ID_IR[20:16];
+    wire IF_ID_MDU = (IF_ID_IR[31:26] == DIV) || (IF_ID_IR[31:26] == REM) || ((MUL_LATENCY > 0) && (IF_ID_IR[31:26] == MUL));
+    wire PAIR_DEP = (IF_ID_WRITES_RD || IF_ID_WRITES_RT) && (IF_ID_RD != 5'b00000) &&
+                    ((IF_ID_IR2[25:21] == IF_ID_RD) || (IF_ID_RR2 && (IF_ID_IR2[20:16] == IF_ID_RD)) || (IF_ID_RD2 == IF_ID_RD));
+    wire PAIR_RAW = (ID_EX_WRITES && (ID_EX_RD != 5'b00000) &&
+                     ((IF_ID_IR2[25:21] == ID_EX_RD) || (IF_ID_RR2 && (IF_ID_IR2[20:16] == ID_EX_RD)))) ||
+                    ((ID_EX_TYPE2 != NOP) && (ID_EX_RD2 != 5'b00000) &&
+                     ((IF_ID_IR2[25:21] == ID_EX_RD2) || (IF_ID_RR2 && (IF_ID_IR2[20:16] == ID_EX_RD2))));
+    wire PAIR_MDU = MDU_REGS[IF_ID_IR2[25:21]] || (IF_ID_RR2 && MDU_REGS[IF_ID_IR2[20:16]]) || MDU_REGS[IF_ID_RD2];
+    wire PAIR = DUAL_ISSUE && IF_ID_VALID2 && (IF_ID_RR2 || IF_ID_RM2) && !IF_ID_BRANCH && !IF_ID_HALT && !IF_ID_MDU &&
+                !PAIR_DEP && !PAIR_MDU && (FORWARDING || !PAIR_RAW);
+    
+        always@(posedge clk1 or posedge reset)begin  //if stage (instruction stage )
+        if (reset) begin
+        PC <= 0;
+        IF_ID_VALID <= 1'b0;
+        IF_ID_VALID2 <= 1'b0;
+        IF_ID_PRED <= 1'b0;
+        RAS_SP <= 0;
+        for (i = 0; i < RAS_N; i = i + 1) RAS[i] <= 0;
+        LOOP_START <= 0;
+        LOOP_END <= 0;
+        LOOP_COUNT <= 0;
+        FETCH_STALLS <= 0;
+        FQ_COUNT <= 0;
+        FQ_STALLS_HIDDEN <= 0;
+        LB_VALID <= 0;
+        LB_START <= 1;   // empty range
+        LB_END <= 0;
+        LB_HITS <= 0;
+        BRANCH_TAKEN <= 1'b0;
+        BRANCH_FLUSHES <= 0;
+        BTB_VALID <= 0;
+        for (i = 0; i < PHT_ENTRIES; i = i + 1) PHT[i] <= 2'b01;   // weakly not taken
+        BP_BRANCHES <= 0;
+        BP_HITS <= 0;
+        end
+        else begin
+        // FETCH_PC is the redirect target on a mispredict (or the trap
+        // vector). A redirect is taken even over a hazard bubble : the
+        // instruction held in IF_ID (and the queue) is then on the wrong path
+        // and is replaced.
+        if (FETCH_GO) begin
+        BRANCH_TAKEN <= FETCH_REDIRECT;
+        if (BRANCH_REDIRECT && !TRAP) BRANCH_FLUSHES <= BRANCH_FLUSHES + 1;
+        LOOP_START <= LP_START;
+        LOOP_END <= LP_END;
+        if (FETCH_READY) begin
+        PC <= FETCH_TAKEN ? FETCH_TARGET : FETCH_PC + ((FETCH_WIDE && !LOOP_TAIL) ? 2 : 1);
+        if (FETCH_CALL) RAS[RAS_BASE] <= FETCH_NPC;
+        RAS_SP <= RAS_NEXT;
+        LOOP_COUNT <= LOOP_NEXT;
+        if (LB_HIT) LB_HITS <= LB_HITS + 1;
+        else begin   // loop buffer fill
+        if (LB_IN) begin
+        LB_WORD[FETCH_PC[LB_BITS-1:0]] <= FETCH_DATA;
+        LB_VALID[FETCH_PC[LB_BITS-1:0]] <= 1'b1;
+        end
+        if (FETCH_WIDE && LB_IN2) begin
+        LB_WORD[FETCH_PC[LB_BITS-1:0] + 1'b1] <= IMEM_DATA2;
+        LB_VALID[FETCH_PC[LB_BITS-1:0] + 1'b1] <= 1'b1;
+        end
+        end
+        if (LB_CAPTURE) begin   // a new loop : only this word so far
+        LB_START <= FETCH_TARGET;
+        LB_END <= FETCH_PC;
+        LB_VALID <= {{(LB_N-1){1'b0}} , 1'b1} << FETCH_PC[LB_BITS-1:0];
+        LB_WORD[FETCH_PC[LB_BITS-1:0]] <= FETCH_DATA;
+        end
+        end
+        else begin   // I-cache miss : keep the (possibly redirected) PC and retry
+        PC <= FETCH_PC;
+        RAS_SP <= RAS_BASE;
+        LOOP_COUNT <= LP_COUNT;
+        FETCH_STALLS <= FETCH_STALLS + 1;
+        end
+        
+        if (FQ_FLUSH || (HAZARD_STALL == 0 && FQ_COUNT == 0)) begin   // the fetch goes straight to ID
+        IF_ID_VALID <= FETCH_READY;
+        if (FETCH_READY)
+        {IF_ID_IR , IF_ID_IR2 , IF_ID_VALID2 , IF_ID_NPC , IF_ID_PRED , IF_ID_PTGT , IF_ID_RASP , IF_ID_LCNT , IF_ID_LEND} <= FETCH_ENTRY;
+        else IF_ID_VALID2 <= 1'b0;
+        FQ_COUNT <= 0;
+        end
+        else if (HAZARD_STALL == 0) begin   // ID takes the oldest queued , the fetch goes in behind
+        {IF_ID_IR , IF_ID_IR2 , IF_ID_VALID2 , IF_ID_NPC , IF_ID_PRED , IF_ID_PTGT , IF_ID_RASP , IF_ID_LCNT , IF_ID_LEND} <= FQ[0];
+        IF_ID_VALID <= 1'b1;
+        for (i = 0; i < FQ_N - 1; i = i + 1) FQ[i] <= FQ[i+1];
+        if (FETCH_READY) FQ[FQ_COUNT-1] <= FETCH_ENTRY;
+        else begin
+        FQ_COUNT <= FQ_COUNT - 1;
+        FQ_STALLS_HIDDEN <= FQ_STALLS_HIDDEN + 1;
         end
-        else begin 
-        IF_ID_IR <= Mem[PC];
-        PC <= PC+1;
-        IF_ID_NPC <= PC+1;
+        end
+        else if (FETCH_READY) begin   // ID stalled , queue it
+        FQ[FQ_COUNT] <= FETCH_ENTRY;
+        FQ_COUNT <= FQ_COUNT + 1;
         end
         end 
+        
+        if (HALTED == 0 && RESOLVE_VALID && !(EARLY_BRANCH && TRAP)) begin   // train on resolution (not a squashed one)
+        BP_BRANCHES <= BP_BRANCHES + 1;
+        if (!BRANCH_REDIRECT) BP_HITS <= BP_HITS + 1;
+        if (RESOLVE_TAKEN) begin
+        if (PHT[RESOLVE_PC[PHT_BITS-1:0]] != 2'b11) PHT[RESOLVE_PC[PHT_BITS-1:0]] <= PHT[RESOLVE_PC[PHT_BITS-1:0]] + 1;
+        BTB_VALID[RESOLVE_PC[BTB_BITS-1:0]] <= 1'b1;
+        BTB_TAG[RESOLVE_PC[BTB_BITS-1:0]] <= RESOLVE_PC[31:BTB_BITS];
+        BTB_TARGET[RESOLVE_PC[BTB_BITS-1:0]] <= RESOLVE_TARGET;
+        end
+        else if (PHT[RESOLVE_PC[PHT_BITS-1:0]] != 2'b00) PHT[RESOLVE_PC[PHT_BITS-1:0]] <= PHT[RESOLVE_PC[PHT_BITS-1:0]] - 1;
+        end
+        end
         end 
         // DECODE STAGE 
         
-        always@(posedge clk2)
+        always@(posedge clk2 or posedge reset)
         begin 
-        if(HALTED==0)begin
+        if (reset) begin
+        ID_EX_TYPE <= NOP;
+        ID_EX_TYPE2 <= NOP;
+        ID_EX_EXC <= 1'b0;
+        ID_SPLIT <= 1'b0;
+        HAZARD_STALL <= 1'b0;
+        STALL_CYCLES <= 0;
+        MDU_STALLS <= 0;
+        ISSUE_PAIRS <= 0;
+        ID_RES_VALID <= 1'b0;
+        ID_RES_LOOP <= 1'b0;
+        end
+        else if(HALTED==0 && MEM_STALL)begin   // MEM frozen : hold IF_ID and ID_EX as they are
+        ID_RES_VALID <= 1'b0;
+        ID_RES_LOOP <= 1'b0;
+        end
+        else if(HALTED==0 && ID_STALL)begin    // bubble into EX , IF_ID_IR is decoded again next clk2
+        ID_EX_TYPE <= NOP;
+        ID_EX_TYPE2 <= NOP;
+        ID_EX_EXC <= 1'b0;
+        ID_SPLIT <= 1'b0;
+        HAZARD_STALL <= 1'b1;
+        STALL_CYCLES <= STALL_CYCLES + 1;
+        if (MDU_HAZARD) MDU_STALLS <= MDU_STALLS + 1;
+        ID_RES_VALID <= 1'b0;
+        ID_RES_LOOP <= 1'b0;
+        end
+        else if(HALTED==0 && !IF_ID_VALID)begin    // nothing fetched
+        ID_EX_TYPE <= NOP;
+        ID_EX_TYPE2 <= NOP;
+        ID_EX_EXC <= 1'b0;
+        ID_SPLIT <= 1'b0;
+        HAZARD_STALL <= 1'b0;
+        ID_RES_VALID <= 1'b0;
+        ID_RES_LOOP <= 1'b0;
+        end
+        else if(HALTED==0)begin
+        HAZARD_STALL <= 1'b0;
+        ID_RES_VALID <= EARLY_BRANCH && IF_ID_BRANCH && (IF_ID_IR[31:26] != LOOP);
+        ID_RES_LOOP <= EARLY_BRANCH && (IF_ID_IR[31:26] == LOOP);
+        ID_RES_COUNT <= ID_BR_A;
+        ID_RES_LCNT <= IF_ID_LCNT;
+        ID_RES_TAKEN <= ID_BR_TAKEN;
+        ID_RES_PRED <= IF_ID_PRED;
+        ID_RES_NPC <= IF_ID_NPC;
+        ID_RES_PTGT <= IF_ID_PTGT;
+        ID_RES_RASP <= IF_ID_RASP;
+        ID_RES_TARGET <= (IF_ID_IR[31:26] == JR) ? ID_BR_A : (IF_ID_IR[31:26] == ERET) ? EPC :
+                         IF_ID_NPC + {{16{IF_ID_IR[15]}},{IF_ID_IR[15:0]}};
         if (IF_ID_IR[25:21] == 5'b00000 ) ID_EX_A <=0 ;
         else ID_EX_A <= Reg[IF_ID_IR[25:21]];
        if (IF_ID_IR[20:16] == 5'b00000 ) ID_EX_B <=0 ;
         else ID_EX_B <= Reg[IF_ID_IR[20:16]];
         ID_EX_NPC <= IF_ID_NPC;
         ID_EX_IR  <= IF_ID_IR;
+        ID_EX_PRED <= IF_ID_PRED;
+        ID_EX_PTGT <= IF_ID_PTGT;
+        ID_EX_RASP <= IF_ID_RASP;
+        ID_EX_LCNT <= IF_ID_LCNT;
+        ID_EX_LEND <= IF_ID_LEND;
         ID_EX_IMM <= {{16{IF_ID_IR[15]}},{IF_ID_IR[15:0]}} ;
+        // second slot , IF refetches IF_ID_IR2 when it stays behind
+        ID_SPLIT <= IF_ID_VALID2 && !PAIR;
+        ID_EX_TYPE2 <= !PAIR ? NOP : IF_ID_RR2 ? RR_ALU : RM_ALU;
+        if (PAIR) ISSUE_PAIRS <= ISSUE_PAIRS + 1;
+        ID_EX_A2 <= (IF_ID_IR2[25:21] == 5'b00000) ? 0 : Reg[IF_ID_IR2[25:21]];
+        ID_EX_B2 <= (IF_ID_IR2[20:16] == 5'b00000) ? 0 : Reg[IF_ID_IR2[20:16]];
+        ID_EX_IR2 <= IF_ID_IR2;
+        ID_EX_IMM2 <= {{16{IF_ID_IR2[15]}},{IF_ID_IR2[15:0]}};
+        ID_EX_EXC <= 1'b0;
         case(IF_ID_IR[31:26])
-        ADD,SUB,AND,OR,SLT,MUL : ID_EX_TYPE <= RR_ALU;
+        ADD,SUB,AND,OR,SLT : ID_EX_TYPE <= RR_ALU;
+        ADDB , SUBB , ADDH , SUBH , ADDUSB , ADDUSH , CMPEQB , CMPEQH , CMPLTB , CMPLTH , SUMB : ID_EX_TYPE <= RR_ALU;
+        MUL : ID_EX_TYPE <= (MUL_LATENCY > 0) ? MDU : RR_ALU;
+        DIV , REM : ID_EX_TYPE <= MDU;
         ADDI , SUBI , SLTI : ID_EX_TYPE <= RM_ALU;
         LW : ID_EX_TYPE <= LOAD;
         SW : ID_EX_TYPE <= STORE;
-        BNEQZ , BEQZ : ID_EX_TYPE <= BRANCH;
+        BNEQZ , BEQZ , J , JAL , JR , ERET , LOOP : ID_EX_TYPE <= BRANCH;
         HLT : ID_EX_TYPE <= HALT;
-        default : ID_EX_TYPE <= HALT;
+        default : begin   // reserved instruction , traps from EX_MEM
+                  ID_EX_TYPE <= NOP;
+                  ID_EX_EXC <= 1'b1;
+                  end
         endcase
         end 
         end
         
         // EXECUTE STAGE 
-        always @(posedge clk1)begin
-        EX_MEM_TYPE <= ID_EX_TYPE;
-        EX_MEM_B <= ID_EX_B;
+        always @(posedge clk1 or posedge reset)begin
+        if (reset) begin
+        EX_MEM_TYPE <= NOP;
+        EX_MEM_EXC <= 1'b0;
+        end
+        else if (!MEM_BUSY) begin   // EX_MEM is still waiting in MEM
+        EX_MEM_TYPE <= EX_SQUASH ? NOP : ID_EX_TYPE;   // branch shadow is squashed here
+        EX_MEM_EXC <= ID_EX_EXC && !EX_SQUASH;
+        EX_MEM_B <= EX_B;
         EX_MEM_IR <= ID_EX_IR;
+        EX_MEM_NPC <= ID_EX_NPC;
+        EX_MEM_PRED <= ID_EX_PRED;
+        EX_MEM_PTGT <= ID_EX_PTGT;
+        EX_MEM_RASP <= ID_EX_RASP;
+        EX_MEM_LCNT <= ID_EX_LCNT;
+        EX_MEM_LEND <= ID_EX_LEND;
         
         case(ID_EX_TYPE)
         
         RR_ALU : begin case(ID_EX_IR[31:26])
-                       ADD: EX_MEM_ALUOUT <= ID_EX_A + ID_EX_B;
-                       SUB: EX_MEM_ALUOUT <= ID_EX_A - ID_EX_B;
-                       AND: EX_MEM_ALUOUT <= ID_EX_A & ID_EX_B;
-                       OR: EX_MEM_ALUOUT <= ID_EX_A | ID_EX_B;
-                       SLT: EX_MEM_ALUOUT <= ID_EX_A < ID_EX_B;
-                       MUL:  EX_MEM_ALUOUT <= ID_EX_A * ID_EX_B;
+                       ADD: EX_MEM_ALUOUT <= EX_A + EX_B;
+                       SUB: EX_MEM_ALUOUT <= EX_A - EX_B;
+                       AND: EX_MEM_ALUOUT <= EX_A & EX_B;
+                       OR: EX_MEM_ALUOUT <= EX_A | EX_B;
+                       SLT: EX_MEM_ALUOUT <= EX_A < EX_B;
+                       MUL:  if (MUL_LATENCY == 0) EX_MEM_ALUOUT <= EX_A * EX_B;
+                       ADDB , SUBB , ADDH , SUBH , ADDUSB , ADDUSH , CMPEQB , CMPEQH , CMPLTB , CMPLTH , SUMB :
+                             EX_MEM_ALUOUT <= SIMD(ID_EX_IR[31:26], EX_A, EX_B);
                        endcase 
                        end 
        RM_ALU : begin case(ID_EX_IR[31:26])
-                       ADDI: EX_MEM_ALUOUT <= ID_EX_A + ID_EX_IMM;
-                       SUBI: EX_MEM_ALUOUT <= ID_EX_A - ID_EX_IMM;
-                       SLTI: EX_MEM_ALUOUT <= ID_EX_A < ID_EX_IMM;
+                       ADDI: EX_MEM_ALUOUT <= EX_A + ID_EX_IMM;
+                       SUBI: EX_MEM_ALUOUT <= EX_A - ID_EX_IMM;
+                       SLTI: EX_MEM_ALUOUT <= EX_A < ID_EX_IMM;
                        default : EX_MEM_ALUOUT <= 32'hxxxxxxxx;
                       endcase 
                     end
         LOAD , STORE  : begin
-                        EX_MEM_ALUOUT <= ID_EX_A + ID_EX_IMM;
-                        EX_MEM_B <= ID_EX_B;
+                        EX_MEM_ALUOUT <= EX_A + ID_EX_IMM;
+                        EX_MEM_B <= EX_B;
                         end               
        BRANCH :  begin 
-                EX_MEM_ALUOUT <= ID_EX_NPC +ID_EX_IMM;
-                EX_MEM_COND <= (ID_EX_A==0);
+                case(ID_EX_IR[31:26])
+                JR : EX_MEM_ALUOUT <= EX_A;                  // target
+                ERET : EX_MEM_ALUOUT <= ERET_EPC;
+                J , JAL : EX_MEM_ALUOUT <= ID_EX_NPC;        // link for JAL
+                LOOP : begin
+                       EX_MEM_ALUOUT <= ID_EX_NPC + ID_EX_IMM;   // end
+                       EX_MEM_B <= EX_A;                         // count
+                       end
+                default : EX_MEM_ALUOUT <= ID_EX_NPC +ID_EX_IMM;
+                endcase
+                EX_MEM_COND <= (EX_A==0);
                 end
                 default : EX_MEM_ALUOUT <= 32'hxxxxxxxx;
                 
                 endcase
+                end
                 end 
                 
                 
+        // EXECUTE , second slot : ALU only
+        always @(posedge clk1 or posedge reset)begin
+        if (reset) EX_MEM_TYPE2 <= NOP;
+        else if (!MEM_BUSY) begin
+        EX_MEM_TYPE2 <= EX_SQUASH ? NOP : ID_EX_TYPE2;
+        EX_MEM_IR2 <= ID_EX_IR2;
+        case(ID_EX_IR2[31:26])
+        ADD: EX_MEM_ALUOUT2 <= EX_A2 + EX_B2;
+        SUB: EX_MEM_ALUOUT2 <= EX_A2 - EX_B2;
+        AND: EX_MEM_ALUOUT2 <= EX_A2 & EX_B2;
+        OR: EX_MEM_ALUOUT2 <= EX_A2 | EX_B2;
+        SLT: EX_MEM_ALUOUT2 <= EX_A2 < EX_B2;
+        ADDI: EX_MEM_ALUOUT2 <= EX_A2 + ID_EX_IMM2;
+        SUBI: EX_MEM_ALUOUT2 <= EX_A2 - ID_EX_IMM2;
+        SLTI: EX_MEM_ALUOUT2 <= EX_A2 < ID_EX_IMM2;
+        ADDB , SUBB , ADDH , SUBH , ADDUSB , ADDUSH , CMPEQB , CMPEQH , CMPLTB , CMPLTH , SUMB :
+              EX_MEM_ALUOUT2 <= SIMD(ID_EX_IR2[31:26], EX_A2, EX_B2);
+        default : EX_MEM_ALUOUT2 <= 32'hxxxxxxxx;
+        endcase
+        end
+        end
+                
                 //MEMORY STAGE
                 
-                always@(posedge clk2)begin 
-                if(HALTED == 0)begin 
-                MEM_WB_TYPE <= EX_MEM_TYPE;
+                always@(posedge clk2 or posedge reset)begin 
+                if (reset) begin
+                MEM_WB_TYPE <= NOP;
+                MEM_WB_TYPE2 <= NOP;
+                MEM_BUSY <= 1'b0;
+                MEM_STALLS <= 0;
+                end
+                else if(HALTED == 0 && MEM_STALL)begin   // D-cache miss / store buffer full , retried next clk2
+                MEM_WB_TYPE <= NOP;
+                MEM_WB_TYPE2 <= NOP;
+                MEM_BUSY <= 1'b1;
+                MEM_STALLS <= MEM_STALLS + 1;
+                end
+                else if(HALTED == 0)begin 
+                MEM_BUSY <= 1'b0;
+                MEM_WB_TYPE <= LM_START ? MDU : EX_MEM_TYPE;   // a load miss finishes in LM_*
                 MEM_WB_IR <= EX_MEM_IR;
+                MEM_WB_TYPE2 <= EX_MEM_TYPE2;
+                MEM_WB_IR2 <= EX_MEM_IR2;
+                MEM_WB_ALUOUT2 <= EX_MEM_ALUOUT2;
                 case(EX_MEM_TYPE)
-                RR_ALU , RM_ALU: MEM_WB_ALUOUT <= EX_MEM_ALUOUT;
-                LOAD: MEM_WB_LMD <= Mem[EX_MEM_ALUOUT];
-                STORE : if(BRANCH_TAKEN == 0)Mem[EX_MEM_ALUOUT] <= EX_MEM_B;
-                
+                RR_ALU , RM_ALU , BRANCH: MEM_WB_ALUOUT <= EX_MEM_ALUOUT;
+                LOAD: MEM_WB_LMD <= LOAD_DATA;   // STORE is written by DMEM / DCACHE on this edge
+
                 endcase 
                 end
                 end
                 
- always @(posedge clk1)begin
+    always @* begin
+    case (EX_MEM_ALUOUT[3:0])
+    4'd0 : PERF_RDATA = CYCLES;
+    4'd1 : PERF_RDATA = RETIRED;
+    4'd2 : PERF_RDATA = BRANCH_FLUSHES;
+    4'd3 : PERF_RDATA = STALL_CYCLES;
+    4'd4 : PERF_RDATA = MEM_STALLS;
+    4'd5 : PERF_RDATA = FETCH_STALLS;
+    4'd6 : PERF_RDATA = BP_BRANCHES;
+    4'd7 : PERF_RDATA = BP_HITS;
+    4'd8 : PERF_RDATA = MDU_STALLS;
+    4'd9 : PERF_RDATA = ISSUE_PAIRS;
+    4'd10 : PERF_RDATA = TRAPS;
+    4'd11 : PERF_RDATA = {STATUS_EXL , STATUS_IE};
+    4'd12 : PERF_RDATA = CAUSE;
+    4'd13 : PERF_RDATA = EPC;
+    4'd14 : PERF_RDATA = LB_HITS;
+    4'd15 : PERF_RDATA = FQ_STALLS_HIDDEN;
+    default : PERF_RDATA = 0;
+    endcase
+    end
+    
+    always @(posedge clk1 or posedge reset)begin
+    if (reset) begin
+    CYCLES <= 0;
+    RETIRED <= 0;
+    end
+    else if (HALTED == 0) begin
+    CYCLES <= CYCLES + 1;
+    RETIRED <= RETIRED + (MEM_WB_TYPE != NOP) + (MEM_WB_TYPE2 != NOP);
+    end
+    end
+    
+    // trap registers , on the clk1 edge the instruction in EX_MEM leaves WB
+    always @(posedge clk1 or posedge reset)begin
+    if (reset) begin
+    STATUS_IE <= 1'b0;
+    STATUS_EXL <= 1'b0;
+    CAUSE <= 0;
+    EPC <= 0;
+    TRAPS <= 0;
+    IRQ_LAST <= 1'b0;
+    IRQ_PENDING <= 1'b0;
+    end
+    else begin
+    IRQ_LAST <= irq;
+    IRQ_PENDING <= (IRQ_PENDING && !(TRAP && TRAP_INT)) || (irq && !IRQ_LAST);
+    if (CSR_STORE && (EX_MEM_ALUOUT[3:0] == 4'd11)) {STATUS_EXL , STATUS_IE} <= EX_MEM_B[1:0];
+    if (CSR_STORE && (EX_MEM_ALUOUT[3:0] == 4'd13)) EPC <= EX_MEM_B;
+    if (EX_MEM_ERET && !MEM_BUSY && (HALTED == 0)) STATUS_EXL <= 1'b0;
+    if (TRAP) begin
+    EPC <= TRAP_EPC;
+    CAUSE <= EX_MEM_EXC ? 10 : 0;
+    STATUS_EXL <= 1'b1;
+    TRAPS <= TRAPS + 1;
+    end
+    end
+    end
+    
+    // MDU , issued from EX on clk1
+    always @(posedge clk1 or posedge reset)begin
+    if (reset) begin
+    MDU_PENDING <= 0;
+    LM_TAKEN <= 1'b0;
+    MUL_V <= 0;
+    DIV_BUSY <= 1'b0;
+    DIV_DONE <= 1'b0;
+    end
+    else begin
+    MDU_PENDING <= (MDU_PENDING & ~(MDU_WB ? (32'b1 << MDU_WB_RD) : 32'b0)) |
+                   (MDU_ISSUE ? (32'b1 << ID_EX_IR[15:11]) : 32'b0);
+    LM_TAKEN <= LM_WB;
+    
+    // multiplier : the product is registered MUL_LATENCY times , the
+    // synthesis tool retimes those registers into the multiplier array
+    MUL_V[0] <= MDU_ISSUE && (ID_EX_IR[31:26] == MUL);
+    MUL_RD[0] <= ID_EX_IR[15:11];
+    MUL_P[0] <= EX_A * EX_B;
+    for (m = 1; m < MUL_STAGES; m = m + 1) begin
+    MUL_V[m] <= MUL_V[m-1];
+    MUL_RD[m] <= MUL_RD[m-1];
+    MUL_P[m] <= MUL_P[m-1];
+    end
+    
+    // divider : restoring , one quotient bit per cycle , MSB first
+    if (MDU_ISSUE && ID_EX_DIV) begin
+    DIV_BUSY <= 1'b1;
+    DIV_COUNT <= 32;
+    DIV_REM <= (ID_EX_IR[31:26] == REM);
+    DIV_RD <= ID_EX_IR[15:11];
+    DIV_Q <= EX_A;
+    DIV_R <= 0;
+    DIV_D <= EX_B;
+    end
+    else if (DIV_BUSY) begin
+    if (!DIV_DIFF[33]) begin
+    DIV_R <= DIV_DIFF[31:0];
+    DIV_Q <= {DIV_Q[30:0] , 1'b1};
+    end
+    else begin
+    DIV_R <= DIV_SHIFT[31:0];
+    DIV_Q <= {DIV_Q[30:0] , 1'b0};
+    end
+    DIV_COUNT <= DIV_COUNT - 1;
+    if (DIV_COUNT == 1) begin
+    DIV_BUSY <= 1'b0;
+    DIV_DONE <= 1'b1;
+    end
+    end
+    else if (DIV_WB) DIV_DONE <= 1'b0;
+    end
+    end
+                
+ always @(posedge clk1 or posedge reset)begin
+   if (reset) HALTED <= 1'b0;
+   else begin
    if (BRANCH_TAKEN == 0 )
     case(MEM_WB_TYPE)
     RR_ALU: Reg[MEM_WB_IR[15:11]] <= MEM_WB_ALUOUT;
     RM_ALU : Reg[MEM_WB_IR[20:16]] <= MEM_WB_ALUOUT;
     LOAD : Reg[MEM_WB_IR[20:16]] <= MEM_WB_LMD;
+    BRANCH : if (MEM_WB_IR[31:26] == JAL) Reg[31] <= MEM_WB_ALUOUT;
     HALT: HALTED<= 1'b1;
     endcase
+   if (BRANCH_TAKEN == 0)   // second slot , never the register of the first (pair check)
+    case(MEM_WB_TYPE2)
+    RR_ALU: Reg[MEM_WB_IR2[15:11]] <= MEM_WB_ALUOUT2;
+    RM_ALU : Reg[MEM_WB_IR2[20:16]] <= MEM_WB_ALUOUT2;
+    endcase
+   if (LATE_WB) Reg[LATE_WB_RD] <= LATE_WB_DATA;   // late write port , never a register WB writes (scoreboard)
+   end
  end
                 
                 
@@ -157,4 +1021,126 @@ module MIPS(input clk1 , input clk2
         
         
      
+endmodule
+
+
+// Instruction memory : asynchronous read , word addressed. The line port
+// models a slow memory behind a cache : a request for the LINE_WORDS words at
+// line_addr is answered LATENCY (>= 1) clk cycles later with line_done held
+// for one cycle.
+module IMEM #(parameter DEPTH = 1024 , parameter INIT_FILE = "" ,
+    parameter LINE_WORDS = 4 , parameter LATENCY = 1) (
+    input [31:0] addr ,
+    output [31:0] data ,
+    output [31:0] data2 ,   // the word after addr : {data2 , data} is a 64-bit fetch
+    
+    input clk , input reset ,
+    input line_req ,
+    input [31:0] line_addr ,
+    output reg [32*LINE_WORDS-1:0] line_data ,
+    output reg line_done
+    );
+    reg [31:0] Mem [0:DEPTH-1];
+    reg [8*256-1:0] file;
+    reg [1:0] line_state;
+    reg [15:0] line_count;
+    integer k;
+    parameter L_IDLE = 2'b00 , L_BUSY = 2'b01 , L_RESP = 2'b10;
+    
+    initial begin
+    if (INIT_FILE != "") $readmemh(INIT_FILE, Mem);
+    if ($value$plusargs("IMEM=%s", file)) $readmemh(file, Mem);   // +IMEM=prog.hex overrides
+    end
+    
+    assign data = Mem[addr[$clog2(DEPTH)-1:0]];
+    assign data2 = Mem[(addr + 1) & (DEPTH-1)];
+    
+    always @(posedge clk or posedge reset)begin
+    if (reset) begin
+    line_state <= L_IDLE;
+    line_done <= 1'b0;
+    end
+    else case (line_state)
+    L_IDLE : if (line_req) begin
+             line_count <= LATENCY;
+             line_state <= L_BUSY;
+             end
+    L_BUSY : if (line_count <= 1) begin
+             for (k = 0; k < LINE_WORDS; k = k + 1) line_data[k*32 +: 32] <= Mem[(line_addr + k) & (DEPTH-1)];
+             line_done <= 1'b1;
+             line_state <= L_RESP;
+             end
+             else line_count <= line_count - 1;
+    L_RESP : begin    // requester drops line_req on this edge
+             line_done <= 1'b0;
+             line_state <= L_IDLE;
+             end
+    default : line_state <= L_IDLE;
+    endcase
+    end
+endmodule
+
+
+// Data memory : asynchronous read , synchronous write , word addressed. The
+// line port reads (line_we = 0) or writes the LINE_WORDS words at line_addr
+// LATENCY (>= 1) clk cycles after the request , line_done held for one cycle.
+module DMEM #(parameter DEPTH = 1024 , parameter INIT_FILE = "" ,
+    parameter LINE_WORDS = 4 , parameter LATENCY = 1) (
+    input clk ,
+    input [31:0] addr ,
+    output [31:0] rdata ,
+    input we ,
+    input [31:0] wdata ,
+    
+    input reset ,
+    input line_req ,
+    input line_we ,
+    input [31:0] line_addr ,
+    input [32*LINE_WORDS-1:0] line_wdata ,
+    output reg [32*LINE_WORDS-1:0] line_data ,
+    output reg line_done
+    );
+    reg [31:0] Mem [0:DEPTH-1];
+    reg [8*256-1:0] file;
+    reg [1:0] line_state;
+    reg [15:0] line_count;
+    integer k;
+    parameter L_IDLE = 2'b00 , L_BUSY = 2'b01 , L_RESP = 2'b10;
+    
+    initial begin
+    if (INIT_FILE != "") $readmemh(INIT_FILE, Mem);
+    if ($value$plusargs("DMEM=%s", file)) $readmemh(file, Mem);
+    end
+    
+    assign rdata = Mem[addr[$clog2(DEPTH)-1:0]];
+    
+    always @(posedge clk or posedge reset)begin
+    if (reset) begin
+    line_state <= L_IDLE;
+    line_done <= 1'b0;
+    end
+    else begin
+    if (we) Mem[addr[$clog2(DEPTH)-1:0]] <= wdata;
+    case (line_state)
+    L_IDLE : if (line_req) begin
+             line_count <= LATENCY;
+             line_state <= L_BUSY;
+             end
+    L_BUSY : if (line_count <= 1) begin
+             for (k = 0; k < LINE_WORDS; k = k + 1) begin
+             if (line_we) Mem[(line_addr + k) & (DEPTH-1)] <= line_wdata[k*32 +: 32];
+             line_data[k*32 +: 32] <= Mem[(line_addr + k) & (DEPTH-1)];
+             end
+             line_done <= 1'b1;
+             line_state <= L_RESP;
+             end
+             else line_count <= line_count - 1;
+    L_RESP : begin    // requester drops line_req on this edge
+             line_done <= 1'b0;
+             line_state <= L_IDLE;
+             end
+    default : line_state <= L_IDLE;
+    endcase
+    end
+    end
 endmodule
@@ -0,0 +1,494 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////////
+// Company: 
+// Engineer: 
+// 
+// Design Name: 
+// Module Name: MIPS_1clk
+// Project Name: 
+// Target Devices: 
+// Tool Versions: 
+// Description: Single-clock variant of MIPS. Same ISA , encodings , register
+//              file and IMEM / DMEM modules , but every stage is clocked on
+//              the rising edge of clk , so one instruction can enter the pipe
+//              per clk period instead of per clk1/clk2 pair.
+//              Always forwards (EX_MEM and MEM_WB into EX , WB into ID). A
+//              load followed by a user costs one bubble and a taken branch
+//              or jump , resolved in EX , squashes the two younger
+//              instructions.
+//              Traps as in MIPS (irq , reserved opcodes , STATUS / CAUSE /
+//              EPC in the counter range , ERET) , taken as the instruction
+//              in MEM_WB leaves WB. Hardware loop as in MIPS , set up from
+//              EX like a taken branch.
+// 
+// Dependencies: IMEM , DMEM (MIPS.v)
+// 
+// Revision:
+// Revision 0.01 - File Created
+// Additional Comments:
+// 
+//////////////////////////////////////////////////////////////////////////////////
+
+
+module MIPS_1clk #(parameter IMEM_DEPTH = 1024 ,  // instruction / data memory size in words , power of two
+    parameter DMEM_DEPTH = 1024 ,
+    parameter IMEM_INIT = "" ,     // optional $readmemh images
+    parameter DMEM_INIT = "" ,
+    parameter EXC_VECTOR = 32'h100 // IMEM word address of the trap handler
+    ) (input clk ,
+    input reset ,  // ACTIVE HIGH , hold it across at least one clk edge
+    input irq      // external interrupt , a rising edge is latched on clk (tie low when unused)
+    );
+    reg [31:0] PC, IF_ID_IR , IF_ID_NPC;
+    reg [31:0] ID_EX_IR , ID_EX_NPC , ID_EX_A , ID_EX_B , ID_EX_IMM ;
+    reg [31:0] EX_MEM_B, EX_MEM_IR , EX_MEM_ALUOUT;
+    reg [31:0] MEM_WB_LMD , MEM_WB_IR , MEM_WB_ALUOUT;
+    reg [2:0] ID_EX_TYPE , EX_MEM_TYPE , MEM_WB_TYPE ;
+    reg IF_ID_VALID;           // 0 : squashed or nothing fetched , ID decodes a bubble
+    reg FETCH_STOP;            // HLT has left ID , nothing behind it is fetched
+    
+    reg[31:0] Reg [31:0];
+    parameter ADD = 6'b000000 , SUB = 6'b000001 , AND  = 6'b000010 , OR = 6'b000011 ,
+    SLT = 6'b000100, MUL = 6'b000101, DIV = 6'b000110 , REM = 6'b000111 , HLT = 6'b111111 , 
+    LW = 6'b001000 , SW = 6'b001001 , ADDI = 6'b001010 , SUBI = 6'b001011,
+    SLTI = 6'b001100 , BNEQZ = 6'b001101 , BEQZ = 6'b001110 ,
+    J = 6'b010000 , JAL = 6'b010001 , JR = 6'b010010 , ERET = 6'b010011 ,
+    ADDB = 6'b010100 , SUBB = 6'b010101 , ADDH = 6'b010110 , SUBH = 6'b010111 , ADDUSB = 6'b011000 ,
+    ADDUSH = 6'b011001 , CMPEQB = 6'b011010 , CMPEQH = 6'b011011 , CMPLTB = 6'b011100 , CMPLTH = 6'b011101 ,
+    SUMB = 6'b011110 , LOOP = 6'b011111 ;
+    
+    parameter RR_ALU = 3'B000 , RM_ALU = 3'b001 , LOAD = 3'b010 , STORE = 3'b011, BRANCH = 3'b100, HALT = 3'b101,
+    NOP = 3'b110;
+    
+    // PACKED SIMD ALU , as in MIPS
+    function [31:0] SIMD;
+    input [5:0] op; input [31:0] a , b;
+    integer l;
+    reg [8:0] s8;
+    reg [16:0] s16;
+    begin
+    SIMD = 0;
+    for (l = 0; l < 4; l = l + 1) begin
+    s8 = a[l*8 +: 8] + b[l*8 +: 8];
+    case (op)
+    ADDB : SIMD[l*8 +: 8] = s8[7:0];
+    SUBB : SIMD[l*8 +: 8] = a[l*8 +: 8] - b[l*8 +: 8];
+    ADDUSB : SIMD[l*8 +: 8] = s8[8] ? 8'hff : s8[7:0];
+    CMPEQB : SIMD[l*8 +: 8] = (a[l*8 +: 8] == b[l*8 +: 8]) ? 8'hff : 8'h00;
+    CMPLTB : SIMD[l*8 +: 8] = (a[l*8 +: 8] < b[l*8 +: 8]) ? 8'hff : 8'h00;
+    endcase
+    end
+    for (l = 0; l < 2; l = l + 1) begin
+    s16 = a[l*16 +: 16] + b[l*16 +: 16];
+    case (op)
+    ADDH : SIMD[l*16 +: 16] = s16[15:0];
+    SUBH : SIMD[l*16 +: 16] = a[l*16 +: 16] - b[l*16 +: 16];
+    ADDUSH : SIMD[l*16 +: 16] = s16[16] ? 16'hffff : s16[15:0];
+    CMPEQH : SIMD[l*16 +: 16] = (a[l*16 +: 16] == b[l*16 +: 16]) ? 16'hffff : 16'h0000;
+    CMPLTH : SIMD[l*16 +: 16] = (a[l*16 +: 16] < b[l*16 +: 16]) ? 16'hffff : 16'h0000;
+    endcase
+    end
+    if (op == SUMB) SIMD = a[7:0] + a[15:8] + a[23:16] + a[31:24] + b;
+    end
+    endfunction
+    reg HALTED;
+    reg [31:0] STALL_CYCLES;   // load-use bubbles
+    reg [31:0] BRANCH_FLUSHES; // taken branches , jumps and LOOP set-ups , two squashed slots each
+    reg [31:0] BP_BRANCHES , BP_HITS;   // resolved BEQZ / BNEQZ / JR , of which not taken (static prediction)
+    reg [31:0] CYCLES , RETIRED;        // clk periods since reset , WB commits
+    reg [31:0] MDU_STALLS;              // clk periods EX waited on the divider
+    reg [31:0] TRAPS;                   // traps taken , interrupts and reserved instructions
+    
+    // PERFORMANCE COUNTERS , same map as MIPS (MEM_STALLS , FETCH_STALLS ,
+    // ISSUE_PAIRS , LB_HITS and FQ_STALLS_HIDDEN read 0) , with the trap
+    // registers at 11 .. 13
+    parameter PERF_BASE = 32'hFFFFFF00;
+    wire PERF_ACCESS = (EX_MEM_ALUOUT[31:4] == PERF_BASE[31:4]);
+    reg [31:0] PERF_RDATA;
+    
+    // TRAPS
+    // A trap is taken on the edge where the instruction in MEM_WB leaves WB ,
+    // so it is precise : everything older has retired , EX_MEM (a store in
+    // it is not written) , ID_EX and IF_ID are squashed and fetch goes to
+    // EXC_VECTOR. A reserved opcode travels as a bubble marked *_EXC and traps
+    // in its own place with EPC at it and CAUSE 10 ; an irq edge is taken
+    // behind the next instruction that leaves WB while STATUS.IE is set and
+    // STATUS.EXL clear , with EPC where the program would have gone next and
+    // CAUSE 0. Every trap sets EXL , ERET jumps to EPC and clears it as it
+    // leaves WB. A store into the counter range writes STATUS ({EXL , IE})
+    // or EPC from MEM. Never taken on a HLT or after HALTED. Same rules as
+    // MIPS , which takes it one stage earlier.
+    reg STATUS_IE , STATUS_EXL;
+    reg [31:0] CAUSE , EPC;
+    reg IRQ_LAST , IRQ_PENDING;
+    reg ID_EX_EXC , EX_MEM_EXC , MEM_WB_EXC;
+    reg [31:0] EX_MEM_EPC , MEM_WB_EPC;     // where a trap on this instruction returns to
+    wire TRAP_INT = IRQ_PENDING && STATUS_IE && !STATUS_EXL && (MEM_WB_TYPE != NOP) && (MEM_WB_TYPE != HALT);
+    wire TRAP = !reset && (HALTED == 0) && (MEM_WB_EXC || TRAP_INT);
+    wire MEM_WB_ERET = (MEM_WB_TYPE == BRANCH) && (MEM_WB_IR[31:26] == ERET);
+    wire CSR_STORE = (EX_MEM_TYPE == STORE) && PERF_ACCESS && (HALTED == 0) && !TRAP;
+    wire [31:0] ERET_EPC = (CSR_STORE && (EX_MEM_ALUOUT[3:0] == 4'd13)) ? EX_MEM_B : EPC;   // EPC as of this edge
+    
+    // HARDWARE LOOP
+    // LOOP rs, end : the instructions after it up to and including end run
+    // rs times. IF compares PC with LOOP_END ; on a match it counts the
+    // iteration down and , while the count stays above 0 , fetches
+    // LOOP_START next , so the body ends with no branch and no bubble. LOOP
+    // sets the registers from EX and redirects to the body's start like a
+    // taken branch (two squashed slots per loop , not per iteration). Every
+    // instruction carries the count after its own fetch (*_LCNT , for LOOP
+    // the count it sets) and whether it was the end (*_LEND) , so a redirect
+    // or trap puts back the count the wrong path used up ; a trap that
+    // squashes a LOOP in EX_MEM also puts back the START / END it replaced.
+    // The end must not be a branch or jump , loops do not nest.
+    reg [31:0] LOOP_START , LOOP_END , LOOP_COUNT;
+    reg [31:0] IF_ID_LCNT , ID_EX_LCNT , EX_MEM_LCNT , MEM_WB_LCNT;
+    reg IF_ID_LEND , ID_EX_LEND , EX_MEM_LEND , MEM_WB_LEND;
+    reg [31:0] EX_MEM_OLD_START , EX_MEM_OLD_END;
+    wire EX_MEM_LOOP = (EX_MEM_TYPE == BRANCH) && (EX_MEM_IR[31:26] == LOOP);
+    wire LOOP_HIT = (LOOP_COUNT != 0) && (PC == LOOP_END);
+    wire LOOP_BACK = LOOP_HIT && (LOOP_COUNT != 1);
+    wire [31:0] TRAP_LCNT = MEM_WB_LCNT + (MEM_WB_EXC && MEM_WB_LEND);   // a reserved end is fetched again
+    
+    // MEMORIES
+    wire [31:0] IMEM_DATA , DMEM_RDATA;
+    wire DMEM_WE = !reset && (HALTED == 0) && (EX_MEM_TYPE == STORE) && !PERF_ACCESS && !TRAP;
+    IMEM #(.DEPTH(IMEM_DEPTH), .INIT_FILE(IMEM_INIT)) imem (.addr(PC), .data(IMEM_DATA), .data2(),
+        .clk(clk), .reset(reset), .line_req(1'b0), .line_addr(32'b0), .line_data(), .line_done());
+    DMEM #(.DEPTH(DMEM_DEPTH), .INIT_FILE(DMEM_INIT)) dmem (.clk(clk), .addr(EX_MEM_ALUOUT), .rdata(DMEM_RDATA),
+        .we(DMEM_WE), .wdata(EX_MEM_B),
+        .reset(reset), .line_req(1'b0), .line_we(1'b0), .line_addr(32'b0), .line_wdata(128'b0), .line_data(), .line_done());
+    
+    // FORWARDING UNIT
+    // EX_MEM holds the producer one ahead of EX (ALU result only) , MEM_WB the
+    // one two ahead (ALU result or load data). The producer three ahead writes
+    // Reg[] on the same edge ID reads it , so ID takes it from MEM_WB directly.
+    // JAL carries its link (to R31) like an ALU result.
+    wire EX_MEM_LINK = (EX_MEM_TYPE == BRANCH) && (EX_MEM_IR[31:26] == JAL);
+    wire MEM_WB_LINK = (MEM_WB_TYPE == BRANCH) && (MEM_WB_IR[31:26] == JAL);
+    wire [4:0] EX_MEM_RD = EX_MEM_LINK ? 5'd31 : (EX_MEM_TYPE == RR_ALU) ? EX_MEM_IR[15:11] : EX_MEM_IR[20:16];
+    wire [4:0] MEM_WB_RD = MEM_WB_LINK ? 5'd31 : (MEM_WB_TYPE == RR_ALU) ? MEM_WB_IR[15:11] : MEM_WB_IR[20:16];
+    wire EX_MEM_FWD = ((EX_MEM_TYPE == RR_ALU) || (EX_MEM_TYPE == RM_ALU) || EX_MEM_LINK) && (EX_MEM_RD != 5'b00000);
+    wire MEM_WB_FWD = ((MEM_WB_TYPE == RR_ALU) || (MEM_WB_TYPE == RM_ALU) || (MEM_WB_TYPE == LOAD) || MEM_WB_LINK)
+                      && (MEM_WB_RD != 5'b00000);
+    wire [31:0] MEM_WB_RESULT = (MEM_WB_TYPE == LOAD) ? MEM_WB_LMD : MEM_WB_ALUOUT;
+    
+    wire [31:0] EX_A = (EX_MEM_FWD && (EX_MEM_RD == ID_EX_IR[25:21])) ? EX_MEM_ALUOUT :
+                       (MEM_WB_FWD && (MEM_WB_RD == ID_EX_IR[25:21])) ? MEM_WB_RESULT : ID_EX_A;
+    wire [31:0] EX_B = (EX_MEM_FWD && (EX_MEM_RD == ID_EX_IR[20:16])) ? EX_MEM_ALUOUT :
+                       (MEM_WB_FWD && (MEM_WB_RD == ID_EX_IR[20:16])) ? MEM_WB_RESULT : ID_EX_B;
+    wire [31:0] ID_A = (IF_ID_IR[25:21] == 5'b00000) ? 0 :
+                       (MEM_WB_FWD && (MEM_WB_RD == IF_ID_IR[25:21])) ? MEM_WB_RESULT : Reg[IF_ID_IR[25:21]];
+    wire [31:0] ID_B = (IF_ID_IR[20:16] == 5'b00000) ? 0 :
+                       (MEM_WB_FWD && (MEM_WB_RD == IF_ID_IR[20:16])) ? MEM_WB_RESULT : Reg[IF_ID_IR[20:16]];
+    
+    // HAZARD DETECTION UNIT
+    // Only a load one ahead is too late for the bypass : its data reaches
+    // MEM_WB on the edge the consumer would leave EX.
+    reg [2:0] ID_TYPE;
+    always @* begin
+    case(IF_ID_IR[31:26])
+    ADD,SUB,AND,OR,SLT,MUL,DIV,REM : ID_TYPE = RR_ALU;
+    ADDB , SUBB , ADDH , SUBH , ADDUSB , ADDUSH , CMPEQB , CMPEQH , CMPLTB , CMPLTH , SUMB : ID_TYPE = RR_ALU;
+    ADDI , SUBI , SLTI : ID_TYPE = RM_ALU;
+    LW : ID_TYPE = LOAD;
+    SW : ID_TYPE = STORE;
+    BNEQZ , BEQZ , J , JAL , JR , ERET , LOOP : ID_TYPE = BRANCH;
+    HLT : ID_TYPE = HALT;
+    default : ID_TYPE = NOP;       // reserved , a bubble that traps (ID_EXC)
+    endcase
+    end
+    wire ID_EXC = IF_ID_VALID && (ID_TYPE == NOP);
+    wire IF_ID_USES_RS = (ID_TYPE != HALT) && (ID_TYPE != NOP) && (IF_ID_IR[31:26] != J) && (IF_ID_IR[31:26] != JAL) &&
+                         (IF_ID_IR[31:26] != ERET);
+    wire IF_ID_USES_RT = (ID_TYPE == RR_ALU) || (ID_TYPE == STORE);
+    wire LOAD_USE = IF_ID_VALID && (ID_EX_TYPE == LOAD) && (ID_EX_IR[20:16] != 5'b00000) &&
+                    ((IF_ID_USES_RS && (IF_ID_IR[25:21] == ID_EX_IR[20:16])) || (IF_ID_USES_RT && (IF_ID_IR[20:16] == ID_EX_IR[20:16])));
+    wire ID_HALT = IF_ID_VALID && (ID_TYPE == HALT);
+    
+    // BRANCH RESOLUTION , in EX on the forwarded operand ; J / JAL / JR and
+    // ERET are always taken , LOOP always goes to the body's start
+    wire EX_DIRECT = (ID_EX_IR[31:26] == J) || (ID_EX_IR[31:26] == JAL);
+    wire EX_LOOP = (ID_EX_TYPE == BRANCH) && (ID_EX_IR[31:26] == LOOP);
+    wire EX_JUMP = EX_DIRECT || (ID_EX_IR[31:26] == JR) || (ID_EX_IR[31:26] == ERET) || (ID_EX_IR[31:26] == LOOP);
+    wire EX_TAKEN = (ID_EX_TYPE == BRANCH) && (((ID_EX_IR[31:26] == BEQZ) && (EX_A == 0)) ||
+                                               ((ID_EX_IR[31:26] == BNEQZ) && (EX_A != 0)) || EX_JUMP);
+    wire [31:0] EX_TARGET = (ID_EX_IR[31:26] == JR) ? EX_A : (ID_EX_IR[31:26] == ERET) ? ERET_EPC :
+                            ((ID_EX_IR[31:26] == J) || (ID_EX_IR[31:26] == JAL)) ? {ID_EX_NPC[31:26] , ID_EX_IR[25:0]} :
+                            (ID_EX_IR[31:26] == LOOP) ? ID_EX_NPC : ID_EX_NPC + ID_EX_IMM;
+    // where the program goes after EX's instruction , and the loop count then
+    wire [31:0] EX_LCNT = EX_LOOP ? EX_A : ID_EX_LCNT;
+    wire [31:0] EX_NEXT = EX_TAKEN ? EX_TARGET : (ID_EX_LEND && (ID_EX_LCNT != 0)) ? LOOP_START : ID_EX_NPC;
+    
+    // DIVIDER
+    // DIV / REM hold EX , and IF / ID behind it , while a radix-2 restoring
+    // divider runs for 32 cycles ; bubbles go on into MEM. The operands are
+    // taken on the first edge , the result leaves EX once DIV_FIN is set.
+    // Unsigned , like MIPS : x / 0 = 32'hffffffff and x % 0 = x.
+    reg DIV_RUN , DIV_FIN;
+    reg [5:0] DIV_COUNT;
+    reg [31:0] DIV_Q , DIV_R , DIV_D;
+    wire EX_DIV = (ID_EX_TYPE == RR_ALU) && ((ID_EX_IR[31:26] == DIV) || (ID_EX_IR[31:26] == REM));
+    wire DIV_STALL = EX_DIV && !DIV_FIN;
+    wire [32:0] DIV_SHIFT = {DIV_R , DIV_Q[31]};
+    wire [33:0] DIV_DIFF = {1'b0 , DIV_SHIFT} - {2'b00 , DIV_D};
+    
+        always@(posedge clk or posedge reset)begin  //if stage
+        if (reset) begin
+        PC <= 0;
+        IF_ID_VALID <= 1'b0;
+        FETCH_STOP <= 1'b0;
+        BRANCH_FLUSHES <= 0;
+        BP_BRANCHES <= 0;
+        BP_HITS <= 0;
+        LOOP_START <= 0;
+        LOOP_END <= 0;
+        LOOP_COUNT <= 0;
+        end
+        else if (TRAP) begin             // squash IF_ID , fetch the handler
+        PC <= EXC_VECTOR;
+        IF_ID_VALID <= 1'b0;
+        FETCH_STOP <= 1'b0;
+        LOOP_COUNT <= TRAP_LCNT;
+        if (EX_MEM_LOOP) begin
+        LOOP_START <= EX_MEM_OLD_START;
+        LOOP_END <= EX_MEM_OLD_END;
+        end
+        end
+        else if (HALTED == 0) begin
+        if (ID_EX_TYPE == BRANCH && !EX_DIRECT && !EX_LOOP) begin   // J / JAL / LOOP are not counted , as in MIPS
+        BP_BRANCHES <= BP_BRANCHES + 1;
+        if (!EX_TAKEN) BP_HITS <= BP_HITS + 1;
+        end
+        if (EX_TAKEN) begin              // squash IF_ID , ID squashes ID_EX
+        PC <= EX_TARGET;
+        IF_ID_VALID <= 1'b0;
+        BRANCH_FLUSHES <= BRANCH_FLUSHES + 1;
+        LOOP_COUNT <= EX_LCNT;
+        if (EX_LOOP) begin
+        LOOP_START <= ID_EX_NPC;
+        LOOP_END <= ID_EX_NPC + ID_EX_IMM;
+        end
+        end
+        else if (LOAD_USE || DIV_STALL) ;   // hold PC and IF_ID_IR
+        else if (FETCH_STOP || ID_HALT) begin
+        IF_ID_VALID <= 1'b0;
+        FETCH_STOP <= 1'b1;
+        end
+        else begin
+        IF_ID_VALID <= 1'b1;
+        IF_ID_IR <= IMEM_DATA;
+        IF_ID_NPC <= PC+1;
+        IF_ID_LCNT <= LOOP_COUNT - LOOP_HIT;
+        IF_ID_LEND <= LOOP_HIT;
+        LOOP_COUNT <= LOOP_COUNT - LOOP_HIT;
+        PC <= LOOP_BACK ? LOOP_START : PC+1;
+        end
+        end
+        end
+        
+        // DECODE STAGE 
+        always@(posedge clk or posedge reset)begin
+        if (reset) begin
+        ID_EX_TYPE <= NOP;
+        ID_EX_EXC <= 1'b0;
+        STALL_CYCLES <= 0;
+        end
+        else if (HALTED == 0) begin
+        if (TRAP) begin
+        ID_EX_TYPE <= NOP;
+        ID_EX_EXC <= 1'b0;
+        end
+        else if (DIV_STALL) ;            // hold ID_EX
+        else if (EX_TAKEN || !IF_ID_VALID) begin
+        ID_EX_TYPE <= NOP;
+        ID_EX_EXC <= 1'b0;
+        end
+        else if (LOAD_USE) begin
+        ID_EX_TYPE <= NOP;
+        ID_EX_EXC <= 1'b0;
+        STALL_CYCLES <= STALL_CYCLES + 1;
+        end
+        else begin
+        ID_EX_A <= ID_A;
+        ID_EX_B <= ID_B;
+        ID_EX_NPC <= IF_ID_NPC;
+        ID_EX_IR  <= IF_ID_IR;
+        ID_EX_IMM <= {{16{IF_ID_IR[15]}},{IF_ID_IR[15:0]}} ;
+        ID_EX_TYPE <= ID_TYPE;
+        ID_EX_EXC <= ID_EXC;
+        ID_EX_LCNT <= IF_ID_LCNT;
+        ID_EX_LEND <= IF_ID_LEND;
+        end
+        end
+        end
+        
+        // EXECUTE STAGE 
+        always @(posedge clk or posedge reset)begin
+        if (reset) begin
+        EX_MEM_TYPE <= NOP;
+        EX_MEM_EXC <= 1'b0;
+        DIV_RUN <= 1'b0;
+        DIV_FIN <= 1'b0;
+        MDU_STALLS <= 0;
+        end
+        else if (TRAP) begin             // squash EX , drop a divide in progress
+        EX_MEM_TYPE <= NOP;
+        EX_MEM_EXC <= 1'b0;
+        DIV_RUN <= 1'b0;
+        DIV_FIN <= 1'b0;
+        end
+        else if (HALTED == 0) begin
+        EX_MEM_TYPE <= DIV_STALL ? NOP : ID_EX_TYPE;
+        EX_MEM_EXC <= ID_EX_EXC;
+        EX_MEM_IR <= ID_EX_IR;
+        EX_MEM_B <= EX_B;
+        EX_MEM_EPC <= ID_EX_EXC ? ID_EX_NPC - 1 : EX_NEXT;
+        EX_MEM_LCNT <= EX_LCNT;
+        EX_MEM_LEND <= ID_EX_LEND;
+        EX_MEM_OLD_START <= LOOP_START;
+        EX_MEM_OLD_END <= LOOP_END;
+        
+        case(ID_EX_TYPE)
+        RR_ALU : begin case(ID_EX_IR[31:26])
+                       ADD: EX_MEM_ALUOUT <= EX_A + EX_B;
+                       SUB: EX_MEM_ALUOUT <= EX_A - EX_B;
+                       AND: EX_MEM_ALUOUT <= EX_A & EX_B;
+                       OR: EX_MEM_ALUOUT <= EX_A | EX_B;
+                       SLT: EX_MEM_ALUOUT <= EX_A < EX_B;
+                       MUL:  EX_MEM_ALUOUT <= EX_A * EX_B;
+                       DIV:  EX_MEM_ALUOUT <= DIV_Q;
+                       REM:  EX_MEM_ALUOUT <= DIV_R;
+                       ADDB , SUBB , ADDH , SUBH , ADDUSB , ADDUSH , CMPEQB , CMPEQH , CMPLTB , CMPLTH , SUMB :
+                             EX_MEM_ALUOUT <= SIMD(ID_EX_IR[31:26], EX_A, EX_B);
+                       endcase 
+                       end 
+        RM_ALU : begin case(ID_EX_IR[31:26])
+                       ADDI: EX_MEM_ALUOUT <= EX_A + ID_EX_IMM;
+                       SUBI: EX_MEM_ALUOUT <= EX_A - ID_EX_IMM;
+                       SLTI: EX_MEM_ALUOUT <= EX_A < ID_EX_IMM;
+                       default : EX_MEM_ALUOUT <= 32'hxxxxxxxx;
+                       endcase 
+                       end
+        LOAD , STORE  : EX_MEM_ALUOUT <= EX_A + ID_EX_IMM;
+        BRANCH : EX_MEM_ALUOUT <= ID_EX_NPC;   // link for JAL
+        default : EX_MEM_ALUOUT <= 32'hxxxxxxxx;
+        endcase
+        
+        if (DIV_STALL) begin
+        MDU_STALLS <= MDU_STALLS + 1;
+        if (!DIV_RUN) begin
+        DIV_RUN <= 1'b1;
+        DIV_COUNT <= 32;
+        DIV_Q <= EX_A;
+        DIV_R <= 0;
+        DIV_D <= EX_B;
+        end
+        else begin
+        if (!DIV_DIFF[33]) begin
+        DIV_R <= DIV_DIFF[31:0];
+        DIV_Q <= {DIV_Q[30:0] , 1'b1};
+        end
+        else begin
+        DIV_R <= DIV_SHIFT[31:0];
+        DIV_Q <= {DIV_Q[30:0] , 1'b0};
+        end
+        DIV_COUNT <= DIV_COUNT - 1;
+        if (DIV_COUNT == 1) begin
+        DIV_RUN <= 1'b0;
+        DIV_FIN <= 1'b1;
+        end
+        end
+        end
+        else DIV_FIN <= 1'b0;
+        end
+        end 
+        
+        //MEMORY STAGE
+        always@(posedge clk or posedge reset)begin 
+        if (reset) begin
+        MEM_WB_TYPE <= NOP;
+        MEM_WB_EXC <= 1'b0;
+        end
+        else if(HALTED == 0)begin 
+        MEM_WB_TYPE <= TRAP ? NOP : EX_MEM_TYPE;
+        MEM_WB_EXC <= EX_MEM_EXC && !TRAP;
+        MEM_WB_EPC <= EX_MEM_EPC;
+        MEM_WB_LCNT <= EX_MEM_LCNT;
+        MEM_WB_LEND <= EX_MEM_LEND;
+        MEM_WB_IR <= EX_MEM_IR;
+        case(EX_MEM_TYPE)
+        RR_ALU , RM_ALU , BRANCH: MEM_WB_ALUOUT <= EX_MEM_ALUOUT;
+        LOAD: MEM_WB_LMD <= PERF_ACCESS ? PERF_RDATA : DMEM_RDATA;   // STORE is written by DMEM on this edge
+        endcase 
+        end
+        end
+        
+    always @* begin
+    case (EX_MEM_ALUOUT[3:0])
+    4'd0 : PERF_RDATA = CYCLES;
+    4'd1 : PERF_RDATA = RETIRED;
+    4'd2 : PERF_RDATA = BRANCH_FLUSHES;
+    4'd3 : PERF_RDATA = STALL_CYCLES;
+    4'd6 : PERF_RDATA = BP_BRANCHES;
+    4'd7 : PERF_RDATA = BP_HITS;
+    4'd8 : PERF_RDATA = MDU_STALLS;
+    4'd10 : PERF_RDATA = TRAPS;
+    4'd11 : PERF_RDATA = {STATUS_EXL , STATUS_IE};
+    4'd12 : PERF_RDATA = CAUSE;
+    4'd13 : PERF_RDATA = EPC;
+    default : PERF_RDATA = 0;
+    endcase
+    end
+    
+    always @(posedge clk or posedge reset)begin
+    if (reset) begin
+    CYCLES <= 0;
+    RETIRED <= 0;
+    end
+    else if (HALTED == 0) begin
+    CYCLES <= CYCLES + 1;
+    if (MEM_WB_TYPE != NOP) RETIRED <= RETIRED + 1;
+    end
+    end
+    
+    // trap registers , on the edge the instruction in MEM_WB leaves WB ; a
+    // store in MEM is younger than an ERET in WB and wins
+    always @(posedge clk or posedge reset)begin
+    if (reset) begin
+    STATUS_IE <= 1'b0;
+    STATUS_EXL <= 1'b0;
+    CAUSE <= 0;
+    EPC <= 0;
+    TRAPS <= 0;
+    IRQ_LAST <= 1'b0;
+    IRQ_PENDING <= 1'b0;
+    end
+    else begin
+    IRQ_LAST <= irq;
+    IRQ_PENDING <= (IRQ_PENDING && !(TRAP && TRAP_INT)) || (irq && !IRQ_LAST);
+    if (MEM_WB_ERET && (HALTED == 0)) STATUS_EXL <= 1'b0;
+    if (CSR_STORE && (EX_MEM_ALUOUT[3:0] == 4'd11)) {STATUS_EXL , STATUS_IE} <= EX_MEM_B[1:0];
+    if (CSR_STORE && (EX_MEM_ALUOUT[3:0] == 4'd13)) EPC <= EX_MEM_B;
+    if (TRAP) begin
+    EPC <= MEM_WB_EPC;
+    CAUSE <= MEM_WB_EXC ? 10 : 0;
+    STATUS_EXL <= 1'b1;
+    TRAPS <= TRAPS + 1;
+    end
+    end
+    end
+        
+ always @(posedge clk or posedge reset)begin
+   if (reset) HALTED <= 1'b0;
+   else if (HALTED == 0)
+    case(MEM_WB_TYPE)
+    RR_ALU: Reg[MEM_WB_IR[15:11]] <= MEM_WB_ALUOUT;
+    RM_ALU : Reg[MEM_WB_IR[20:16]] <= MEM_WB_ALUOUT;
+    LOAD : Reg[MEM_WB_IR[20:16]] <= MEM_WB_LMD;
+    BRANCH : if (MEM_WB_IR[31:26] == JAL) Reg[31] <= MEM_WB_ALUOUT;
+    HALT: HALTED<= 1'b1;
+    endcase
+ end
+     
+endmodule
@@ -0,0 +1,139 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////////
+// Module Name: AXI_ARBITER
+// Description: Two AXI4 masters (S0_* , S1_*) onto one slave (M_*) , e.g. the
+//              MIPS D-cache and dma_controller onto AXI_RAM. The read and
+//              write channels are arbitrated separately : a channel is
+//              granted to a master with ARVALID / AWVALID , round robin when
+//              both ask , and kept for its whole burst (up to the RLAST beat
+//              / the B response). The address goes out on the cycle after
+//              the grant , W beats of the other master wait with WREADY low.
+//              RGRANTS / WGRANTS count the bursts of each master.
+// Dependencies: none
+//////////////////////////////////////////////////////////////////////////////////
+
+
+module AXI_ARBITER (
+    input clk , input reset ,
+
+    // master 0
+    input [31:0] S0_ARADDR , input [7:0] S0_ARLEN , input [2:0] S0_ARSIZE , input [1:0] S0_ARBURST ,
+    input S0_ARVALID , output S0_ARREADY ,
+    output [31:0] S0_RDATA , output [1:0] S0_RRESP , output S0_RLAST , output S0_RVALID , input S0_RREADY ,
+    input [31:0] S0_AWADDR , input [7:0] S0_AWLEN , input [2:0] S0_AWSIZE , input [1:0] S0_AWBURST ,
+    input S0_AWVALID , output S0_AWREADY ,
+    input [31:0] S0_WDATA , input [3:0] S0_WSTRB , input S0_WLAST , input S0_WVALID , output S0_WREADY ,
+    output [1:0] S0_BRESP , output S0_BVALID , input S0_BREADY ,
+
+    // master 1
+    input [31:0] S1_ARADDR , input [7:0] S1_ARLEN , input [2:0] S1_ARSIZE , input [1:0] S1_ARBURST ,
+    input S1_ARVALID , output S1_ARREADY ,
+    output [31:0] S1_RDATA , output [1:0] S1_RRESP , output S1_RLAST , output S1_RVALID , input S1_RREADY ,
+    input [31:0] S1_AWADDR , input [7:0] S1_AWLEN , input [2:0] S1_AWSIZE , input [1:0] S1_AWBURST ,
+    input S1_AWVALID , output S1_AWREADY ,
+    input [31:0] S1_WDATA , input [3:0] S1_WSTRB , input S1_WLAST , input S1_WVALID , output S1_WREADY ,
+    output [1:0] S1_BRESP , output S1_BVALID , input S1_BREADY ,
+
+    // slave
+    output [31:0] M_ARADDR , output [7:0] M_ARLEN , output [2:0] M_ARSIZE , output [1:0] M_ARBURST ,
+    output M_ARVALID , input M_ARREADY ,
+    input [31:0] M_RDATA , input [1:0] M_RRESP , input M_RLAST , input M_RVALID , output M_RREADY ,
+    output [31:0] M_AWADDR , output [7:0] M_AWLEN , output [2:0] M_AWSIZE , output [1:0] M_AWBURST ,
+    output M_AWVALID , input M_AWREADY ,
+    output [31:0] M_WDATA , output [3:0] M_WSTRB , output M_WLAST , output M_WVALID , input M_WREADY ,
+    input [1:0] M_BRESP , input M_BVALID , output M_BREADY ,
+
+    output reg [31:0] RGRANTS0 , RGRANTS1 , WGRANTS0 , WGRANTS1
+    );
+
+    reg RBUSY , RSENT , ROWN;                // read channel granted , AR passed on , to master ROWN
+    reg WBUSY , WSENT , WOWN;
+    reg RLASTOWN , WLASTOWN;                 // master granted last , loses a tie
+
+    wire RPICK = (S0_ARVALID && S1_ARVALID) ? !RLASTOWN : S1_ARVALID;
+    wire WPICK = (S0_AWVALID && S1_AWVALID) ? !WLASTOWN : S1_AWVALID;
+
+    assign M_ARADDR = ROWN ? S1_ARADDR : S0_ARADDR;
+    assign M_ARLEN = ROWN ? S1_ARLEN : S0_ARLEN;
+    assign M_ARSIZE = ROWN ? S1_ARSIZE : S0_ARSIZE;
+    assign M_ARBURST = ROWN ? S1_ARBURST : S0_ARBURST;
+    assign M_ARVALID = RBUSY && !RSENT && (ROWN ? S1_ARVALID : S0_ARVALID);
+    assign S0_ARREADY = RBUSY && !RSENT && !ROWN && M_ARREADY;
+    assign S1_ARREADY = RBUSY && !RSENT && ROWN && M_ARREADY;
+    assign S0_RDATA = M_RDATA;
+    assign S1_RDATA = M_RDATA;
+    assign S0_RRESP = M_RRESP;
+    assign S1_RRESP = M_RRESP;
+    assign S0_RLAST = M_RLAST;
+    assign S1_RLAST = M_RLAST;
+    assign S0_RVALID = RBUSY && RSENT && !ROWN && M_RVALID;
+    assign S1_RVALID = RBUSY && RSENT && ROWN && M_RVALID;
+    assign M_RREADY = RBUSY && RSENT && (ROWN ? S1_RREADY : S0_RREADY);
+
+    assign M_AWADDR = WOWN ? S1_AWADDR : S0_AWADDR;
+    assign M_AWLEN = WOWN ? S1_AWLEN : S0_AWLEN;
+    assign M_AWSIZE = WOWN ? S1_AWSIZE : S0_AWSIZE;
+    assign M_AWBURST = WOWN ? S1_AWBURST : S0_AWBURST;
+    assign M_AWVALID = WBUSY && !WSENT && (WOWN ? S1_AWVALID : S0_AWVALID);
+    assign S0_AWREADY = WBUSY && !WSENT && !WOWN && M_AWREADY;
+    assign S1_AWREADY = WBUSY && !WSENT && WOWN && M_AWREADY;
+    assign M_WDATA = WOWN ? S1_WDATA : S0_WDATA;
+    assign M_WSTRB = WOWN ? S1_WSTRB : S0_WSTRB;
+    assign M_WLAST = WOWN ? S1_WLAST : S0_WLAST;
+    assign M_WVALID = WBUSY && (WOWN ? S1_WVALID : S0_WVALID);
+    assign S0_WREADY = WBUSY && !WOWN && M_WREADY;
+    assign S1_WREADY = WBUSY && WOWN && M_WREADY;
+    assign S0_BRESP = M_BRESP;
+    assign S1_BRESP = M_BRESP;
+    assign S0_BVALID = WBUSY && !WOWN && M_BVALID;
+    assign S1_BVALID = WBUSY && WOWN && M_BVALID;
+    assign M_BREADY = WBUSY && (WOWN ? S1_BREADY : S0_BREADY);
+
+    always @(posedge clk or posedge reset) begin
+    if (reset) begin
+    RBUSY <= 1'b0;
+    RSENT <= 1'b0;
+    ROWN <= 1'b0;
+    WBUSY <= 1'b0;
+    WSENT <= 1'b0;
+    WOWN <= 1'b0;
+    RLASTOWN <= 1'b1;
+    WLASTOWN <= 1'b1;
+    RGRANTS0 <= 0;
+    RGRANTS1 <= 0;
+    WGRANTS0 <= 0;
+    WGRANTS1 <= 0;
+    end
+    else begin
+    if (!RBUSY) begin
+    if (S0_ARVALID || S1_ARVALID) begin
+    RBUSY <= 1'b1;
+    RSENT <= 1'b0;
+    ROWN <= RPICK;
+    RLASTOWN <= RPICK;
+    if (RPICK) RGRANTS1 <= RGRANTS1 + 1;
+    else RGRANTS0 <= RGRANTS0 + 1;
+    end
+    end
+    else begin
+    if (M_ARVALID && M_ARREADY) RSENT <= 1'b1;
+    if (M_RVALID && M_RREADY && M_RLAST) RBUSY <= 1'b0;
+    end
+
+    if (!WBUSY) begin
+    if (S0_AWVALID || S1_AWVALID) begin
+    WBUSY <= 1'b1;
+    WSENT <= 1'b0;
+    WOWN <= WPICK;
+    WLASTOWN <= WPICK;
+    if (WPICK) WGRANTS1 <= WGRANTS1 + 1;
+    else WGRANTS0 <= WGRANTS0 + 1;
+    end
+    end
+    else begin
+    if (M_AWVALID && M_AWREADY) WSENT <= 1'b1;
+    if (M_BVALID && M_BREADY) WBUSY <= 1'b0;
+    end
+    end
+    end
+endmodule
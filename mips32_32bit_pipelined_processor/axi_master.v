@@ -0,0 +1,143 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////////
+// Module Name: AXI_MASTER
+// Description: AXI4 master for a cache line port. It answers the same
+//              line_req / line_we / line_addr handshake as DMEM in MIPS.v
+//              (line_done held for one cycle , the requester drops line_req
+//              on that edge) with one INCR burst of LINE_WORDS 32-bit beats :
+//              a refill is an AR burst whose R beats fill line_data , a
+//              write-back puts AW and the W beats out together and waits for
+//              B. line_addr is a word address , the AXI side uses byte
+//              addresses (word * 4) like dma_controller. One transaction is
+//              outstanding at a time. SLVERR / DECERR responses are counted
+//              in ERRORS ; the data is taken as it is.
+// Dependencies: none
+//////////////////////////////////////////////////////////////////////////////////
+
+
+module AXI_MASTER #(parameter LINE_WORDS = 4     // burst length , 1 to 256
+    ) (
+    input clk , input reset ,
+
+    // line port , as DMEM's
+    input line_req ,
+    input line_we ,
+    input [31:0] line_addr ,                 // word address , line aligned
+    input [32*LINE_WORDS-1:0] line_wdata ,
+    output reg [32*LINE_WORDS-1:0] line_data ,
+    output reg line_done ,
+
+    // AXI4 read address / data
+    output [31:0] ARADDR ,
+    output [7:0] ARLEN ,
+    output [2:0] ARSIZE ,
+    output [1:0] ARBURST ,
+    output reg ARVALID ,
+    input ARREADY ,
+    input [31:0] RDATA ,
+    input [1:0] RRESP ,
+    input RLAST ,
+    input RVALID ,
+    output RREADY ,
+
+    // AXI4 write address / data / response
+    output [31:0] AWADDR ,
+    output [7:0] AWLEN ,
+    output [2:0] AWSIZE ,
+    output [1:0] AWBURST ,
+    output reg AWVALID ,
+    input AWREADY ,
+    output [31:0] WDATA ,
+    output [3:0] WSTRB ,
+    output WLAST ,
+    output reg WVALID ,
+    input WREADY ,
+    input [1:0] BRESP ,
+    input BVALID ,
+    output BREADY ,
+
+    output reg [31:0] ERRORS                 // non-OKAY responses
+    );
+
+    parameter S_IDLE = 3'b000 , S_AR = 3'b001 , S_R = 3'b010 , S_W = 3'b011 , S_B = 3'b100 , S_RESP = 3'b101;
+    localparam BEAT_BITS = $clog2(LINE_WORDS) + 1;
+
+    reg [2:0] STATE;
+    reg [31:0] ADDR;                         // byte address of the burst
+    reg [BEAT_BITS-1:0] BEAT;
+
+    assign ARADDR = ADDR;
+    assign ARLEN = LINE_WORDS - 1;
+    assign ARSIZE = 3'b010;                  // 4 bytes a beat
+    assign ARBURST = 2'b01;                  // INCR
+    assign RREADY = (STATE == S_R);
+    assign AWADDR = ADDR;
+    assign AWLEN = LINE_WORDS - 1;
+    assign AWSIZE = 3'b010;
+    assign AWBURST = 2'b01;
+    assign WDATA = line_wdata[BEAT*32 +: 32];
+    assign WSTRB = 4'b1111;
+    assign WLAST = (BEAT == LINE_WORDS - 1);
+    assign BREADY = (STATE == S_B);
+
+    // S_W is left once AW has been taken and the last beat goes on this edge
+    wire AW_DONE = !AWVALID || AWREADY;
+    wire W_DONE = !WVALID || (WREADY && WLAST);
+
+    always @(posedge clk or posedge reset) begin
+    if (reset) begin
+    STATE <= S_IDLE;
+    ARVALID <= 1'b0;
+    AWVALID <= 1'b0;
+    WVALID <= 1'b0;
+    line_done <= 1'b0;
+    ERRORS <= 0;
+    end
+    else case (STATE)
+    S_IDLE : if (line_req) begin
+             ADDR <= {line_addr[29:0] , 2'b00};
+             BEAT <= 0;
+             if (line_we) begin
+             AWVALID <= 1'b1;
+             WVALID <= 1'b1;
+             STATE <= S_W;
+             end
+             else begin
+             ARVALID <= 1'b1;
+             STATE <= S_AR;
+             end
+             end
+    S_AR :   if (ARREADY) begin
+             ARVALID <= 1'b0;
+             STATE <= S_R;
+             end
+    S_R :    if (RVALID) begin
+             line_data[BEAT*32 +: 32] <= RDATA;
+             BEAT <= BEAT + 1;
+             if (RRESP != 2'b00) ERRORS <= ERRORS + 1;
+             if (RLAST) begin
+             line_done <= 1'b1;
+             STATE <= S_RESP;
+             end
+             end
+    S_W :    begin
+             if (AWVALID && AWREADY) AWVALID <= 1'b0;
+             if (WVALID && WREADY) begin
+             if (WLAST) WVALID <= 1'b0;
+             else BEAT <= BEAT + 1;
+             end
+             if (AW_DONE && W_DONE) STATE <= S_B;
+             end
+    S_B :    if (BVALID) begin
+             if (BRESP != 2'b00) ERRORS <= ERRORS + 1;
+             line_done <= 1'b1;
+             STATE <= S_RESP;
+             end
+    S_RESP : begin   // requester drops line_req on this edge
+             line_done <= 1'b0;
+             STATE <= S_IDLE;
+             end
+    default : STATE <= S_IDLE;
+    endcase
+    end
+endmodule
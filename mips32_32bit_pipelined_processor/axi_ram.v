@@ -0,0 +1,119 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////////
+// Module Name: AXI_RAM
+// Description: AXI4 slave memory for SoC simulations , DEPTH 32-bit words
+//              at byte address 0 (the address wraps , like DMEM). Reads and
+//              writes are served independently , one burst of each at a
+//              time : the first R beat comes LATENCY (>= 1) cycles after AR
+//              is taken and then one beat per cycle , B comes LATENCY
+//              cycles after the last W beat. INCR bursts only (FIXED / WRAP
+//              are taken as INCR) of 4-byte beats , WSTRB selects the bytes
+//              written. Responses are always OKAY.
+//              Mem[] is word indexed and can be preloaded with INIT_FILE or
+//              +AXIRAM=<file>.
+// Dependencies: none
+//////////////////////////////////////////////////////////////////////////////////
+
+
+module AXI_RAM #(parameter DEPTH = 4096 ,   // power of two
+    parameter LATENCY = 8 ,
+    parameter INIT_FILE = ""
+    ) (
+    input clk , input reset ,
+
+    input [31:0] ARADDR ,
+    input [7:0] ARLEN ,
+    input [2:0] ARSIZE ,
+    input [1:0] ARBURST ,
+    input ARVALID ,
+    output ARREADY ,
+    output [31:0] RDATA ,
+    output [1:0] RRESP ,
+    output RLAST ,
+    output RVALID ,
+    input RREADY ,
+
+    input [31:0] AWADDR ,
+    input [7:0] AWLEN ,
+    input [2:0] AWSIZE ,
+    input [1:0] AWBURST ,
+    input AWVALID ,
+    output AWREADY ,
+    input [31:0] WDATA ,
+    input [3:0] WSTRB ,
+    input WLAST ,
+    input WVALID ,
+    output WREADY ,
+    output [1:0] BRESP ,
+    output BVALID ,
+    input BREADY
+    );
+    reg [31:0] Mem [0:DEPTH-1];
+    reg [8*256-1:0] file;
+    parameter S_IDLE = 2'b00 , S_WAIT = 2'b01 , S_DATA = 2'b10 , S_RESP = 2'b11;
+
+    reg [1:0] RSTATE , WSTATE;
+    reg [31:0] RADDR , WADDR;                // word addresses
+    reg [7:0] RLEFT;                         // R beats after the current one
+    reg [15:0] RCOUNT , WCOUNT;
+    integer k;
+
+    initial begin
+    if (INIT_FILE != "") $readmemh(INIT_FILE, Mem);
+    if ($value$plusargs("AXIRAM=%s", file)) $readmemh(file, Mem);
+    end
+
+    assign ARREADY = (RSTATE == S_IDLE);
+    assign RVALID = (RSTATE == S_DATA);
+    assign RDATA = Mem[RADDR[$clog2(DEPTH)-1:0]];
+    assign RRESP = 2'b00;
+    assign RLAST = (RLEFT == 0);
+    assign AWREADY = (WSTATE == S_IDLE);
+    assign WREADY = (WSTATE == S_DATA);
+    assign BVALID = (WSTATE == S_RESP);
+    assign BRESP = 2'b00;
+
+    always @(posedge clk or posedge reset) begin
+    if (reset) begin
+    RSTATE <= S_IDLE;
+    WSTATE <= S_IDLE;
+    end
+    else begin
+    case (RSTATE)
+    S_IDLE : if (ARVALID) begin
+             RADDR <= ARADDR >> 2;
+             RLEFT <= ARLEN;
+             RCOUNT <= LATENCY;
+             RSTATE <= S_WAIT;
+             end
+    S_WAIT : if (RCOUNT <= 1) RSTATE <= S_DATA;
+             else RCOUNT <= RCOUNT - 1;
+    S_DATA : if (RREADY) begin
+             if (RLEFT == 0) RSTATE <= S_IDLE;
+             RADDR <= RADDR + 1;
+             RLEFT <= RLEFT - 1;
+             end
+    default : RSTATE <= S_IDLE;
+    endcase
+
+    case (WSTATE)
+    S_IDLE : if (AWVALID) begin
+             WADDR <= AWADDR >> 2;
+             WSTATE <= S_DATA;
+             end
+    S_DATA : if (WVALID) begin
+             for (k = 0; k < 4; k = k + 1)
+             if (WSTRB[k]) Mem[WADDR[$clog2(DEPTH)-1:0]][k*8 +: 8] <= WDATA[k*8 +: 8];
+             WADDR <= WADDR + 1;
+             if (WLAST) begin
+             WCOUNT <= LATENCY;
+             WSTATE <= S_WAIT;
+             end
+             end
+    S_WAIT : if (WCOUNT <= 1) WSTATE <= S_RESP;
+             else WCOUNT <= WCOUNT - 1;
+    S_RESP : if (BREADY) WSTATE <= S_IDLE;
+    endcase
+    end
+    end
+endmodule
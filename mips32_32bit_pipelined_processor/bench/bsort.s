@@ -0,0 +1,27 @@
+# bubble sort : sorts N words ascending (unsigned , SLT) in place.
+# Data-dependent branches around the swap stores.
+# expect Mem[arr] = 28 91 104 116 121 124 165 260
+# expect Mem[arr+8] = 285 287 288 421 512 758 817 837
+
+        .equ  N, 16
+        .data
+arr:
+        .word 817, 288, 512, 260, 104, 124, 837, 91
+        .word 285, 287, 121, 28, 165, 758, 421, 116
+
+        .text
+        ADDI  R1, R0, N-1       # pass count
+outer:  ADDI  R2, R0, arr       # p
+        ADD   R3, R1, R0        # compares this pass
+inner:  LW    R4, 0(R2)
+        LW    R5, 1(R2)
+        SLT   R6, R5, R4        # p[1] < p[0]
+        BEQZ  R6, noswap
+        SW    R5, 0(R2)
+        SW    R4, 1(R2)
+noswap: ADDI  R2, R2, 1
+        SUBI  R3, R3, 1
+        BNEQZ R3, inner
+        SUBI  R1, R1, 1
+        BNEQZ R1, outer
+        HLT
@@ -0,0 +1,34 @@
+# packed bytes : checksum and space count of a 64-character string , four
+# characters per word. SUMB adds the bytes of a word , CMPEQB marks the
+# spaces with 0xff lanes and the AND keeps one count bit of each lane.
+# expect Mem[result] = 5926 13
+# expect R5 = 5926
+# expect R6 = 13
+
+        .equ  N, 16
+        .data
+text:                           # "the quick brown fox jumps over the lazy dog, then naps in the su"
+        .word 0x20656874, 0x63697571, 0x7262206b, 0x206e776f, 0x20786f66, 0x706d756a, 0x766f2073, 0x74207265
+        .word 0x6c206568, 0x20797a61, 0x2c676f64, 0x65687420, 0x616e206e, 0x69207370, 0x6874206e, 0x75732065
+spaces: .word 0x20202020
+ones:   .word 0x01010101
+result: .space 2
+
+        .text
+        LW    R7, spaces(R0)
+        LW    R8, ones(R0)
+        ADDI  R1, R0, text
+        ADDI  R3, R0, N
+        ADDI  R5, R0, 0
+        ADDI  R6, R0, 0
+loop:   LW    R4, 0(R1)
+        SUMB  R5, R4, R5        # checksum
+        CMPEQB R9, R4, R7       # 0xff where a space is
+        AND   R9, R9, R8
+        SUMB  R6, R9, R6        # spaces
+        ADDI  R1, R1, 1
+        SUBI  R3, R3, 1
+        BNEQZ R3, loop
+        SW    R5, result(R0)
+        SW    R6, result+1(R0)
+        HLT
@@ -0,0 +1,39 @@
+# Recursive calls : R2 = F(N) by the doubly recursive definition , the
+# return address , n and F(n-1) of each frame kept on a stack in memory.
+# JAL / JR R31 from two call sites at every depth up to N.
+# expect R2 = 55
+# expect R3 = 177
+# expect Mem[result] = 55
+
+        .equ  N, 10
+        .data
+result: .space 1
+stack:  .space 30              # 3 words a frame , N deep
+
+        .text
+        ADDI  R29, R0, stack    # stack pointer
+        ADDI  R1, R0, N
+        JAL   fib
+        SW    R2, result(R0)
+        HLT
+
+# R2 = F(R1) , R3 counts the calls ; R1 and R29 are preserved
+fib:    ADDI  R3, R3, 1
+        SLTI  R4, R1, 2
+        BEQZ  R4, rec
+        MOV   R2, R1            # F(0) = 0 , F(1) = 1
+        JR    R31
+rec:    SW    R31, 0(R29)
+        SW    R1, 1(R29)
+        ADDI  R29, R29, 3
+        SUBI  R1, R1, 1
+        JAL   fib               # F(n-1)
+        SW    R2, -1(R29)
+        SUBI  R1, R1, 1
+        JAL   fib               # F(n-2)
+        LW    R5, -1(R29)
+        ADD   R2, R2, R5
+        LW    R1, -2(R29)
+        LW    R31, -3(R29)
+        SUBI  R29, R29, 3
+        JR    R31
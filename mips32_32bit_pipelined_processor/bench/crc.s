@@ -0,0 +1,40 @@
+# CRC-32/MPEG-2 (poly 0x04c11db7 , MSB first , init 0xffffffff , no final
+# xor) of "123456789" , one byte per word ; the check value is 0x0376e6e7.
+# The ISA has no XOR or shifts : a ^ b = (a | b) - (a & b) , << 1 is an ADD ,
+# << 24 a MUL and the top bit is tested with an unsigned SLT.
+# expect Mem[result] = 0x0376e6e7
+# expect R1 = 0x0376e6e7
+
+        .data
+msg:    .word '1', '2', '3', '4', '5', '6', '7', '8', '9'
+poly:   .word 0x04c11db7
+top:    .word 0x7fffffff        # crc > top : bit 31 set
+b24:    .word 0x01000000
+result: .space 1
+
+        .text
+        LW    R7, poly(R0)
+        LW    R8, top(R0)
+        LW    R9, b24(R0)
+        SUBI  R1, R0, 1         # crc = 0xffffffff
+        ADDI  R2, R0, msg
+        ADDI  R3, R0, 9
+byte:   LW    R4, 0(R2)
+        MUL   R4, R4, R9        # byte << 24
+        OR    R5, R1, R4        # crc ^= byte << 24
+        AND   R6, R1, R4
+        SUB   R1, R5, R6
+        ADDI  R10, R0, 8
+bit:    SLT   R11, R8, R1       # top bit
+        ADD   R1, R1, R1        # crc <<= 1
+        BEQZ  R11, next
+        OR    R5, R1, R7        # crc ^= poly
+        AND   R6, R1, R7
+        SUB   R1, R5, R6
+next:   SUBI  R10, R10, 1
+        BNEQZ R10, bit
+        ADDI  R2, R2, 1
+        SUBI  R3, R3, 1
+        BNEQZ R3, byte
+        SW    R1, result(R0)
+        HLT
@@ -0,0 +1,32 @@
+# dot product : result = sum a[i] * b[i] over N elements.
+# Two loads feeding a MUL and an accumulate every iteration.
+# expect Mem[result] = 249652
+# expect R5 = 249652
+
+        .equ  N, 24
+        .data
+a:
+        .word 66, 92, 161, 161, 132, 38, 41, 141
+        .word 170, 169, 70, 42, 2, 166, 17, 31
+        .word 152, 86, 7, 21, 70, 52, 97, 103
+b:
+        .word 149, 112, 155, 24, 164, 175, 28, 148
+        .word 150, 163, 162, 93, 46, 24, 191, 124
+        .word 131, 172, 49, 69, 115, 159, 55, 124
+result: .space 1
+
+        .text
+        ADDI  R1, R0, a
+        ADDI  R2, R0, b
+        ADDI  R3, R0, N
+        ADDI  R5, R0, 0
+loop:   LW    R6, 0(R1)
+        LW    R7, 0(R2)
+        MUL   R8, R6, R7
+        ADD   R5, R5, R8
+        ADDI  R1, R1, 1
+        ADDI  R2, R2, 1
+        SUBI  R3, R3, 1
+        BNEQZ R3, loop
+        SW    R5, result(R0)
+        HLT
@@ -0,0 +1,25 @@
+# Fibonacci : fib[i] = F(i) for i < N , iteratively.
+# A tight loop of dependent ALU ops.
+# expect Mem[fib] = 0 1 1 2 3 5 8 13
+# expect Mem[fib+8] = 21 34 55 89 144 233 377 610
+# expect Mem[fib+16] = 987 1597 2584 4181 6765 10946 17711 28657
+# expect Mem[fib+24] = 46368
+# expect R1 = 75025
+
+        .equ  N, 25
+        .data
+fib:    .space N
+
+        .text
+        ADDI  R1, R0, 0         # F(i)
+        ADDI  R2, R0, 1         # F(i+1)
+        ADDI  R3, R0, fib
+        ADDI  R4, R0, N
+loop:   SW    R1, 0(R3)
+        ADD   R5, R1, R2
+        MOV   R1, R2
+        MOV   R2, R5
+        ADDI  R3, R3, 1
+        SUBI  R4, R4, 1
+        BNEQZ R4, loop
+        HLT
@@ -0,0 +1,32 @@
+# linked-list walk : sums the values of a list of nodes {value , next}
+# scattered through a pool , next = 0 ends the list.
+# Pointer chasing : every next load feeds the following load and the branch.
+# expect Mem[sum] = 8827 16
+# expect R2 = 8827
+
+        .data 0x100             # keeps address 0 free for the null pointer
+head:   .word pool+0
+sum:    .space 1
+count:  .space 1
+pool:
+        .word 521, pool+14, 322, pool+50, 0, 0, 0, 0
+        .word 0, 0, 394, pool+60, 984, pool+38, 661, pool+16
+        .word 862, pool+54, 793, pool+22, 567, pool+18, 932, pool+2
+        .word 0, 0, 0, 0, 0, 0, 0, 0
+        .word 376, pool+58, 0, 0, 0, 0, 398, pool+42
+        .word 0, 0, 560, pool+20, 0, 0, 0, 0
+        .word 0, 0, 500, 0, 0, 0, 203, pool+32
+        .word 0, 0, 503, pool+10, 251, pool+12, 0, 0
+
+        .text
+        LW    R1, head(R0)
+        ADDI  R2, R0, 0         # sum
+        ADDI  R3, R0, 0         # count
+walk:   LW    R4, 0(R1)         # value
+        LW    R1, 1(R1)         # next
+        ADD   R2, R2, R4
+        ADDI  R3, R3, 1
+        BNEQZ R1, walk
+        SW    R2, sum(R0)
+        SW    R3, count(R0)
+        HLT
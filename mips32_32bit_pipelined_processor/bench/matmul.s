@@ -0,0 +1,55 @@
+# matrix multiply : C = A * B , N x N words , row-major.
+# Triple loop , a MUL-ADD chain in the inner loop and strided loads of B.
+# expect Mem[C] = 2825 3290 3901 4488 5685 2566
+# expect Mem[C+6] = 2409 2913 3370 4126 4766 2203
+# expect Mem[C+12] = 2481 3179 3545 3806 4547 2157
+# expect Mem[C+18] = 2366 2895 2891 3075 5086 1977
+# expect Mem[C+24] = 1965 3051 3130 3622 5223 2208
+# expect Mem[C+30] = 2019 3559 3638 3336 4977 2282
+
+        .equ  N, 6
+        .equ  NN, 36
+        .data
+A:
+        .word 43, 33, 37, 5, 27, 30
+        .word 43, 10, 34, 24, 29, 19
+        .word 31, 29, 27, 26, 38, 6
+        .word 16, 30, 25, 15, 28, 39
+        .word 31, 4, 36, 9, 31, 45
+        .word 17, 36, 28, 1, 45, 25
+B:
+        .word 27, 1, 22, 45, 36, 23
+        .word 30, 16, 22, 19, 33, 12
+        .word 2, 40, 35, 30, 16, 6
+        .word 24, 6, 2, 12, 19, 1
+        .word 0, 37, 32, 18, 33, 22
+        .word 16, 7, 2, 9, 49, 12
+C:      .space NN
+
+        .text
+        ADDI  R1, R0, A         # row of A
+        ADDI  R9, R0, C         # next element of C
+        ADDI  R10, R0, N        # rows left
+iloop:  ADDI  R2, R0, B         # column of B
+        ADDI  R11, R0, N        # columns left
+jloop:  ADD   R3, R1, R0        # A[i][k]
+        ADD   R4, R2, R0        # B[k][j]
+        ADDI  R5, R0, 0         # sum
+        ADDI  R12, R0, N
+kloop:  LW    R6, 0(R3)
+        LW    R7, 0(R4)
+        MUL   R8, R6, R7
+        ADD   R5, R5, R8
+        ADDI  R3, R3, 1
+        ADDI  R4, R4, N
+        SUBI  R12, R12, 1
+        BNEQZ R12, kloop
+        SW    R5, 0(R9)
+        ADDI  R9, R9, 1
+        ADDI  R2, R2, 1
+        SUBI  R11, R11, 1
+        BNEQZ R11, jloop
+        ADDI  R1, R1, N
+        SUBI  R10, R10, 1
+        BNEQZ R10, iloop
+        HLT
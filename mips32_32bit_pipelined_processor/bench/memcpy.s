@@ -0,0 +1,32 @@
+# memcpy : copies N words from src to dst , one word per iteration.
+# Load / store streaming with a short loop-carried pointer chain.
+# expect Mem[dst] = 0x1b591d75 0x9daa37e5 0xb3dca50a 0xc15521b1 0xa6ec39c1 0x86f0ce2e 0xf0baef3a 0x3f372617
+# expect Mem[dst+8] = 0x4567ceb1 0xbc319994 0x417a8105 0x4a800646 0xbbeb508f 0x12979bfc 0xa8902e32 0x732242fd
+# expect Mem[dst+16] = 0x4d909eb2 0x77744cca 0xaf29e6f8 0xdf7142dc 0x658c6762 0x64d0b50f 0xc70b53bf 0xe8af30f7
+# expect Mem[dst+24] = 0x1e4f6f2a 0x4375d034 0x3927f7d6 0xdeeda8b2 0xe6c648e7 0x50cef798 0x5ba80780 0xcecf4f4e
+# expect R3 = 0
+
+        .equ  N, 32
+        .data
+src:
+        .word 0x1b591d75, 0x9daa37e5, 0xb3dca50a, 0xc15521b1
+        .word 0xa6ec39c1, 0x86f0ce2e, 0xf0baef3a, 0x3f372617
+        .word 0x4567ceb1, 0xbc319994, 0x417a8105, 0x4a800646
+        .word 0xbbeb508f, 0x12979bfc, 0xa8902e32, 0x732242fd
+        .word 0x4d909eb2, 0x77744cca, 0xaf29e6f8, 0xdf7142dc
+        .word 0x658c6762, 0x64d0b50f, 0xc70b53bf, 0xe8af30f7
+        .word 0x1e4f6f2a, 0x4375d034, 0x3927f7d6, 0xdeeda8b2
+        .word 0xe6c648e7, 0x50cef798, 0x5ba80780, 0xcecf4f4e
+dst:    .space N
+
+        .text
+        ADDI  R1, R0, src
+        ADDI  R2, R0, dst
+        ADDI  R3, R0, N
+loop:   LW    R4, 0(R1)
+        ADDI  R1, R1, 1
+        SW    R4, 0(R2)
+        ADDI  R2, R2, 1
+        SUBI  R3, R3, 1
+        BNEQZ R3, loop
+        HLT
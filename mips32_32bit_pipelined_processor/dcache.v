@@ -0,0 +1,308 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////////
+// Module Name: DCACHE
+// Description: Write-back , write-allocate data cache for the MIPS MEM stage ,
+//              SETS x WAYS lines of LINE_WORDS words with round-robin
+//              replacement , plus a coalescing store buffer of SB_ENTRIES
+//              words.
+//              Stores only wait when the buffer is full ; a store to a word
+//              that is already buffered overwrites that entry. Loads are
+//              answered from the buffer first , then from the cache.
+//              The buffer drains one word per cycle into the cache while the
+//              miss FSM is idle ; a drain that misses allocates the line.
+//              The miss FSM writes back a dirty victim (S_WB) and then
+//              refills the line (S_FILL) from the latency-configurable
+//              backing store. A load miss has priority over a drain.
+//              While flush is high the buffer is drained and every dirty line
+//              written back , flushed then says the backing store is current.
+//              With MSHRS > 0 a load miss does not wait : it is taken into a
+//              miss status holding register (ready high , miss high) with the
+//              register it loads (tag) and the port is free for the next
+//              access , so later hits are answered under the miss. A miss to
+//              a line already outstanding only adds a target to it. The FSM
+//              refills the waiting lines one after another ahead of store
+//              buffer drains ; every target of a line takes its word from
+//              the refill , then they are returned one per cycle on fill_*
+//              and freed by fill_ack on the next edge. pending has a bit for
+//              each register still waiting. A load miss waits only while
+//              every MSHR is taken.
+// Dependencies: backing memory with a line port (DMEM in MIPS.v)
+//////////////////////////////////////////////////////////////////////////////////
+
+
+module DCACHE #(parameter SETS = 16 ,      // power of two >= 2
+    parameter WAYS = 2 ,
+    parameter LINE_WORDS = 4 ,              // power of two >= 2
+    parameter SB_ENTRIES = 4 ,
+    parameter MSHRS = 0                     // miss status holding registers , 0 : a load miss blocks
+    ) (
+    input clk , input reset ,
+
+    // MEM stage side , the access is performed on the edge where ready is high
+    input load ,
+    input store ,
+    input [31:0] addr ,                     // word address
+    input [31:0] wdata ,
+    output ready ,
+    output [31:0] rdata ,
+    output miss ,                           // the load was taken into an MSHR , rdata is not its word
+    input [4:0] tag ,                       // register a load writes
+
+    // completed misses (MSHRS > 0)
+    output fill_valid ,
+    output [4:0] fill_tag ,
+    output [31:0] fill_data ,
+    input fill_ack ,                        // fill_* was taken on the last edge of the other clock
+    output reg [31:0] pending ,             // registers with a load miss outstanding
+
+    input flush ,
+    output flushed ,
+
+    // backing memory side , one line per request
+    output mem_req ,
+    output mem_we ,
+    output [31:0] mem_addr ,
+    output [32*LINE_WORDS-1:0] mem_wline ,
+    input [32*LINE_WORDS-1:0] mem_line ,
+    input mem_done
+    );
+
+    localparam OFF_BITS = $clog2(LINE_WORDS) , IDX_BITS = $clog2(SETS) , TAG_BITS = 32 - OFF_BITS - IDX_BITS;
+    parameter S_IDLE = 2'b00 , S_WB = 2'b01 , S_FILL = 2'b10;
+
+    reg [SETS*WAYS-1:0] VALID , DIRTY;
+    reg [TAG_BITS-1:0] TAG [0:SETS*WAYS-1];
+    reg [32*LINE_WORDS-1:0] DATA [0:SETS*WAYS-1];
+    reg [7:0] VICTIM [0:SETS-1];
+
+    reg [SB_ENTRIES-1:0] SB_VALID;
+    reg [31:0] SB_ADDR [0:SB_ENTRIES-1];
+    reg [31:0] SB_DATA [0:SB_ENTRIES-1];
+
+    reg [31:0] HITS , MISSES , WRITEBACKS;
+    reg [1:0] STATE;
+    reg [31:0] MISS_ADDR;                   // line being refilled
+    reg [31:0] WB_ADDR;                     // line being written back
+    reg [15:0] SLOT;                        // cache slot (set*WAYS + way) the FSM works on
+    reg MISS_FOR_LOAD;                      // refill was started by a load , not by a drain
+    reg WB_ONLY;                            // flush write-back , no refill after it
+    reg REPLAY;                             // next load hit on MISS_ADDR is the retried miss
+    reg [15:0] FLUSH_PTR;
+    integer w , e;
+
+    localparam MS_N = (MSHRS > 0) ? MSHRS : 1;
+    reg [MS_N-1:0] MS_VALID , MS_DONE;      // taken , word in MS_DATA
+    reg [31:0] MS_ADDR [0:MS_N-1];
+    reg [4:0] MS_TAG [0:MS_N-1];
+    reg [31:0] MS_DATA [0:MS_N-1];
+
+    // CPU LOOKUP
+    wire [OFF_BITS-1:0] C_OFF = addr[OFF_BITS-1:0];
+    wire [IDX_BITS-1:0] C_IDX = addr[OFF_BITS+IDX_BITS-1:OFF_BITS];
+    wire [TAG_BITS-1:0] C_TAG = addr[31:OFF_BITS+IDX_BITS];
+    reg C_HIT , SB_HIT , SB_FREE_OK;
+    reg [7:0] C_WAY , SB_IDX , SB_FREE;
+    always @* begin
+    C_HIT = 1'b0;
+    C_WAY = 0;
+    for (w = 0; w < WAYS; w = w + 1)
+    if (VALID[C_IDX*WAYS+w] && (TAG[C_IDX*WAYS+w] == C_TAG)) begin
+    C_HIT = 1'b1;
+    C_WAY = w;
+    end
+    SB_HIT = 1'b0;
+    SB_IDX = 0;
+    SB_FREE_OK = 1'b0;
+    SB_FREE = 0;
+    for (e = SB_ENTRIES-1; e >= 0; e = e - 1) begin
+    if (SB_VALID[e] && (SB_ADDR[e] == addr)) begin
+    SB_HIT = 1'b1;
+    SB_IDX = e;
+    end
+    if (!SB_VALID[e]) begin
+    SB_FREE_OK = 1'b1;
+    SB_FREE = e;
+    end
+    end
+    end
+
+    // MSHR FILE : a free entry , the first line still to refill and the
+    // first target to return
+    reg MS_FREE_OK , W_VALID , R_VALID;
+    reg [7:0] MS_FREE , W_IDX , R_IDX;
+    always @* begin
+    MS_FREE_OK = 1'b0;
+    MS_FREE = 0;
+    W_VALID = 1'b0;
+    W_IDX = 0;
+    R_VALID = 1'b0;
+    R_IDX = 0;
+    for (e = MS_N-1; e >= 0; e = e - 1) begin
+    if (!MS_VALID[e]) begin
+    MS_FREE_OK = 1'b1;
+    MS_FREE = e;
+    end
+    if (MS_VALID[e] && !MS_DONE[e]) begin
+    W_VALID = 1'b1;
+    W_IDX = e;
+    end
+    if (MS_VALID[e] && MS_DONE[e]) begin
+    R_VALID = 1'b1;
+    R_IDX = e;
+    end
+    end
+    pending = 0;
+    for (e = 0; e < MS_N; e = e + 1)
+    if (MS_VALID[e] && !(fill_ack && (e == R_IDX))) pending = pending | (32'b1 << MS_TAG[e]);
+    end
+
+    wire LOOKUP_HIT = SB_HIT || C_HIT;
+    assign miss = (MSHRS > 0) && load && !LOOKUP_HIT;
+    assign ready = load ? (LOOKUP_HIT || (miss && MS_FREE_OK)) : store ? (SB_HIT || SB_FREE_OK) : 1'b1;
+    assign rdata = SB_HIT ? SB_DATA[SB_IDX] : DATA[C_IDX*WAYS+C_WAY][C_OFF*32 +: 32];
+    assign fill_valid = (MSHRS > 0) && R_VALID;
+    assign fill_tag = MS_TAG[R_IDX];
+    assign fill_data = MS_DATA[R_IDX];
+
+    // STORE BUFFER DRAIN : lowest valid entry , looked up in the cache
+    reg D_VALID , D_HIT;
+    reg [7:0] D_IDX , D_WAY;
+    always @* begin
+    D_VALID = 1'b0;
+    D_IDX = 0;
+    for (e = SB_ENTRIES-1; e >= 0; e = e - 1)
+    if (SB_VALID[e]) begin
+    D_VALID = 1'b1;
+    D_IDX = e;
+    end
+    end
+    wire [31:0] D_ADDR = SB_ADDR[D_IDX];
+    wire [OFF_BITS-1:0] D_OFF = D_ADDR[OFF_BITS-1:0];
+    wire [IDX_BITS-1:0] D_SET = D_ADDR[OFF_BITS+IDX_BITS-1:OFF_BITS];
+    always @* begin
+    D_HIT = 1'b0;
+    D_WAY = 0;
+    for (w = 0; w < WAYS; w = w + 1)
+    if (VALID[D_SET*WAYS+w] && (TAG[D_SET*WAYS+w] == D_ADDR[31:OFF_BITS+IDX_BITS])) begin
+    D_HIT = 1'b1;
+    D_WAY = w;
+    end
+    end
+    // a store coalescing into the entry being drained holds the drain off a cycle
+    wire DRAIN = D_VALID && !(store && SB_HIT && (SB_IDX == D_IDX));
+
+    // MISS START : a load miss (or the first waiting MSHR line) first , else a
+    // drain that misses
+    wire LOAD_MISS = (MSHRS == 0) && load && !ready;
+    wire MS_MISS = (MSHRS > 0) && W_VALID;
+    wire [31:0] M_ADDR = LOAD_MISS ? addr : MS_MISS ? MS_ADDR[W_IDX] : D_ADDR;
+    wire [IDX_BITS-1:0] M_IDX = M_ADDR[OFF_BITS+IDX_BITS-1:OFF_BITS];
+    wire [15:0] M_SLOT = M_IDX*WAYS + VICTIM[M_IDX];
+    wire [IDX_BITS-1:0] MISS_IDX = MISS_ADDR[OFF_BITS+IDX_BITS-1:OFF_BITS];
+    wire [IDX_BITS-1:0] FLUSH_IDX = FLUSH_PTR / WAYS;
+
+    wire LOAD_HIT_CNT = load && ready && !miss && !(REPLAY && (addr[31:OFF_BITS] == MISS_ADDR[31:OFF_BITS]));
+    wire DRAIN_HIT_CNT = (STATE == S_IDLE) && !LOAD_MISS && !MS_MISS && DRAIN && D_HIT;
+    // the line the FSM is refilling , a new target for it joins the refill
+    wire FILLING = ((STATE == S_FILL) || ((STATE == S_WB) && !WB_ONLY)) &&
+                   (addr[31:OFF_BITS] == MISS_ADDR[31:OFF_BITS]);
+    wire FILL_END = (STATE == S_FILL) && mem_done;
+
+    assign mem_req = (STATE == S_WB) || (STATE == S_FILL);
+    assign mem_we = (STATE == S_WB);
+    assign mem_addr = (STATE == S_WB) ? WB_ADDR : {MISS_ADDR[31:OFF_BITS], {OFF_BITS{1'b0}}};
+    assign mem_wline = DATA[SLOT];
+    assign flushed = flush && (STATE == S_IDLE) && !D_VALID && (FLUSH_PTR == SETS*WAYS) && ((MSHRS == 0) || !MS_VALID);
+
+    always @(posedge clk or posedge reset)begin
+    if (reset) begin
+    VALID <= 0;
+    DIRTY <= 0;
+    SB_VALID <= 0;
+    STATE <= S_IDLE;
+    REPLAY <= 1'b0;
+    FLUSH_PTR <= 0;
+    MS_VALID <= 0;
+    MS_DONE <= 0;
+    HITS <= 0;
+    MISSES <= 0;
+    WRITEBACKS <= 0;
+    for (w = 0; w < SETS; w = w + 1) VICTIM[w] <= 0;
+    end
+    else begin
+    HITS <= HITS + LOAD_HIT_CNT + DRAIN_HIT_CNT;
+    if (load && ready && REPLAY && (addr[31:OFF_BITS] == MISS_ADDR[31:OFF_BITS])) REPLAY <= 1'b0;
+
+    if (store && ready) begin
+    if (SB_HIT) SB_DATA[SB_IDX] <= wdata;
+    else begin
+    SB_VALID[SB_FREE] <= 1'b1;
+    SB_ADDR[SB_FREE] <= addr;
+    SB_DATA[SB_FREE] <= wdata;
+    end
+    end
+
+    if (MSHRS > 0) begin
+    if (fill_ack) MS_VALID[R_IDX] <= 1'b0;
+    for (e = 0; e < MS_N; e = e + 1)
+    if (FILL_END && MS_VALID[e] && !MS_DONE[e] && (MS_ADDR[e][31:OFF_BITS] == MISS_ADDR[31:OFF_BITS])) begin
+    MS_DONE[e] <= 1'b1;
+    MS_DATA[e] <= mem_line[MS_ADDR[e][OFF_BITS-1:0]*32 +: 32];
+    end
+    if (miss && ready) begin
+    MS_VALID[MS_FREE] <= 1'b1;
+    MS_DONE[MS_FREE] <= FILL_END && FILLING;   // its line arrives on this very edge
+    MS_ADDR[MS_FREE] <= addr;
+    MS_TAG[MS_FREE] <= tag;
+    MS_DATA[MS_FREE] <= mem_line[C_OFF*32 +: 32];
+    end
+    end
+
+    case (STATE)
+    S_IDLE : if (LOAD_MISS || MS_MISS || (DRAIN && !D_HIT)) begin
+             MISSES <= MISSES + 1;
+             MISS_ADDR <= M_ADDR;
+             MISS_FOR_LOAD <= LOAD_MISS;
+             WB_ONLY <= 1'b0;
+             SLOT <= M_SLOT;
+             WB_ADDR <= {TAG[M_SLOT], M_IDX, {OFF_BITS{1'b0}}};
+             STATE <= (VALID[M_SLOT] && DIRTY[M_SLOT]) ? S_WB : S_FILL;
+             end
+             else if (DRAIN) begin
+             DATA[D_SET*WAYS+D_WAY][D_OFF*32 +: 32] <= SB_DATA[D_IDX];
+             DIRTY[D_SET*WAYS+D_WAY] <= 1'b1;
+             SB_VALID[D_IDX] <= 1'b0;
+             end
+             else if (flush && (FLUSH_PTR != SETS*WAYS)) begin
+             if (VALID[FLUSH_PTR] && DIRTY[FLUSH_PTR]) begin
+             WB_ONLY <= 1'b1;
+             SLOT <= FLUSH_PTR;
+             WB_ADDR <= {TAG[FLUSH_PTR], FLUSH_IDX, {OFF_BITS{1'b0}}};
+             STATE <= S_WB;
+             end
+             else FLUSH_PTR <= FLUSH_PTR + 1;
+             end
+    S_WB :   if (mem_done) begin
+             WRITEBACKS <= WRITEBACKS + 1;
+             if (WB_ONLY) begin
+             DIRTY[SLOT] <= 1'b0;
+             FLUSH_PTR <= FLUSH_PTR + 1;
+             STATE <= S_IDLE;
+             end
+             else STATE <= S_FILL;
+             end
+    S_FILL : if (mem_done) begin
+             VALID[SLOT] <= 1'b1;
+             DIRTY[SLOT] <= 1'b0;
+             TAG[SLOT] <= MISS_ADDR[31:OFF_BITS+IDX_BITS];
+             DATA[SLOT] <= mem_line;
+             VICTIM[MISS_IDX] <= (VICTIM[MISS_IDX] == WAYS-1) ? 0 : VICTIM[MISS_IDX] + 1;
+             REPLAY <= MISS_FOR_LOAD;
+             STATE <= S_IDLE;
+             end
+    default : STATE <= S_IDLE;
+    endcase
+    end
+    end
+
+endmodule
@@ -0,0 +1,102 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////////
+// Module Name: ICACHE
+// Description: Set-associative instruction cache in front of the MIPS fetch
+//              stage. SETS x WAYS lines of LINE_WORDS words (WAYS = 1 is direct
+//              mapped) , round-robin replacement per set. A miss starts the
+//              refill FSM , which requests the whole line from the backing
+//              memory and installs it when mem_done pulses ; the fetch stage
+//              retries until hit.
+// Dependencies: backing memory with a line port (IMEM in MIPS.v)
+//////////////////////////////////////////////////////////////////////////////////
+
+
+module ICACHE #(parameter SETS = 16 ,      // power of two >= 2
+    parameter WAYS = 2 ,
+    parameter LINE_WORDS = 4                // power of two >= 2
+    ) (
+    input clk , input reset ,
+
+    // fetch side
+    input req ,                             // fetch wants addr on this edge
+    input [31:0] addr ,                     // word address
+    output hit ,
+    output [31:0] rdata ,
+
+    // backing memory side , one line per request
+    output mem_req ,
+    output [31:0] mem_addr ,
+    input [32*LINE_WORDS-1:0] mem_line ,
+    input mem_done
+    );
+
+    localparam OFF_BITS = $clog2(LINE_WORDS) , IDX_BITS = $clog2(SETS) , TAG_BITS = 32 - OFF_BITS - IDX_BITS;
+
+    reg [SETS*WAYS-1:0] VALID;
+    reg [TAG_BITS-1:0] TAG [0:SETS*WAYS-1];
+    reg [32*LINE_WORDS-1:0] DATA [0:SETS*WAYS-1];
+    reg [7:0] VICTIM [0:SETS-1];            // next way to replace in each set
+
+    reg [31:0] HITS , MISSES;
+    reg FILL;                               // refill in flight for FILL_ADDR
+    reg REPLAY;                             // next hit on FILL_ADDR is the retried miss , not counted
+    reg [31:0] FILL_ADDR;
+    integer w;
+
+    wire [OFF_BITS-1:0] OFF = addr[OFF_BITS-1:0];
+    wire [IDX_BITS-1:0] IDX = addr[OFF_BITS+IDX_BITS-1:OFF_BITS];
+    wire [TAG_BITS-1:0] ATAG = addr[31:OFF_BITS+IDX_BITS];
+    wire [IDX_BITS-1:0] FILL_IDX = FILL_ADDR[OFF_BITS+IDX_BITS-1:OFF_BITS];
+
+    reg HIT_R;
+    reg [7:0] HIT_WAY;
+    always @* begin
+    HIT_R = 1'b0;
+    HIT_WAY = 0;
+    for (w = 0; w < WAYS; w = w + 1)
+    if (VALID[IDX*WAYS+w] && (TAG[IDX*WAYS+w] == ATAG)) begin
+    HIT_R = 1'b1;
+    HIT_WAY = w;
+    end
+    end
+
+    assign hit = HIT_R;
+    assign rdata = DATA[IDX*WAYS+HIT_WAY][OFF*32 +: 32];
+    assign mem_req = FILL;
+    assign mem_addr = {FILL_ADDR[31:OFF_BITS], {OFF_BITS{1'b0}}};
+
+    // REFILL FSM
+    always @(posedge clk or posedge reset)begin
+    if (reset) begin
+    VALID <= 0;
+    FILL <= 1'b0;
+    REPLAY <= 1'b0;
+    HITS <= 0;
+    MISSES <= 0;
+    for (w = 0; w < SETS; w = w + 1) VICTIM[w] <= 0;
+    end
+    else if (FILL) begin
+    if (mem_done) begin
+    VALID[FILL_IDX*WAYS+VICTIM[FILL_IDX]] <= 1'b1;
+    TAG[FILL_IDX*WAYS+VICTIM[FILL_IDX]] <= FILL_ADDR[31:OFF_BITS+IDX_BITS];
+    DATA[FILL_IDX*WAYS+VICTIM[FILL_IDX]] <= mem_line;
+    VICTIM[FILL_IDX] <= (VICTIM[FILL_IDX] == WAYS-1) ? 0 : VICTIM[FILL_IDX] + 1;
+    FILL <= 1'b0;
+    REPLAY <= 1'b1;
+    end
+    end
+    else if (req) begin
+    if (hit) begin
+    if (REPLAY && (addr[31:OFF_BITS] == FILL_ADDR[31:OFF_BITS])) REPLAY <= 1'b0;
+    else HITS <= HITS + 1;
+    end
+    else begin
+    MISSES <= MISSES + 1;
+    FILL <= 1'b1;
+    FILL_ADDR <= addr;
+    REPLAY <= 1'b0;
+    end
+    end
+    end
+
+endmodule
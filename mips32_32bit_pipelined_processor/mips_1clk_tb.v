@@ -0,0 +1,135 @@
+`timescale 1ns / 1ps
+// Shared regression for the two pipelines : one program using every opcode ,
+// with forwarding , a load-use pair , taken / untaken branches , a counted loop
+// and instructions after HLT , is run on the two-phase MIPS and on MIPS_1clk.
+// It sets STATUS.IE , traps on a reserved instruction (the handler moves EPC
+// past it) and raises each core's irq from its own R22 during a LOOP.
+// Both must end with the same 32 registers and data memory , the expected
+// values , two traps and the interrupt's CAUSE and EPC ; the report gives the
+// cycles of each (one clk1 period against one clk period).
+
+module test_mips32_1clk;
+
+  reg clk1, clk2, clk, reset;
+  integer k;
+  integer cyc_2ph, cyc_1clk;
+
+  `define TB_CORE0 two
+  `define TB_CORE1 one
+  `define TB_CORE_NAMES "two-phase , single clock"
+  `include "mips_tb_common.vh"
+
+  // each core is interrupted once it has written R22 = 1
+  wire irq_two = two.Reg[22] === 1;
+  wire irq_one = one.Reg[22] === 1;
+
+  MIPS      two  (`MIPS_TB_PORTS(irq_two));
+  MIPS_1clk one  (clk, reset, irq_one);
+
+  initial two_phase_clock(300);
+
+  initial begin
+    clk = 0;
+    repeat (600) #5 clk = ~clk;
+  end
+
+  initial begin
+    reset = 1;
+    start_program;
+    for (k = 0; k < 256; k = k + 1) data(k, 0);
+
+    put(ri(ADDI,  1, 0, 5));       // 0        R1 = 5
+    put(ri(ADDI,  2, 0, 3));       // 1        R2 = 3
+    put(rr(ADD,   3, 1, 2));       // 2        R3 = 8
+    put(rr(SUB,   4, 1, 2));       // 3        R4 = 2
+    put(rr(AND,   5, 1, 2));       // 4        R5 = 1
+    put(rr(OR,    6, 1, 2));       // 5        R6 = 7
+    put(rr(SLT,   7, 2, 1));       // 6        R7 = 1
+    put(rr(MUL,   8, 1, 2));       // 7        R8 = 15
+    put(ri(SLTI,  9, 1, 4));       // 8        R9 = 0
+    put(ri(SUBI, 10, 8, 1));       // 9        R10 = 14
+    put(ri(SW,    8, 1, 50));      // 10       Mem[55] = 15
+    put(ri(LW,   11, 1, 50));      // 11       R11 = 15
+    put(rr(ADD,  12, 11, 11));     // 12       R12 = 30          load-use
+    put(ri(BEQZ,  0, 9, 16'd1));   // 13       BEQZ R9 , +1      taken
+    put(ri(ADDI, 13, 0, 99));      // 14       skipped
+    put(ri(BNEQZ, 0, 9, 16'd1));   // 15       BNEQZ R9 , +1     not taken
+    put(ri(ADDI, 14, 0, 7));       // 16       R14 = 7
+    put(rr(ADD,  15, 15, 14));     // 17 loop: R15 = R15 + R14
+    put(ri(SUBI, 14, 14, 1));      // 18       R14 = R14 - 1
+    put(ri(BNEQZ, 0, 14, -16'd3)); // 19       BNEQZ R14 , loop
+    put(ri(SW,   15, 0, 60));      // 20       Mem[60] = 28
+    put(ri(LW,   16, 0, 60));      // 21       R16 = 28
+    put(ri(BEQZ,  0, 16, 16'd1));  // 22       BEQZ R16 , +1     not taken , load-fed
+    put(ri(ADDI, 18, 0, 1));       // 23       R18 = 1
+    put(ri(SW,   18, 0, STATUS));  // 24       STATUS = IE
+    put({6'b101010, 26'd0});       // 25       reserved , traps with EPC = 25
+    put(ri(ADDI, 19, 0, 12));      // 26       R19 = 12
+    put(ri(ADDI, 22, 0, 1));       // 27       R22 = 1 , raises irq
+    put(ri(LOOP,  0, 19, 16'd1));  // 28       LOOP R19 , e      12 times
+    put(ri(ADDI, 24, 24, 2));      // 29       R24 += 2          interrupted in here
+    put(rr(ADD,  26, 26, 24));     // 30 e:    R26 += R24        R24 = 24 , R26 = 156
+    put(rr(HLT,   0, 0, 0));       // 31
+    put(ri(ADDI, 17, 0, 1));       // 32       behind HLT , never retires
+    put(ri(SW,   17, 0, 61));      // 33       behind HLT , never stored
+
+    n = 256;                       // EXC_VECTOR
+    put(ri(LW,   20, 0, CAUSE));   // 256      R20 = CAUSE
+    put(ri(BEQZ,  0, 20, 16'd5));  // 257      BEQZ R20 , int
+    put(ri(LW,   21, 0, EPC));     // 258      R21 = EPC = 25
+    put(ri(ADDI, 21, 21, 1));      // 259      past the reserved instruction
+    put(ri(ADDI, 25, 25, 1));      // 260      R25 = 1
+    put(ri(SW,   21, 0, EPC));     // 261      EPC = 26 , read by the ERET right behind
+    put(rr(ERET,  0, 0, 0));       // 262
+    put(ri(ADDI, 23, 23, 1));      // 263 int: R23 = 1
+    put(rr(ERET,  0, 0, 0));       // 264
+
+    #22 reset = 0;   // after the first clk1 , clk2 and clk edges
+  end
+
+  initial begin cyc_2ph = 0; cyc_1clk = 0; end
+  always @(posedge clk1) if (two.HALTED == 0) cyc_2ph = cyc_2ph + 1;
+  always @(posedge clk)  if (one.HALTED == 0) cyc_1clk = cyc_1clk + 1;
+
+  initial begin
+    wait (all_halted);
+    #1;
+    check(1, 5);   check(2, 3);   check(3, 8);   check(4, 2);
+    check(5, 1);   check(6, 7);   check(7, 1);   check(8, 15);
+    check(9, 0);   check(10, 14); check(11, 15); check(12, 30);
+    check(13, 0);  check(14, 0);  check(15, 28); check(16, 28);
+    check(17, 0);  check(18, 1);  check(19, 12); check(20, 0);
+    check(21, 26); check(22, 1);  check(23, 1);  check(24, 24); check(25, 1);
+    check(26, 156);
+    if (two.TRAPS != 2 || one.TRAPS != 2 || two.CAUSE != 0 || one.CAUSE != 0 ||
+        {two.STATUS_EXL, two.STATUS_IE} != 2'b01 || {one.STATUS_EXL, one.STATUS_IE} != 2'b01 ||
+        two.EPC < 29 || two.EPC > 31 || one.EPC < 29 || one.EPC > 31 || two.LOOP_COUNT != 0 || one.LOOP_COUNT != 0) begin
+      $display("FAIL traps : TRAPS %0d / %0d , CAUSE %0d / %0d , STATUS %b%b / %b%b , EPC %0d / %0d , LOOP_COUNT %0d / %0d (two-phase / single clock)",
+               two.TRAPS, one.TRAPS, two.CAUSE, one.CAUSE, two.STATUS_EXL, two.STATUS_IE, one.STATUS_EXL, one.STATUS_IE,
+               two.EPC, one.EPC, two.LOOP_COUNT, one.LOOP_COUNT);
+      errors = errors + 1;
+    end
+    for (k = 0; k < 32; k = k + 1)
+      if (two.Reg[k] !== one.Reg[k]) begin
+        $display("FAIL R%0d differs : two-phase %0d , single clock %0d", k, two.Reg[k], one.Reg[k]);
+        errors = errors + 1;
+      end
+    for (k = 0; k < 256; k = k + 1)
+      if (two.dmem.Mem[k] !== one.dmem.Mem[k]) begin
+        $display("FAIL Mem[%0d] differs : two-phase %0d , single clock %0d", k, two.dmem.Mem[k], one.dmem.Mem[k]);
+        errors = errors + 1;
+      end
+    if (one.dmem.Mem[55] !== 15 || one.dmem.Mem[60] !== 28 || one.dmem.Mem[61] !== 0) begin
+      $display("FAIL memory : Mem[55] %0d , Mem[60] %0d , Mem[61] %0d", one.dmem.Mem[55], one.dmem.Mem[60], one.dmem.Mem[61]);
+      errors = errors + 1;
+    end
+
+    $display("two-phase    : %0d clk1 periods", cyc_2ph);
+    $display("single clock : %0d clk periods , %0d load-use stalls , %0d branch flushes , interrupt EPC %0d / %0d",
+             cyc_1clk, one.STALL_CYCLES, one.BRANCH_FLUSHES, two.EPC, one.EPC);
+    pass_fail;
+  end
+
+  initial watchdog(6000);
+
+endmodule
@@ -0,0 +1,211 @@
+`timescale 1ns / 1ps
+// AXI regression : three store loops fill arrays at 100 , 228 and 356 (the
+// same sets of a 2-way D-cache , so dirty lines are written back) and a load
+// loop sums two of them back. It runs through the D-cache over the internal
+// DMEM , through the D-cache on the AXI4 port (DMEM_AXI) to an AXI_RAM , and
+// on the AXI4 port sharing the AXI_RAM with dma_controller (../dma) through
+// AXI_ARBITER while the DMA copies three words elsewhere. After MEM_SYNCED
+// both AXI_RAMs must match DMEM , every refill must be one AR burst and every
+// write-back one AW burst ; the report gives the cycles alone and shared.
+
+module test_mips32_axi;
+
+  reg clk1, clk2, reset, trigger;
+  integer k;
+  integer cyc_base, cyc_alone, cyc_shared, ar_alone, aw_alone;
+
+  `define TB_CORE0 base
+  `define TB_CORE1 alone
+  `define TB_CORE2 shared
+  `define TB_CORE_NAMES "DMEM , AXI , shared AXI"
+  `include "mips_tb_common.vh"
+
+  // alone : MIPS -> AXI_RAM
+  wire [31:0] a_ARADDR, a_RDATA, a_AWADDR, a_WDATA;
+  wire [7:0] a_ARLEN, a_AWLEN;
+  wire [2:0] a_ARSIZE, a_AWSIZE;
+  wire [1:0] a_ARBURST, a_RRESP, a_AWBURST, a_BRESP;
+  wire [3:0] a_WSTRB;
+  wire a_ARVALID, a_ARREADY, a_RLAST, a_RVALID, a_RREADY, a_AWVALID, a_AWREADY, a_WLAST, a_WVALID, a_WREADY,
+       a_BVALID, a_BREADY;
+
+  // shared : MIPS (master 0) and dma_controller (master 1) -> AXI_ARBITER -> AXI_RAM
+  wire [31:0] c_ARADDR, c_RDATA, c_AWADDR, c_WDATA;
+  wire [7:0] c_ARLEN, c_AWLEN;
+  wire [2:0] c_ARSIZE, c_AWSIZE;
+  wire [1:0] c_ARBURST, c_RRESP, c_AWBURST, c_BRESP;
+  wire [3:0] c_WSTRB;
+  wire c_ARVALID, c_ARREADY, c_RLAST, c_RVALID, c_RREADY, c_AWVALID, c_AWREADY, c_WLAST, c_WVALID, c_WREADY,
+       c_BVALID, c_BREADY;
+  wire [31:0] d_ARADDR, d_RDATA, d_AWADDR, d_WDATA;
+  wire [1:0] d_BRESP;
+  wire d_ARVALID, d_ARREADY, d_RVALID, d_RREADY, d_AWVALID, d_AWREADY, d_WVALID, d_WREADY, d_BVALID, d_BREADY;
+  wire dma_done;
+  wire [31:0] m_ARADDR, m_RDATA, m_AWADDR, m_WDATA;
+  wire [7:0] m_ARLEN, m_AWLEN;
+  wire [2:0] m_ARSIZE, m_AWSIZE;
+  wire [1:0] m_ARBURST, m_RRESP, m_AWBURST, m_BRESP;
+  wire [3:0] m_WSTRB;
+  wire m_ARVALID, m_ARREADY, m_RLAST, m_RVALID, m_RREADY, m_AWVALID, m_AWREADY, m_WLAST, m_WVALID, m_WREADY,
+       m_BVALID, m_BREADY;
+  wire [31:0] RGRANTS0, RGRANTS1, WGRANTS0, WGRANTS1;
+
+  MIPS #(.DCACHE(1), .DMEM_LATENCY(8)) base (`MIPS_TB_PORTS(1'b0));
+
+  MIPS #(.DCACHE(1), .DMEM_AXI(1)) alone (.clk1(clk1), .clk2(clk2), .reset(reset), .irq(1'b0),
+    .M_AXI_ARADDR(a_ARADDR), .M_AXI_ARLEN(a_ARLEN), .M_AXI_ARSIZE(a_ARSIZE), .M_AXI_ARBURST(a_ARBURST),
+    .M_AXI_ARVALID(a_ARVALID), .M_AXI_ARREADY(a_ARREADY), .M_AXI_RDATA(a_RDATA), .M_AXI_RRESP(a_RRESP),
+    .M_AXI_RLAST(a_RLAST), .M_AXI_RVALID(a_RVALID), .M_AXI_RREADY(a_RREADY),
+    .M_AXI_AWADDR(a_AWADDR), .M_AXI_AWLEN(a_AWLEN), .M_AXI_AWSIZE(a_AWSIZE), .M_AXI_AWBURST(a_AWBURST),
+    .M_AXI_AWVALID(a_AWVALID), .M_AXI_AWREADY(a_AWREADY), .M_AXI_WDATA(a_WDATA), .M_AXI_WSTRB(a_WSTRB),
+    .M_AXI_WLAST(a_WLAST), .M_AXI_WVALID(a_WVALID), .M_AXI_WREADY(a_WREADY),
+    .M_AXI_BRESP(a_BRESP), .M_AXI_BVALID(a_BVALID), .M_AXI_BREADY(a_BREADY));
+
+  AXI_RAM #(.LATENCY(8)) ram (.clk(clk2), .reset(reset),
+    .ARADDR(a_ARADDR), .ARLEN(a_ARLEN), .ARSIZE(a_ARSIZE), .ARBURST(a_ARBURST), .ARVALID(a_ARVALID),
+    .ARREADY(a_ARREADY), .RDATA(a_RDATA), .RRESP(a_RRESP), .RLAST(a_RLAST), .RVALID(a_RVALID), .RREADY(a_RREADY),
+    .AWADDR(a_AWADDR), .AWLEN(a_AWLEN), .AWSIZE(a_AWSIZE), .AWBURST(a_AWBURST), .AWVALID(a_AWVALID),
+    .AWREADY(a_AWREADY), .WDATA(a_WDATA), .WSTRB(a_WSTRB), .WLAST(a_WLAST), .WVALID(a_WVALID), .WREADY(a_WREADY),
+    .BRESP(a_BRESP), .BVALID(a_BVALID), .BREADY(a_BREADY));
+
+  MIPS #(.DCACHE(1), .DMEM_AXI(1)) shared (.clk1(clk1), .clk2(clk2), .reset(reset), .irq(1'b0),
+    .M_AXI_ARADDR(c_ARADDR), .M_AXI_ARLEN(c_ARLEN), .M_AXI_ARSIZE(c_ARSIZE), .M_AXI_ARBURST(c_ARBURST),
+    .M_AXI_ARVALID(c_ARVALID), .M_AXI_ARREADY(c_ARREADY), .M_AXI_RDATA(c_RDATA), .M_AXI_RRESP(c_RRESP),
+    .M_AXI_RLAST(c_RLAST), .M_AXI_RVALID(c_RVALID), .M_AXI_RREADY(c_RREADY),
+    .M_AXI_AWADDR(c_AWADDR), .M_AXI_AWLEN(c_AWLEN), .M_AXI_AWSIZE(c_AWSIZE), .M_AXI_AWBURST(c_AWBURST),
+    .M_AXI_AWVALID(c_AWVALID), .M_AXI_AWREADY(c_AWREADY), .M_AXI_WDATA(c_WDATA), .M_AXI_WSTRB(c_WSTRB),
+    .M_AXI_WLAST(c_WLAST), .M_AXI_WVALID(c_WVALID), .M_AXI_WREADY(c_WREADY),
+    .M_AXI_BRESP(c_BRESP), .M_AXI_BVALID(c_BVALID), .M_AXI_BREADY(c_BREADY));
+
+  // single-beat master with byte addresses : length 8 is three words
+  dma_controller dma (.clk(clk2), .reset(reset), .trigger(trigger), .length(5'd8),
+    .source_address(32'd2800), .destination_address(32'd3200), .done(dma_done),
+    .ARADDR(d_ARADDR), .ARVALID(d_ARVALID), .ARREADY(d_ARREADY), .RDATA(d_RDATA), .RVALID(d_RVALID),
+    .RREADY(d_RREADY), .AWADDR(d_AWADDR), .AWVALID(d_AWVALID), .AWREADY(d_AWREADY), .WDATA(d_WDATA),
+    .WVALID(d_WVALID), .WREADY(d_WREADY), .BVALID(d_BVALID), .BREADY(d_BREADY), .BRESP(d_BRESP));
+
+  AXI_ARBITER arb (.clk(clk2), .reset(reset),
+    .S0_ARADDR(c_ARADDR), .S0_ARLEN(c_ARLEN), .S0_ARSIZE(c_ARSIZE), .S0_ARBURST(c_ARBURST), .S0_ARVALID(c_ARVALID),
+    .S0_ARREADY(c_ARREADY), .S0_RDATA(c_RDATA), .S0_RRESP(c_RRESP), .S0_RLAST(c_RLAST), .S0_RVALID(c_RVALID),
+    .S0_RREADY(c_RREADY), .S0_AWADDR(c_AWADDR), .S0_AWLEN(c_AWLEN), .S0_AWSIZE(c_AWSIZE), .S0_AWBURST(c_AWBURST),
+    .S0_AWVALID(c_AWVALID), .S0_AWREADY(c_AWREADY), .S0_WDATA(c_WDATA), .S0_WSTRB(c_WSTRB), .S0_WLAST(c_WLAST),
+    .S0_WVALID(c_WVALID), .S0_WREADY(c_WREADY), .S0_BRESP(c_BRESP), .S0_BVALID(c_BVALID), .S0_BREADY(c_BREADY),
+    .S1_ARADDR(d_ARADDR), .S1_ARLEN(8'd0), .S1_ARSIZE(3'b010), .S1_ARBURST(2'b01), .S1_ARVALID(d_ARVALID),
+    .S1_ARREADY(d_ARREADY), .S1_RDATA(d_RDATA), .S1_RRESP(), .S1_RLAST(), .S1_RVALID(d_RVALID),
+    .S1_RREADY(d_RREADY), .S1_AWADDR(d_AWADDR), .S1_AWLEN(8'd0), .S1_AWSIZE(3'b010), .S1_AWBURST(2'b01),
+    .S1_AWVALID(d_AWVALID), .S1_AWREADY(d_AWREADY), .S1_WDATA(d_WDATA), .S1_WSTRB(4'b1111), .S1_WLAST(1'b1),
+    .S1_WVALID(d_WVALID), .S1_WREADY(d_WREADY), .S1_BRESP(d_BRESP), .S1_BVALID(d_BVALID), .S1_BREADY(d_BREADY),
+    .M_ARADDR(m_ARADDR), .M_ARLEN(m_ARLEN), .M_ARSIZE(m_ARSIZE), .M_ARBURST(m_ARBURST), .M_ARVALID(m_ARVALID),
+    .M_ARREADY(m_ARREADY), .M_RDATA(m_RDATA), .M_RRESP(m_RRESP), .M_RLAST(m_RLAST), .M_RVALID(m_RVALID),
+    .M_RREADY(m_RREADY), .M_AWADDR(m_AWADDR), .M_AWLEN(m_AWLEN), .M_AWSIZE(m_AWSIZE), .M_AWBURST(m_AWBURST),
+    .M_AWVALID(m_AWVALID), .M_AWREADY(m_AWREADY), .M_WDATA(m_WDATA), .M_WSTRB(m_WSTRB), .M_WLAST(m_WLAST),
+    .M_WVALID(m_WVALID), .M_WREADY(m_WREADY), .M_BRESP(m_BRESP), .M_BVALID(m_BVALID), .M_BREADY(m_BREADY),
+    .RGRANTS0(RGRANTS0), .RGRANTS1(RGRANTS1), .WGRANTS0(WGRANTS0), .WGRANTS1(WGRANTS1));
+
+  AXI_RAM #(.LATENCY(8)) sram (.clk(clk2), .reset(reset),
+    .ARADDR(m_ARADDR), .ARLEN(m_ARLEN), .ARSIZE(m_ARSIZE), .ARBURST(m_ARBURST), .ARVALID(m_ARVALID),
+    .ARREADY(m_ARREADY), .RDATA(m_RDATA), .RRESP(m_RRESP), .RLAST(m_RLAST), .RVALID(m_RVALID), .RREADY(m_RREADY),
+    .AWADDR(m_AWADDR), .AWLEN(m_AWLEN), .AWSIZE(m_AWSIZE), .AWBURST(m_AWBURST), .AWVALID(m_AWVALID),
+    .AWREADY(m_AWREADY), .WDATA(m_WDATA), .WSTRB(m_WSTRB), .WLAST(m_WLAST), .WVALID(m_WVALID), .WREADY(m_WREADY),
+    .BRESP(m_BRESP), .BVALID(m_BVALID), .BREADY(m_BREADY));
+
+  // both AXI_RAMs hold what DMEM holds at word a
+  task check_ram;
+    input [31:0] a;
+    begin
+      if (ram.Mem[a] !== base.dmem.Mem[a] || sram.Mem[a] !== base.dmem.Mem[a]) begin
+        $display("FAIL Mem[%0d] : DMEM %0d , AXI %0d , shared AXI %0d", a, base.dmem.Mem[a], ram.Mem[a], sram.Mem[a]);
+        errors = errors + 1;
+      end
+    end
+  endtask
+
+  initial two_phase_clock(6000);
+
+  initial begin
+    reset = 1; trigger = 0;
+    start_program;
+    for (k = 0; k < 1024; k = k + 1) begin
+      data(k, 0); ram.Mem[k] = 0; sram.Mem[k] = 0;
+    end
+    for (k = 0; k < 3; k = k + 1) sram.Mem[700 + k] = 70 + k;   // DMA source , byte address 2800
+
+    put(ri(ADDI,  1, 0, 16));      // 0        R1 = 16           count
+    put(ri(ADDI,  2, 0, 0));       // 1        R2 = 0            index
+    put(ri(SW,    2, 2, 100));     // 2 fill:  Mem[100+R2] = R2
+    put(rr(ADD,   3, 2, 2));       // 3        R3 = 2 * R2
+    put(ri(SW,    3, 2, 228));     // 4        Mem[228+R2] = R3
+    put(rr(ADD,   4, 3, 2));       // 5        R4 = 3 * R2
+    put(ri(SW,    4, 2, 356));     // 6        Mem[356+R2] = R4  evicts a dirty line
+    put(ri(ADDI,  2, 2, 1));       // 7        R2 = R2 + 1
+    put(ri(SUBI,  1, 1, 1));       // 8        R1 = R1 - 1
+    put(ri(BNEQZ, 0, 1, -16'd8));  // 9        BNEQZ R1 , fill
+    put(ri(ADDI,  1, 0, 16));      // 10       R1 = 16
+    put(ri(ADDI,  5, 0, 0));       // 11       R5 = 0            sum
+    put(ri(ADDI,  2, 0, 0));       // 12       R2 = 0
+    put(ri(LW,    6, 2, 100));     // 13 sum:  R6 = Mem[100+R2]  refilled after the write-back
+    put(rr(ADD,   5, 5, 6));       // 14       R5 = R5 + R6
+    put(ri(LW,    7, 2, 356));     // 15       R7 = Mem[356+R2]
+    put(rr(ADD,   5, 5, 7));       // 16       R5 = R5 + R7
+    put(ri(ADDI,  2, 2, 1));       // 17       R2 = R2 + 1
+    put(ri(SUBI,  1, 1, 1));       // 18       R1 = R1 - 1
+    put(ri(BNEQZ, 0, 1, -16'd7));  // 19       BNEQZ R1 , sum
+    put(ri(SW,    5, 0, 500));     // 20       Mem[500] = R5
+    put(rr(HLT,   0, 0, 0));       // 21
+
+    #22 reset = 0;   // after the first clk1 and clk2 edges
+    #20 trigger = 1;  // over one clk2 edge
+    #20 trigger = 0;
+  end
+
+  initial begin cyc_base = 0; cyc_alone = 0; cyc_shared = 0; ar_alone = 0; aw_alone = 0; end
+  always @(posedge clk1) begin
+    if (base.HALTED == 0) cyc_base = cyc_base + 1;
+    if (alone.HALTED == 0) cyc_alone = cyc_alone + 1;
+    if (shared.HALTED == 0) cyc_shared = cyc_shared + 1;
+  end
+  always @(posedge clk2) begin
+    if (a_ARVALID && a_ARREADY) ar_alone = ar_alone + 1;
+    if (a_AWVALID && a_AWREADY) aw_alone = aw_alone + 1;
+  end
+
+  initial begin
+    wait (all_halted && base.MEM_SYNCED === 1 && alone.MEM_SYNCED === 1 && shared.MEM_SYNCED === 1 && dma_done === 1);
+    #1;
+    check(5, 480); check(1, 0); check(2, 16);
+    for (k = 0; k < 600; k = k + 1) check_ram(k);
+    if (base.dmem.Mem[500] !== 480 || base.dmem.Mem[115] !== 15 || base.dmem.Mem[243] !== 30 ||
+        base.dmem.Mem[371] !== 45) begin
+      $display("FAIL : DMEM Mem[500] %0d , Mem[115] %0d , Mem[243] %0d , Mem[371] %0d", base.dmem.Mem[500],
+               base.dmem.Mem[115], base.dmem.Mem[243], base.dmem.Mem[371]);
+      errors = errors + 1;
+    end
+    if (ar_alone != alone.dcache.MISSES || aw_alone != alone.dcache.WRITEBACKS || alone.dcache.WRITEBACKS == 0 ||
+        RGRANTS0 != shared.dcache.MISSES || WGRANTS0 != shared.dcache.WRITEBACKS) begin
+      $display("FAIL bursts : AXI %0d AR / %0d misses , %0d AW / %0d write-backs ; shared %0d / %0d , %0d / %0d",
+               ar_alone, alone.dcache.MISSES, aw_alone, alone.dcache.WRITEBACKS, RGRANTS0, shared.dcache.MISSES,
+               WGRANTS0, shared.dcache.WRITEBACKS);
+      errors = errors + 1;
+    end
+    if (RGRANTS1 != 3 || WGRANTS1 != 3 || alone.axi.ERRORS != 0 || shared.axi.ERRORS != 0) begin
+      $display("FAIL : DMA %0d reads , %0d writes , AXI errors %0d %0d", RGRANTS1, WGRANTS1,
+               alone.axi.ERRORS, shared.axi.ERRORS);
+      errors = errors + 1;
+    end
+
+    $display("DMEM          : %0d cycles , %0d misses , %0d write-backs , %0d MEM stall cycles",
+             cyc_base, base.dcache.MISSES, base.dcache.WRITEBACKS, base.MEM_STALLS);
+    $display("AXI alone     : %0d cycles , %0d AR bursts , %0d AW bursts , %0d MEM stall cycles",
+             cyc_alone, ar_alone, aw_alone, alone.MEM_STALLS);
+    $display("AXI with DMA  : %0d cycles , %0d MEM stall cycles , DMA %0d reads / %0d writes",
+             cyc_shared, shared.MEM_STALLS, RGRANTS1, WGRANTS1);
+    pass_fail;
+  end
+
+  initial begin
+    #120000 $display("FAIL : timeout , HALTED %b %b %b , MEM_SYNCED %b %b %b , DMA done %b", base.HALTED, alone.HALTED,
+                     shared.HALTED, base.MEM_SYNCED, alone.MEM_SYNCED, shared.MEM_SYNCED, dma_done);
+    $finish;
+  end
+
+endmodule
@@ -0,0 +1,77 @@
+`timescale 1ns / 1ps
+// Branch regression : a nested counted loop followed by a load-fed branch is
+// run on a core with the BTB / 2-bit counter predictor , on one without it and
+// on one resolving branches in ID (EARLY_BRANCH). All must produce the same
+// state ; the report gives cycles for each and the prediction hit rate.
+
+module test_mips32_bpred;
+
+  reg clk1, clk2, reset;
+  integer cyc_bp, cyc_nobp, cyc_early;
+
+  `define TB_CORE0 bp
+  `define TB_CORE1 nobp
+  `define TB_CORE2 early
+  `define TB_CORE_NAMES "predicted , unpredicted , early"
+  `include "mips_tb_common.vh"
+
+  MIPS #(.BPRED(1)) bp   (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.BPRED(0)) nobp (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.BPRED(0), .EARLY_BRANCH(1)) early (`MIPS_TB_PORTS(1'b0));
+
+  initial two_phase_clock(400);
+
+  initial begin
+    reset = 1;
+    start_program;
+
+    put(ri(ADDI,  3, 0, 5));       // 0        R3 = 5            outer count
+    put(ri(ADDI,  2, 0, 0));       // 1        R2 = 0            sum
+    put(ri(ADDI,  1, 0, 10));      // 2 outer: R1 = 10           inner count
+    put(rr(ADD,   2, 2, 1));       // 3 inner: R2 = R2 + R1
+    put(ri(SUBI,  1, 1, 1));       // 4        R1 = R1 - 1
+    put(ri(BNEQZ, 0, 1, -16'd3));  // 5        BNEQZ R1 , inner
+    put(ri(SUBI,  3, 3, 1));       // 6        R3 = R3 - 1
+    put(ri(BNEQZ, 0, 3, -16'd6));  // 7        BNEQZ R3 , outer
+    put(ri(SW,    2, 0, 200));     // 8        Mem[200] = R2
+    put(ri(LW,    4, 0, 200));     // 9        R4 = Mem[200]
+    put(ri(BNEQZ, 0, 4, 16'd1));   // 10       BNEQZ R4 , skip   (load-use into a branch)
+    put(ri(ADDI,  6, 0, 99));      // 11       R6 = 99           never executed
+    put(rr(HLT,   0, 0, 0));       // 12 skip:
+
+    #22 reset = 0;   // after the first clk1 and clk2 edges
+  end
+
+  initial begin cyc_bp = 0; cyc_nobp = 0; cyc_early = 0; end
+  always @(posedge clk1) begin
+    if (bp.HALTED == 0) cyc_bp = cyc_bp + 1;
+    if (nobp.HALTED == 0) cyc_nobp = cyc_nobp + 1;
+    if (early.HALTED == 0) cyc_early = cyc_early + 1;
+  end
+
+  initial begin
+    wait (all_halted);
+    #1;
+    check(2, 275); check(4, 275); check(6, 0);
+    if (bp.dmem.Mem[200] !== 275 || nobp.dmem.Mem[200] !== 275 || early.dmem.Mem[200] !== 275) begin
+      $display("FAIL Mem[200] : predicted %0d , unpredicted %0d , early %0d , expected 275",
+               bp.dmem.Mem[200], nobp.dmem.Mem[200], early.dmem.Mem[200]);
+      errors = errors + 1;
+    end
+    if (bp.BP_BRANCHES != 56 || early.BP_BRANCHES != 56) begin
+      $display("FAIL : %0d / %0d branches resolved , expected 56", bp.BP_BRANCHES, early.BP_BRANCHES);
+      errors = errors + 1;
+    end
+
+    $display("with predictor    : %0d cycles , %0d / %0d branches predicted (%0.1f%%)",
+             cyc_bp, bp.BP_HITS, bp.BP_BRANCHES, bp.BP_HITS * 100.0 / bp.BP_BRANCHES);
+    $display("without predictor : %0d cycles , %0d / %0d branches predicted (%0.1f%%)",
+             cyc_nobp, nobp.BP_HITS, nobp.BP_BRANCHES, nobp.BP_HITS * 100.0 / nobp.BP_BRANCHES);
+    $display("early resolution  : %0d cycles , %0d stall cycles , %0d / %0d fetch redirects",
+             cyc_early, early.STALL_CYCLES, early.BP_BRANCHES - early.BP_HITS, early.BP_BRANCHES);
+    pass_fail;
+  end
+
+  initial watchdog(8000);
+
+endmodule
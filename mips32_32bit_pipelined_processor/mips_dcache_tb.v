@@ -0,0 +1,91 @@
+`timescale 1ns / 1ps
+// Data cache regression : two store loops fill arrays at 100 and 200 , a load
+// loop sums them back and the result is stored and reloaded. It runs with
+// ideal DMEM , through a 2-way 16-set D-cache over an 8-cycle DMEM , and
+// through a tiny direct-mapped cache where the two arrays evict each other
+// (dirty write-backs) with a 2-entry store buffer. After HALTED the caches are
+// flushed (MEM_SYNCED) and DMEM must match ; the report gives cycles , hit /
+// miss / write-back counts and MEM stall cycles.
+
+module test_mips32_dcache;
+
+  reg clk1, clk2, reset;
+  integer k;
+  integer cyc_ideal, cyc_dc, cyc_dm;
+
+  `define TB_CORE0 ideal
+  `define TB_CORE1 dc
+  `define TB_CORE2 dm
+  `define TB_CORE_NAMES "ideal , cached , direct mapped"
+  `include "mips_tb_common.vh"
+
+  MIPS #(.DCACHE(0)) ideal (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.DCACHE(1), .DC_SETS(16), .DC_WAYS(2), .DC_LINE_WORDS(4), .DC_SB_ENTRIES(4), .DMEM_LATENCY(8)) dc (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.DCACHE(1), .DC_SETS(2),  .DC_WAYS(1), .DC_LINE_WORDS(2), .DC_SB_ENTRIES(2), .DMEM_LATENCY(8)) dm (`MIPS_TB_PORTS(1'b0));
+
+  task report;
+    input [8*12-1:0] name; input integer cycles; input [31:0] hits, misses, writebacks, stalls;
+    $display("%s : %0d cycles , %0d hits , %0d misses , %0d write-backs , %0d MEM stall cycles",
+             name, cycles, hits, misses, writebacks, stalls);
+  endtask
+
+  initial two_phase_clock(4000);
+
+  initial begin
+    reset = 1;
+    start_program;
+
+    put(ri(ADDI,  1, 0, 8));       // 0        R1 = 8            count
+    put(ri(ADDI,  2, 0, 0));       // 1        R2 = 0            index
+    put(ri(SW,    1, 2, 100));     // 2 fill:  Mem[100+R2] = R1
+    put(ri(SW,    1, 2, 200));     // 3        Mem[200+R2] = R1
+    put(ri(ADDI,  2, 2, 1));       // 4        R2 = R2 + 1
+    put(ri(SUBI,  1, 1, 1));       // 5        R1 = R1 - 1
+    put(ri(BNEQZ, 0, 1, -16'd5));  // 6        BNEQZ R1 , fill
+    put(ri(ADDI,  2, 0, 0));       // 7        R2 = 0
+    put(ri(ADDI,  1, 0, 8));       // 8        R1 = 8
+    put(ri(ADDI,  3, 0, 0));       // 9        R3 = 0            sum
+    put(ri(LW,    4, 2, 100));     // 10 sum:  R4 = Mem[100+R2]
+    put(ri(LW,    5, 2, 200));     // 11       R5 = Mem[200+R2]
+    put(rr(ADD,   3, 3, 4));       // 12       R3 = R3 + R4
+    put(rr(ADD,   3, 3, 5));       // 13       R3 = R3 + R5
+    put(ri(ADDI,  2, 2, 1));       // 14       R2 = R2 + 1
+    put(ri(SUBI,  1, 1, 1));       // 15       R1 = R1 - 1
+    put(ri(BNEQZ, 0, 1, -16'd7));  // 16       BNEQZ R1 , sum
+    put(ri(SW,    3, 0, 300));     // 17       Mem[300] = R3
+    put(ri(LW,    6, 0, 300));     // 18       R6 = Mem[300]     (from the store buffer)
+    put(rr(HLT,   0, 0, 0));       // 19
+
+    #22 reset = 0;   // after the first clk1 and clk2 edges
+  end
+
+  initial begin cyc_ideal = 0; cyc_dc = 0; cyc_dm = 0; end
+  always @(posedge clk1) begin
+    if (ideal.HALTED == 0) cyc_ideal = cyc_ideal + 1;
+    if (dc.HALTED == 0) cyc_dc = cyc_dc + 1;
+    if (dm.HALTED == 0) cyc_dm = cyc_dm + 1;
+  end
+
+  initial begin
+    wait (all_halted && dc.MEM_SYNCED === 1 && dm.MEM_SYNCED === 1);
+    #1;
+    check(3, 72); check(6, 72);
+    for (k = 0; k < 8; k = k + 1) begin
+      check_mem(100 + k, 8 - k);
+      check_mem(200 + k, 8 - k);
+    end
+    check_mem(300, 72);
+
+    report("ideal DMEM  ", cyc_ideal, 0, 0, 0, ideal.MEM_STALLS);
+    report("2w x 16 x 4 ", cyc_dc, dc.dcache.HITS, dc.dcache.MISSES, dc.dcache.WRITEBACKS, dc.MEM_STALLS);
+    report("1w x 2 x 2  ", cyc_dm, dm.dcache.HITS, dm.dcache.MISSES, dm.dcache.WRITEBACKS, dm.MEM_STALLS);
+    if (dm.dcache.WRITEBACKS == 0) begin
+      $display("FAIL : direct mapped cache never wrote a dirty line back");
+      errors = errors + 1;
+    end
+    pass_fail;
+  end
+
+  initial watchdog(80000);
+
+endmodule
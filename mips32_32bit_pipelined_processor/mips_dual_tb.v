@@ -0,0 +1,83 @@
+`timescale 1ns / 1ps
+// Dual-issue regression : independent pairs , a pair split by a dependence ,
+// a store and a load beside ALU ops , a loop whose counter comes from the
+// second slot , a divide followed by a held pair and a mispredicted branch.
+// It runs on MIPS single issue and on MIPS with DUAL_ISSUE , with forwarding ,
+// without it and with EARLY_BRANCH ; every core must end with the same
+// registers and memory , and the dual-issue cores must have paired
+// instructions and used fewer cycles for the same RETIRED.
+
+module test_mips32_dual;
+
+  reg clk1, clk2, reset;
+
+  `define TB_CORE0 one
+  `define TB_CORE1 two
+  `define TB_CORE2 nf
+  `define TB_CORE3 eb
+  `define TB_CORE_NAMES "single , dual , no forwarding , early branch"
+  `include "mips_tb_common.vh"
+
+  MIPS                                           one (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.DUAL_ISSUE(1))                         two (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.DUAL_ISSUE(1), .FORWARDING(0))         nf  (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.DUAL_ISSUE(1), .EARLY_BRANCH(1))       eb  (`MIPS_TB_PORTS(1'b0));
+
+  initial two_phase_clock(300);
+
+  initial begin
+    reset = 1;
+    start_program;
+
+    put(ri(ADDI,  1, 0, 10));      // 0        R1 = 10           pair
+    put(ri(ADDI,  2, 0, 3));       // 1        R2 = 3
+    put(rr(ADD,   3, 1, 2));       // 2        R3 = 13           pair , both forwarded from the pair ahead
+    put(rr(SUB,   4, 1, 2));       // 3        R4 = 7
+    put(rr(ADD,   5, 3, 4));       // 4        R5 = 20           split : 5 reads R5
+    put(rr(ADD,   6, 5, 5));       // 5        R6 = 40           split : SW only goes first
+    put(ri(SW,    6, 0, 50));      // 6        Mem[50] = 40      pair
+    put(ri(ADDI,  7, 0, 4));       // 7        R7 = 4
+    put(rr(ADD,   8, 8, 7));       // 8 loop:  R8 = R8 + R7      pair , R7 from the second slot ahead
+    put(ri(SUBI,  7, 7, 1));       // 9        R7 = R7 - 1
+    put(ri(BNEQZ, 0, 7, -16'd3));  // 10       BNEQZ R7 , loop   R8 = 10
+    put(ri(LW,    9, 0, 50));      // 11       R9 = 40           split : load-use
+    put(rr(ADD,  10, 9, 9));       // 12       R10 = 80
+    put(rr(DIV,  11, 10, 2));      // 13       R11 = 26          MDU op only goes alone
+    put(rr(ADD,  12, 11, 8));      // 14       R12 = 36          pair held on the scoreboard
+    put(ri(ADDI, 13, 0, 5));       // 15       R13 = 5
+    put(ri(SW,   12, 0, 51));      // 16       Mem[51] = 36      pair
+    put(rr(OR,   14, 12, 13));     // 17       R14 = 37
+    put(ri(BEQZ,  0, 0, 1));       // 18       always taken , mispredicted
+    put(ri(ADDI, 15, 0, 99));      // 19       skipped
+    put(ri(ADDI, 15, 0, 1));       // 20       R15 = 1
+    put(rr(HLT,   0, 0, 0));       // 21
+
+    #22 reset = 0;
+  end
+
+  initial begin
+    wait (all_halted);
+    #1;
+    check(3, 13); check(4, 7); check(5, 20); check(6, 40); check(7, 0); check(8, 10);
+    check(9, 40); check(10, 80); check(11, 26); check(12, 36); check(13, 5); check(14, 37); check(15, 1);
+    check_mem(50, 40); check_mem(51, 36);
+    if (two.RETIRED !== one.RETIRED || nf.RETIRED !== one.RETIRED || eb.RETIRED !== one.RETIRED) begin
+      $display("FAIL RETIRED : single %0d , dual %0d , %0d , %0d", one.RETIRED, two.RETIRED, nf.RETIRED, eb.RETIRED);
+      errors = errors + 1;
+    end
+    if (one.ISSUE_PAIRS != 0 || two.ISSUE_PAIRS == 0 || two.CYCLES >= one.CYCLES) begin
+      $display("FAIL no pairs : single %0d cycles , dual %0d cycles , %0d pairs", one.CYCLES, two.CYCLES, two.ISSUE_PAIRS);
+      errors = errors + 1;
+    end
+
+    $display("single issue        : CYCLES %0d , RETIRED %0d , IPC %0.2f", one.CYCLES, one.RETIRED, one.RETIRED * 1.0 / one.CYCLES);
+    $display("dual issue          : CYCLES %0d , RETIRED %0d , IPC %0.2f , ISSUE_PAIRS %0d",
+             two.CYCLES, two.RETIRED, two.RETIRED * 1.0 / two.CYCLES, two.ISSUE_PAIRS);
+    $display("dual , no forwarding : CYCLES %0d , ISSUE_PAIRS %0d , STALL_CYCLES %0d", nf.CYCLES, nf.ISSUE_PAIRS, nf.STALL_CYCLES);
+    $display("dual , early branch  : CYCLES %0d , ISSUE_PAIRS %0d", eb.CYCLES, eb.ISSUE_PAIRS);
+    pass_fail;
+  end
+
+  initial watchdog(6000);
+
+endmodule
@@ -0,0 +1,92 @@
+`timescale 1ns / 1ps
+// Fetch queue and loop buffer regression : a six-word loop whose ADD waits on
+// a DIV every iteration , then a DIV stall in front of straight-line code and
+// a LOOP with a two-word body. It runs with and without FQ_DEPTH = 4 and
+// LB_ENTRIES = 8 on the default pipeline , with EARLY_BRANCH and through the
+// I-cache , and with both on DUAL_ISSUE. All must end with the same
+// registers ; with the ideal IMEM in the same number of cycles , with most
+// fetches served by the loop buffer ; through the I-cache in fewer cycles ,
+// with I-cache stalls hidden by the queue and fewer I-cache reads.
+
+module test_mips32_fetchq;
+
+  reg clk1, clk2, reset;
+  integer k;
+
+  `define TB_CORE0 base
+  `define TB_CORE1 lbq
+  `define TB_CORE2 eb
+  `define TB_CORE3 ebq
+  `define TB_CORE4 ic
+  `define TB_CORE5 icq
+  `define TB_CORE6 dualq
+  `define TB_CORE_NAMES "base , queue , early , early queue , icache , icache queue , dual"
+  `include "mips_tb_common.vh"
+
+  MIPS                                                           base  (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.FQ_DEPTH(4), .LB_ENTRIES(8))                           lbq   (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.EARLY_BRANCH(1))                                       eb    (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.EARLY_BRANCH(1), .FQ_DEPTH(4), .LB_ENTRIES(8))         ebq   (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.ICACHE(1))                                             ic    (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.ICACHE(1), .FQ_DEPTH(4), .LB_ENTRIES(8))               icq   (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.DUAL_ISSUE(1), .FQ_DEPTH(2), .LB_ENTRIES(8))           dualq (`MIPS_TB_PORTS(1'b0));
+
+  initial two_phase_clock(4000);
+
+  initial begin
+    reset = 1;
+    start_program;
+
+    put(ri(ADDI,  2, 0, 1000));     // 0        R2 = 1000
+    put(ri(ADDI,  3, 0, 7));        // 1        R3 = 7
+    put(ri(ADDI,  6, 0, 12));       // 2        n = 12
+    put(rr(DIV,   1, 2, 3));        // 3 lp:    R1 = R2 / 7
+    put(rr(ADD,   4, 4, 1));        // 4        R4 += R1 , waits on the DIV      R4 = 1770
+    put(ri(ADDI,  5, 5, 1));        // 5        R5 = 12
+    put(ri(ADDI,  2, 2, 7));        // 6        R2 = 1084
+    put(ri(SUBI,  6, 6, 1));        // 7        n--
+    put(ri(BNEQZ, 0, 6, -16'd6));   // 8        BNEQZ R6 , lp
+    put(rr(DIV,  11, 2, 3));        // 9        R11 = 154
+    put(rr(ADD,  12, 11, 0));       // 10       R12 = 154 , the queue fills behind it
+    for (k = 0; k < 16; k = k + 1)
+      put(ri(ADDI, 7, 7, 1));       // 11 .. 26 R7 = 16
+    put(ri(ADDI,  8, 0, 10));       // 27       R8 = 10
+    put(ri(LOOP,  0, 8, 1));        // 28       LOOP R8 , e
+    put(ri(ADDI,  9, 9, 2));        // 29       R9 = 20
+    put(rr(ADD,  10, 10, 9));       // 30 e:    R10 = 110
+    put(rr(HLT,   0, 0, 0));        // 31
+
+    #22 reset = 0;
+  end
+
+  initial begin
+    wait (all_halted);
+    #1;
+    check(1, 153); check(2, 1084); check(4, 1770); check(5, 12); check(6, 0); check(7, 16);
+    check(9, 20); check(10, 110); check(11, 154); check(12, 154);
+    // the ideal IMEM never misses , so the queue has no fetch stall to hide
+    if (lbq.CYCLES != base.CYCLES || ebq.CYCLES != eb.CYCLES || lbq.FQ_STALLS_HIDDEN != 0) begin
+      $display("FAIL ideal IMEM cycles : base %0d / %0d , early %0d / %0d , FQ_STALLS_HIDDEN %0d", base.CYCLES, lbq.CYCLES,
+               eb.CYCLES, ebq.CYCLES, lbq.FQ_STALLS_HIDDEN);
+      errors = errors + 1;
+    end
+    if (lbq.LB_HITS < 50 || ebq.LB_HITS < 50 || icq.LB_HITS < 50 || dualq.LB_HITS == 0) begin
+      $display("FAIL LB_HITS : %0d %0d %0d %0d", lbq.LB_HITS, ebq.LB_HITS, icq.LB_HITS, dualq.LB_HITS);
+      errors = errors + 1;
+    end
+    if (icq.CYCLES >= ic.CYCLES || icq.FQ_STALLS_HIDDEN == 0 || icq.icache.HITS >= ic.icache.HITS) begin
+      $display("FAIL icache : %0d / %0d cycles , FQ_STALLS_HIDDEN %0d , I-cache hits %0d / %0d", ic.CYCLES, icq.CYCLES,
+               icq.FQ_STALLS_HIDDEN, ic.icache.HITS, icq.icache.HITS);
+      errors = errors + 1;
+    end
+
+    $display("cycles without / with the queue and loop buffer : base %0d / %0d , early %0d / %0d , icache %0d / %0d , dual %0d",
+             base.CYCLES, lbq.CYCLES, eb.CYCLES, ebq.CYCLES, ic.CYCLES, icq.CYCLES, dualq.CYCLES);
+    $display("LB_HITS %0d %0d %0d %0d , FQ_STALLS_HIDDEN %0d , FETCH_STALLS %0d / %0d", lbq.LB_HITS, ebq.LB_HITS,
+             icq.LB_HITS, dualq.LB_HITS, icq.FQ_STALLS_HIDDEN, ic.FETCH_STALLS, icq.FETCH_STALLS);
+    pass_fail;
+  end
+
+  initial watchdog(80000);
+
+endmodule
@@ -0,0 +1,81 @@
+`timescale 1ns / 1ps
+// Forwarding regression : the same dependent chain is run on a core with the
+// bypass network (no padding) , on a core without it padded with dummy
+// OR R31,R31,R31 the way mips_tb.v does , and on a core without it running the
+// unpadded program on the hazard interlock alone. All three must end with the
+// same register and memory state ; the cycle counts give the CPI of each and
+// STALL_CYCLES shows what the interlock costs.
+
+module test_mips32_forward;
+
+  reg clk1, clk2, reset;
+  integer n_pad;   // words in the padded program , n counts the unpadded one
+  integer cyc_fwd, cyc_pad, cyc_ilk;
+
+  `define TB_CORE0 fwd
+  `define TB_CORE1 pad
+  `define TB_CORE2 ilk
+  `define TB_CORE_NAMES "forwarded , padded , interlocked"
+  `include "mips_tb_common.vh"
+
+  MIPS #(.FORWARDING(1)) fwd (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.FORWARDING(0)) pad (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.FORWARDING(0)) ilk (`MIPS_TB_PORTS(1'b0));
+
+  task put_fwd; input [31:0] ir; begin fwd.imem.Mem[n] = ir; ilk.imem.Mem[n] = ir; n = n + 1; end endtask
+  task put_pad; input [31:0] ir; begin pad.imem.Mem[n_pad] = ir; n_pad = n_pad + 1; end endtask
+  // dependent instruction : the unforwarded core needs one dummy in front of it
+  task put_dep; input [31:0] ir; begin put_pad(rr(OR, 31, 31, 31)); put_fwd(ir); put_pad(ir); end endtask
+  task put_both; input [31:0] ir; begin put_fwd(ir); put_pad(ir); end endtask
+
+  initial two_phase_clock(200);
+
+  initial begin
+    reset = 1;
+    start_program;
+    n_pad = 0;
+
+    put_both(ri(ADDI, 1, 0, 10));      // R1 = 10
+    put_dep (ri(ADDI, 2, 1, 20));      // R2 = R1 + 20        = 30
+    put_dep (rr(ADD,  3, 1, 2));       // R3 = R1 + R2        = 40
+    put_dep (rr(SUB,  4, 3, 1));       // R4 = R3 - R1        = 30
+    put_dep (rr(MUL,  5, 4, 2));       // R5 = R4 * R2        = 900
+    put_dep (ri(SW,   5, 0, 100));     // Mem[100] = R5 (store data bypassed)
+    put_both(ri(LW,   6, 0, 100));     // R6 = Mem[100]       = 900
+    put_dep (rr(ADD,  7, 6, 3));       // R7 = R6 + R3        = 940 (load-use)
+    put_dep (rr(SLT,  8, 1, 7));       // R8 = R1 < R7        = 1
+    put_both(rr(HLT,  0, 0, 0));
+
+    #22 reset = 0;   // after the first clk1 and clk2 edges
+  end
+
+  // cycle = one clk1 period , counted until each core reaches HALTED
+  initial begin cyc_fwd = 0; cyc_pad = 0; cyc_ilk = 0; end
+  always @(posedge clk1) begin
+    if (fwd.HALTED == 0) cyc_fwd = cyc_fwd + 1;
+    if (pad.HALTED == 0) cyc_pad = cyc_pad + 1;
+    if (ilk.HALTED == 0) cyc_ilk = cyc_ilk + 1;
+  end
+
+  initial begin
+    wait (all_halted);
+    #1;
+    check(1, 10); check(2, 30); check(3, 40); check(4, 30);
+    check(5, 900); check(6, 900); check(7, 940); check(8, 1);
+    check_mem(100, 900);
+
+    $display("with bypass    : %0d instructions , %0d cycles , CPI %0.2f", n, cyc_fwd, cyc_fwd * 1.0 / n);
+    $display("without bypass : %0d instructions (%0d useful) , %0d cycles , CPI %0.2f per useful instruction",
+             n_pad, n, cyc_pad, cyc_pad * 1.0 / n);
+    $display("interlocked    : %0d instructions , %0d cycles , CPI %0.2f , %0d stall cycles",
+             n, cyc_ilk, cyc_ilk * 1.0 / n, ilk.STALL_CYCLES);
+    if (fwd.STALL_CYCLES != 0 || pad.STALL_CYCLES != 0) begin
+      $display("FAIL : unexpected stalls , forwarded %0d , padded %0d", fwd.STALL_CYCLES, pad.STALL_CYCLES);
+      errors = errors + 1;
+    end
+    pass_fail;
+  end
+
+  initial watchdog(4000);
+
+endmodule
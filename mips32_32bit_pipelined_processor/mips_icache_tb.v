@@ -0,0 +1,71 @@
+`timescale 1ns / 1ps
+// Instruction cache regression : a nested loop kernel is fetched from ideal
+// IMEM , through a 2-way 16-set I-cache over an 8-cycle IMEM , and through a
+// tiny direct-mapped cache that cannot hold the loop. All must produce the same
+// sum ; the report gives cycles , hit / miss counts and fetch stall cycles.
+
+module test_mips32_icache;
+
+  reg clk1, clk2, reset;
+  integer cyc_ideal, cyc_ic, cyc_dm;
+
+  `define TB_CORE0 ideal
+  `define TB_CORE1 ic
+  `define TB_CORE2 dm
+  `define TB_CORE_NAMES "ideal , cached , direct mapped"
+  `include "mips_tb_common.vh"
+
+  MIPS #(.ICACHE(0)) ideal (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.ICACHE(1), .IC_SETS(16), .IC_WAYS(2), .IC_LINE_WORDS(4), .IMEM_LATENCY(8)) ic (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.ICACHE(1), .IC_SETS(2),  .IC_WAYS(1), .IC_LINE_WORDS(2), .IMEM_LATENCY(8)) dm (`MIPS_TB_PORTS(1'b0));
+
+  task report;
+    input [8*12-1:0] name; input integer cycles; input [31:0] hits, misses, stalls;
+    $display("%s : %0d cycles , %0d hits , %0d misses , %0d fetch stall cycles", name, cycles, hits, misses, stalls);
+  endtask
+
+  initial two_phase_clock(1500);
+
+  initial begin
+    reset = 1;
+    start_program;
+
+    put(ri(ADDI,  3, 0, 5));       // 0        R3 = 5            outer count
+    put(ri(ADDI,  2, 0, 0));       // 1        R2 = 0            sum
+    put(ri(ADDI,  1, 0, 10));      // 2 outer: R1 = 10           inner count
+    put(rr(ADD,   2, 2, 1));       // 3 inner: R2 = R2 + R1
+    put(ri(SUBI,  1, 1, 1));       // 4        R1 = R1 - 1
+    put(ri(BNEQZ, 0, 1, -16'd3));  // 5        BNEQZ R1 , inner
+    put(ri(SUBI,  3, 3, 1));       // 6        R3 = R3 - 1
+    put(ri(BNEQZ, 0, 3, -16'd6));  // 7        BNEQZ R3 , outer
+    put(ri(SW,    2, 0, 200));     // 8        Mem[200] = R2
+    put(rr(HLT,   0, 0, 0));       // 9
+
+    #22 reset = 0;   // after the first clk1 and clk2 edges
+  end
+
+  initial begin cyc_ideal = 0; cyc_ic = 0; cyc_dm = 0; end
+  always @(posedge clk1) begin
+    if (ideal.HALTED == 0) cyc_ideal = cyc_ideal + 1;
+    if (ic.HALTED == 0) cyc_ic = cyc_ic + 1;
+    if (dm.HALTED == 0) cyc_dm = cyc_dm + 1;
+  end
+
+  initial begin
+    wait (all_halted);
+    #1;
+    if (ideal.dmem.Mem[200] !== 275 || ic.dmem.Mem[200] !== 275 || dm.dmem.Mem[200] !== 275) begin
+      $display("FAIL Mem[200] : ideal %0d , cached %0d , direct mapped %0d , expected 275",
+               ideal.dmem.Mem[200], ic.dmem.Mem[200], dm.dmem.Mem[200]);
+      errors = errors + 1;
+    end
+
+    report("ideal IMEM  ", cyc_ideal, 0, 0, ideal.FETCH_STALLS);
+    report("2w x 16 x 4 ", cyc_ic, ic.icache.HITS, ic.icache.MISSES, ic.FETCH_STALLS);
+    report("1w x 2 x 2  ", cyc_dm, dm.icache.HITS, dm.icache.MISSES, dm.FETCH_STALLS);
+    pass_fail;
+  end
+
+  initial watchdog(30000);
+
+endmodule
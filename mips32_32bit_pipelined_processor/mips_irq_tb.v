@@ -0,0 +1,96 @@
+`timescale 1ns / 1ps
+// Trap regression : a summing loop runs with STATUS.IE set while irq pulses
+// three times , then a reserved instruction traps once. The handler at
+// EXC_VECTOR reads CAUSE , counts interrupts in R23 and , for the reserved
+// instruction , moves EPC past it (the store to EPC right before ERET) and
+// counts it in R22. It runs on the default pipeline , with EARLY_BRANCH ,
+// DUAL_ISSUE , without forwarding and through an OOO_COMPLETE D-cache ; each
+// takes the interrupts at other places in the loop , all must end with the
+// same registers , memory , TRAPS and RETIRED as if nothing had interrupted.
+
+module test_mips32_irq;
+
+  reg clk1, clk2, reset, irq;
+  integer k;
+
+  `define TB_CORE0 base
+  `define TB_CORE1 eb
+  `define TB_CORE2 dual
+  `define TB_CORE3 nf
+  `define TB_CORE4 ooo
+  `define TB_CORE_NAMES "base , early branch , dual , no forwarding , out of order"
+  `include "mips_tb_common.vh"
+
+  MIPS                                       base (`MIPS_TB_PORTS(irq));
+  MIPS #(.EARLY_BRANCH(1))                   eb   (`MIPS_TB_PORTS(irq));
+  MIPS #(.DUAL_ISSUE(1))                     dual (`MIPS_TB_PORTS(irq));
+  MIPS #(.FORWARDING(0))                     nf   (`MIPS_TB_PORTS(irq));
+  MIPS #(.DCACHE(1), .OOO_COMPLETE(1))       ooo  (`MIPS_TB_PORTS(irq));
+
+  initial two_phase_clock(1000);
+
+  initial begin
+    reset = 1; irq = 0;
+    start_program;
+
+    put(ri(ADDI,  1, 0, 1));       // 0        R1 = 1
+    put(ri(SW,    1, 0, STATUS));  // 1        STATUS = IE
+    put(ri(ADDI,  2, 0, 40));      // 2        R2 = 40
+    put(ri(ADDI,  3, 0, 0));       // 3        R3 = 0
+    put(rr(ADD,   3, 3, 2));       // 4 loop:  R3 += R2          interrupted somewhere in here
+    put(ri(SW,    3, 2, 100));     // 5        Mem[100 + R2] = R3
+    put(ri(SUBI,  2, 2, 1));       // 6        R2--
+    put(ri(BNEQZ, 0, 2, -16'd4));  // 7        BNEQZ R2 , loop   R3 = 820
+    put(ri(LW,    4, 0, 140));     // 8        R4 = 40
+    put({6'b101010, 26'd0});       // 9        reserved , traps with EPC = 9
+    put(ri(SW,    3, 0, 200));     // 10       Mem[200] = 820
+    put(rr(HLT,   0, 0, 0));       // 11
+
+    n = 256;                       // EXC_VECTOR
+    put(ri(LW,   20, 0, CAUSE));   // 256      R20 = CAUSE
+    put(ri(BEQZ,  0, 20, 16'd5));  // 257      BEQZ R20 , int
+    put(ri(LW,   21, 0, EPC));     // 258      R21 = EPC
+    put(ri(ADDI, 21, 21, 1));      // 259      past the reserved instruction
+    put(ri(ADDI, 22, 22, 1));      // 260      R22++
+    put(ri(SW,   21, 0, EPC));     // 261      EPC = R21 , read by the ERET right behind
+    put(rr(ERET,  0, 0, 0));       // 262
+    put(ri(ADDI, 23, 23, 1));      // 263 int: R23++
+    put(rr(ERET,  0, 0, 0));       // 264
+
+    #22 reset = 0;
+    for (k = 0; k < 3; k = k + 1) begin
+      #400 irq = 1;
+      #20 irq = 0;
+    end
+  end
+
+  initial begin
+    wait (all_halted && ooo.MEM_SYNCED === 1);
+    #1;
+    check(2, 0); check(3, 820); check(4, 40); check(20, 10); check(21, 10); check(22, 1); check(23, 3);
+    check_mem(101, 820); check_mem(140, 40); check_mem(200, 820);
+    if (base.TRAPS != 4 || eb.TRAPS != 4 || dual.TRAPS != 4 || nf.TRAPS != 4 || ooo.TRAPS != 4) begin
+      $display("FAIL TRAPS : %0d %0d %0d %0d %0d , expected 4", base.TRAPS, eb.TRAPS, dual.TRAPS, nf.TRAPS, ooo.TRAPS);
+      errors = errors + 1;
+    end
+    if (eb.RETIRED != base.RETIRED || dual.RETIRED != base.RETIRED || nf.RETIRED != base.RETIRED ||
+        ooo.RETIRED != base.RETIRED) begin
+      $display("FAIL RETIRED : %0d %0d %0d %0d %0d", base.RETIRED, eb.RETIRED, dual.RETIRED, nf.RETIRED, ooo.RETIRED);
+      errors = errors + 1;
+    end
+    if ({base.STATUS_EXL, base.STATUS_IE} != 2'b01 || base.EPC != 10) begin
+      $display("FAIL STATUS %b%b , EPC %0d : expected 01 , 10", base.STATUS_EXL, base.STATUS_IE, base.EPC);
+      errors = errors + 1;
+    end
+
+    $display("base          : CYCLES %0d , RETIRED %0d , TRAPS %0d", base.CYCLES, base.RETIRED, base.TRAPS);
+    $display("EARLY_BRANCH  : CYCLES %0d , RETIRED %0d , TRAPS %0d", eb.CYCLES, eb.RETIRED, eb.TRAPS);
+    $display("DUAL_ISSUE    : CYCLES %0d , RETIRED %0d , TRAPS %0d", dual.CYCLES, dual.RETIRED, dual.TRAPS);
+    $display("no forwarding : CYCLES %0d , RETIRED %0d , TRAPS %0d", nf.CYCLES, nf.RETIRED, nf.TRAPS);
+    $display("OOO_COMPLETE  : CYCLES %0d , RETIRED %0d , TRAPS %0d", ooo.CYCLES, ooo.RETIRED, ooo.TRAPS);
+    pass_fail;
+  end
+
+  initial watchdog(20000);
+
+endmodule
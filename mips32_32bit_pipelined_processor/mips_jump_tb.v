@@ -0,0 +1,96 @@
+`timescale 1ns / 1ps
+// Jump regression : a leaf function called from two sites in a loop , a JR
+// through a register that is not R31 , a nested call that saves and restores
+// R31 and a J over a skipped instruction. The link is used right after JAL
+// and R31 right before JR R31 , so both go through the bypass. It runs on
+// MIPS with the return-address stack , without it , with EARLY_BRANCH , with
+// DUAL_ISSUE , without forwarding and on MIPS_1clk ; every core must end with
+// the same registers and memory and the stack must save redirects.
+
+module test_mips32_jump;
+
+  reg clk1, clk2, clk, reset;
+
+  `define TB_CORE0 ras
+  `define TB_CORE1 noras
+  `define TB_CORE2 eb
+  `define TB_CORE3 dual
+  `define TB_CORE4 nf
+  `define TB_CORE5 sc
+  `define TB_CORE_NAMES "RAS , no RAS , early branch , dual , no forwarding , single clock"
+  `include "mips_tb_common.vh"
+
+  MIPS                           ras   (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.RAS_ENTRIES(0))        noras (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.EARLY_BRANCH(1))       eb    (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.DUAL_ISSUE(1))         dual  (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.FORWARDING(0))         nf    (`MIPS_TB_PORTS(1'b0));
+  MIPS_1clk                      sc    (clk, reset, 1'b0);
+
+  initial two_phase_clock(300);
+
+  initial begin
+    clk = 0;
+    repeat (600) #5 clk = ~clk;
+  end
+
+  initial begin
+    reset = 1;
+    start_program;
+
+    put(ri(ADDI,  1, 0, 3));       // 0        R1 = 3
+    put(jj(JAL,  12));             // 1 loop:  JAL f             R31 = 2
+    put(jj(JAL,  12));             // 2        JAL f             R31 = 3
+    put(ri(SUBI,  1, 1, 1));       // 3        R1--
+    put(ri(BNEQZ, 0, 1, -16'd4));  // 4        BNEQZ R1 , loop   R2 = 15
+    put(ri(ADDI,  6, 0, 9));       // 5        R6 = 9
+    put(rr(JR,    0, 6, 0));       // 6        JR R6             through the BTB
+    put(ri(ADDI,  7, 0, 99));      // 7        skipped
+    put(rr(HLT,   0, 0, 0));       // 8        skipped
+    put(jj(JAL,  14));             // 9        JAL g             R31 = 10
+    put(jj(J,    18));             // 10       J done
+    put(ri(ADDI,  7, 0, 98));      // 11       skipped
+    put(rr(ADD,   2, 2, 31));      // 12 f:    R2 += R31         link forwarded
+    put(rr(JR,    0, 31, 0));      // 13       JR R31
+    put(rr(ADD,   8, 31, 0));      // 14 g:    R8 = R31 = 10
+    put(jj(JAL,  12));             // 15       JAL f             R2 = 31
+    put(rr(ADD,  31, 8, 0));       // 16       R31 = R8          one ahead of JR
+    put(rr(JR,    0, 31, 0));      // 17       JR R31            to 10
+    put(ri(SW,    2, 0, 100));     // 18 done: Mem[100] = 31
+    put(ri(SW,   31, 0, 101));     // 19       Mem[101] = 10
+    put(rr(HLT,   0, 0, 0));       // 20
+
+    #22 reset = 0;   // after the first clk1 , clk2 and clk edges
+  end
+
+  initial begin
+    wait (all_halted);
+    #1;
+    check(1, 0); check(2, 31); check(6, 9); check(7, 0); check(8, 10); check(31, 10);
+    check_mem(100, 31); check_mem(101, 10);
+    if (noras.RETIRED !== ras.RETIRED || eb.RETIRED !== ras.RETIRED || dual.RETIRED !== ras.RETIRED ||
+        nf.RETIRED !== ras.RETIRED || sc.RETIRED !== ras.RETIRED) begin
+      $display("FAIL RETIRED : %0d , %0d , %0d , %0d , %0d , %0d", ras.RETIRED, noras.RETIRED, eb.RETIRED,
+               dual.RETIRED, nf.RETIRED, sc.RETIRED);
+      errors = errors + 1;
+    end
+    if (ras.BRANCH_FLUSHES + 4 > noras.BRANCH_FLUSHES || ras.CYCLES >= noras.CYCLES) begin
+      $display("FAIL returns not predicted : RAS %0d flushes / %0d cycles , no RAS %0d / %0d",
+               ras.BRANCH_FLUSHES, ras.CYCLES, noras.BRANCH_FLUSHES, noras.CYCLES);
+      errors = errors + 1;
+    end
+
+    $display("RAS           : CYCLES %0d , RETIRED %0d , BRANCH_FLUSHES %0d , BP %0d / %0d",
+             ras.CYCLES, ras.RETIRED, ras.BRANCH_FLUSHES, ras.BP_HITS, ras.BP_BRANCHES);
+    $display("no RAS        : CYCLES %0d , BRANCH_FLUSHES %0d , BP %0d / %0d",
+             noras.CYCLES, noras.BRANCH_FLUSHES, noras.BP_HITS, noras.BP_BRANCHES);
+    $display("early branch  : CYCLES %0d , BRANCH_FLUSHES %0d", eb.CYCLES, eb.BRANCH_FLUSHES);
+    $display("dual issue    : CYCLES %0d , ISSUE_PAIRS %0d", dual.CYCLES, dual.ISSUE_PAIRS);
+    $display("no forwarding : CYCLES %0d , STALL_CYCLES %0d", nf.CYCLES, nf.STALL_CYCLES);
+    $display("single clock  : CYCLES %0d , BRANCH_FLUSHES %0d", sc.CYCLES, sc.BRANCH_FLUSHES);
+    pass_fail;
+  end
+
+  initial watchdog(6000);
+
+endmodule
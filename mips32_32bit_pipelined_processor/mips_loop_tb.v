@@ -0,0 +1,131 @@
+`timescale 1ns / 1ps
+// Hardware loop regression : a 32-word sum done twice , with a SUBI / BNEQZ
+// loop and with LOOP , the CYCLES counter read around each ; a LOOP with a
+// zero count and a one-instruction body ; then a LOOP summing 1 .. 60 while
+// irq pulses every 300 ns , so traps land all over the body , the end
+// going back included. The handler at EXC_VECTOR counts them in R25. It runs
+// on the default pipeline , with EARLY_BRANCH , DUAL_ISSUE , without
+// forwarding and through the I-cache ; all must end with the same registers
+// and memory , 405 + 2 * R25 instructions retired , and the LOOP sum at least
+// 1.4 times faster than the branch loop with no more than a few cycles
+// over three per iteration (two per iteration dual issue).
+
+module test_mips32_loop;
+
+  reg clk1, clk2, reset, irq;
+  integer k;
+
+  `define TB_CORE0 base
+  `define TB_CORE1 eb
+  `define TB_CORE2 dual
+  `define TB_CORE3 nf
+  `define TB_CORE4 ic
+  `define TB_CORE_NAMES "base , early branch , dual , no forwarding , icache"
+  `include "mips_tb_common.vh"
+
+  MIPS                        base (`MIPS_TB_PORTS(irq));
+  MIPS #(.EARLY_BRANCH(1))    eb   (`MIPS_TB_PORTS(irq));
+  MIPS #(.DUAL_ISSUE(1))      dual (`MIPS_TB_PORTS(irq));
+  MIPS #(.FORWARDING(0))      nf   (`MIPS_TB_PORTS(irq));
+  MIPS #(.ICACHE(1))          ic   (`MIPS_TB_PORTS(irq));
+
+  initial two_phase_clock(2000);
+
+  initial begin
+    irq = 0;
+    #22;
+    forever begin
+      #280 irq = 1;
+      #20 irq = 0;
+    end
+  end
+
+  initial begin
+    reset = 1;
+    start_program;
+    for (k = 0; k < 32; k = k + 1) data(k, 8 * k);
+
+    put(ri(LW,   20, 0, -16'd256)); // 0        R20 = CYCLES
+    put(ri(ADDI,  1, 0, 0));        // 1        p = 0
+    put(ri(ADDI,  2, 0, 32));       // 2        n = 32
+    put(ri(ADDI,  3, 0, 0));        // 3        R3 = 0
+    put(ri(LW,    4, 1, 0));        // 4 sw:    R4 = *p
+    put(rr(ADD,   3, 3, 4));        // 5        R3 += R4
+    put(ri(ADDI,  1, 1, 1));        // 6        p++
+    put(ri(SUBI,  2, 2, 1));        // 7        n--
+    put(ri(BNEQZ, 0, 2, -16'd5));   // 8        BNEQZ R2 , sw     R3 = 3968
+    put(ri(LW,   21, 0, -16'd256)); // 9        R21 = CYCLES
+    put(ri(ADDI,  1, 0, 0));        // 10       p = 0
+    put(ri(ADDI,  2, 0, 32));       // 11       n = 32
+    put(ri(ADDI,  5, 0, 0));        // 12       R5 = 0
+    put(ri(LOOP,  0, 2, 2));        // 13       LOOP R2 , e1
+    put(ri(LW,    4, 1, 0));        // 14       R4 = *p
+    put(ri(ADDI,  1, 1, 1));        // 15       p++
+    put(rr(ADD,   5, 5, 4));        // 16 e1:   R5 += R4          R5 = 3968
+    put(ri(LW,   22, 0, -16'd256)); // 17       R22 = CYCLES
+    put(ri(LOOP,  0, 0, 0));        // 18       LOOP R0 , e2      runs once
+    put(ri(ADDI,  7, 7, 1));        // 19 e2:   R7 = 1
+    put(ri(ADDI,  8, 0, 5));        // 20       R8 = 5
+    put(ri(LOOP,  0, 8, 0));        // 21       LOOP R8 , e3
+    put(ri(ADDI,  9, 9, 3));        // 22 e3:   R9 = 15
+    put(rr(SUB,  23, 21, 20));      // 23       R23 = branch loop cycles
+    put(rr(SUB,  24, 22, 21));      // 24       R24 = LOOP cycles
+    put(ri(ADDI, 10, 0, 1));        // 25       R10 = 1
+    put(ri(SW,   10, 0, STATUS));   // 26       STATUS = IE
+    put(ri(ADDI, 11, 0, 60));       // 27       R11 = 60
+    put(ri(LOOP,  0, 11, 1));       // 28       LOOP R11 , e4     interrupted all over
+    put(ri(ADDI, 13, 13, 1));       // 29       R13++
+    put(rr(ADD,  12, 12, 13));      // 30 e4:   R12 += R13        R12 = 1830
+    put(ri(SW,    3, 0, 60));       // 31       Mem[60] = 3968
+    put(ri(SW,    5, 0, 61));       // 32       Mem[61] = 3968
+    put(ri(SW,   12, 0, 62));       // 33       Mem[62] = 1830
+    put(rr(HLT,   0, 0, 0));        // 34
+
+    n = 256;                        // EXC_VECTOR
+    put(ri(ADDI, 25, 25, 1));       // 256      R25++
+    put(rr(ERET,  0, 0, 0));        // 257
+
+    #22 reset = 0;
+  end
+
+  initial begin
+    wait (all_halted);
+    #1;
+    check(3, 3968); check(5, 3968); check(7, 1); check(9, 15); check(12, 1830); check(13, 60);
+    check_mem(60, 3968); check_mem(61, 3968); check_mem(62, 1830);
+    if (base.RETIRED != 405 + 2 * base.Reg[25] || eb.RETIRED != 405 + 2 * eb.Reg[25] ||
+        dual.RETIRED != 405 + 2 * dual.Reg[25] || nf.RETIRED != 405 + 2 * nf.Reg[25] ||
+        ic.RETIRED != 405 + 2 * ic.Reg[25]) begin
+      $display("FAIL RETIRED : %0d %0d %0d %0d %0d with %0d %0d %0d %0d %0d interrupts",
+               base.RETIRED, eb.RETIRED, dual.RETIRED, nf.RETIRED, ic.RETIRED,
+               base.Reg[25], eb.Reg[25], dual.Reg[25], nf.Reg[25], ic.Reg[25]);
+      errors = errors + 1;
+    end
+    if (base.TRAPS < 3 || eb.TRAPS < 3 || dual.TRAPS < 3 || nf.TRAPS < 3 || ic.TRAPS < 3) begin
+      $display("FAIL TRAPS : %0d %0d %0d %0d %0d , expected at least 3", base.TRAPS, eb.TRAPS, dual.TRAPS,
+               nf.TRAPS, ic.TRAPS);
+      errors = errors + 1;
+    end
+    if (5 * base.Reg[23] < 7 * base.Reg[24] || 5 * eb.Reg[23] < 7 * eb.Reg[24] ||
+        5 * dual.Reg[23] < 7 * dual.Reg[24] || 5 * nf.Reg[23] < 7 * nf.Reg[24]) begin
+      $display("FAIL LOOP not 1.4x faster : base %0d / %0d , early %0d / %0d , dual %0d / %0d , no forwarding %0d / %0d",
+               base.Reg[23], base.Reg[24], eb.Reg[23], eb.Reg[24], dual.Reg[23], dual.Reg[24], nf.Reg[23], nf.Reg[24]);
+      errors = errors + 1;
+    end
+    if (base.Reg[24] > 3 * 32 + 8 || eb.Reg[24] > 3 * 32 + 8 || nf.Reg[24] > 3 * 32 + 8 || dual.Reg[24] > 2 * 32 + 8) begin
+      $display("FAIL LOOP overhead : base %0d , early %0d , no forwarding %0d , dual %0d cycles for 32 iterations",
+               base.Reg[24], eb.Reg[24], nf.Reg[24], dual.Reg[24]);
+      errors = errors + 1;
+    end
+
+    $display("sum cycles , SUBI / BNEQZ loop / LOOP : base %0d / %0d , early %0d / %0d , dual %0d / %0d , no forwarding %0d / %0d , icache %0d / %0d",
+             base.Reg[23], base.Reg[24], eb.Reg[23], eb.Reg[24], dual.Reg[23], dual.Reg[24],
+             nf.Reg[23], nf.Reg[24], ic.Reg[23], ic.Reg[24]);
+    $display("interrupts taken in the LOOP : %0d %0d %0d %0d %0d", base.Reg[25], eb.Reg[25], dual.Reg[25],
+             nf.Reg[25], ic.Reg[25]);
+    pass_fail;
+  end
+
+  initial watchdog(40000);
+
+endmodule
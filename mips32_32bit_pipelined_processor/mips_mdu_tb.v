@@ -0,0 +1,80 @@
+`timescale 1ns / 1ps
+// Multiply / divide regression : DIV , REM and MUL with an independent loop
+// running while the divider is busy , a divide waiting for the divider , a
+// consumer waiting on the scoreboard and two divides by zero. It runs on MIPS
+// (MUL in the EX ALU) , MIPS with a 3-stage multiplier and MIPS_1clk (blocking
+// divider) ; every core must end with the same registers and memory , and
+// the two-phase cores must have hidden part of the divide latency.
+
+module test_mips32_mdu;
+
+  reg clk1, clk2, clk, reset;
+
+  `define TB_CORE0 alu
+  `define TB_CORE1 mdu
+  `define TB_CORE2 one
+  `define TB_CORE_NAMES "EX multiplier , MDU multiplier , single clock"
+  `include "mips_tb_common.vh"
+
+  MIPS                      alu (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.MUL_LATENCY(3))   mdu (`MIPS_TB_PORTS(1'b0));
+  MIPS_1clk                 one (clk, reset, 1'b0);
+
+  initial two_phase_clock(400);
+
+  initial begin
+    clk = 0;
+    repeat (1000) #5 clk = ~clk;
+  end
+
+  initial begin
+    reset = 1;
+    start_program;
+
+    put(ri(ADDI,  1, 0, 100));     // 0        R1 = 100
+    put(ri(ADDI,  2, 0, 7));       // 1        R2 = 7
+    put(rr(DIV,   3, 1, 2));       // 2        R3 = 14
+    put(rr(MUL,   5, 1, 2));       // 3        R5 = 700          multiplier beside the divider
+    put(ri(ADDI,  6, 0, 0));       // 4        R6 = 0            independent of both
+    put(ri(ADDI,  7, 0, 10));      // 5        R7 = 10
+    put(rr(ADD,   6, 6, 7));       // 6 loop:  R6 = R6 + R7
+    put(ri(SUBI,  7, 7, 1));       // 7        R7 = R7 - 1
+    put(ri(BNEQZ, 0, 7, -16'd3));  // 8        BNEQZ R7 , loop   R6 = 55
+    put(rr(REM,   4, 1, 2));       // 9        R4 = 2            waits for the divider
+    put(rr(ADD,   8, 3, 4));       // 10       R8 = 16           waits for R4
+    put(rr(DIV,   9, 1, 0));       // 11       R9 = ffffffff     divide by zero
+    put(rr(REM,  10, 1, 0));       // 12       R10 = 100
+    put(ri(SW,    8, 0, 40));      // 13       Mem[40] = 16
+    put(rr(HLT,   0, 0, 0));       // 14       waits until the unit is empty
+
+    #22 reset = 0;
+  end
+
+  initial begin
+    wait (all_halted);
+    #1;
+    check(3, 14); check(4, 2); check(5, 700); check(6, 55); check(7, 0);
+    check(8, 16); check(9, 32'hffffffff); check(10, 100);
+    if (alu.dmem.Mem[40] !== 16 || mdu.dmem.Mem[40] !== 16 || one.dmem.Mem[40] !== 16) begin
+      $display("FAIL Mem[40] : %0d , %0d , %0d", alu.dmem.Mem[40], mdu.dmem.Mem[40], one.dmem.Mem[40]);
+      errors = errors + 1;
+    end
+    if (alu.MDU_PENDING != 0 || mdu.MDU_PENDING != 0) begin
+      $display("FAIL scoreboard not empty at HALTED : %h , %h", alu.MDU_PENDING, mdu.MDU_PENDING);
+      errors = errors + 1;
+    end
+    if (alu.MDU_STALLS >= one.MDU_STALLS || mdu.MDU_STALLS >= one.MDU_STALLS) begin
+      $display("FAIL divide latency not hidden : MDU_STALLS %0d , %0d , single clock %0d",
+               alu.MDU_STALLS, mdu.MDU_STALLS, one.MDU_STALLS);
+      errors = errors + 1;
+    end
+
+    $display("EX multiplier  : CYCLES %0d , RETIRED %0d , MDU_STALLS %0d", alu.CYCLES, alu.RETIRED, alu.MDU_STALLS);
+    $display("MDU multiplier : CYCLES %0d , RETIRED %0d , MDU_STALLS %0d", mdu.CYCLES, mdu.RETIRED, mdu.MDU_STALLS);
+    $display("single clock   : CYCLES %0d , RETIRED %0d , MDU_STALLS %0d", one.CYCLES, one.RETIRED, one.MDU_STALLS);
+    pass_fail;
+  end
+
+  initial watchdog(10000);
+
+endmodule
@@ -0,0 +1,93 @@
+`timescale 1ns / 1ps
+// Out-of-order completion regression : a loop whose load misses every other
+// iteration while a 3-stage multiply and independent ALU ops go on around it ,
+// then a miss , a hit under it , a second miss to the same line and a miss
+// to another line , with consumers of all of them. It runs with ideal DMEM ,
+// through a D-cache that blocks on a miss and through the same cache with
+// OOO_COMPLETE and one or four MSHRs ; all four must end with the same
+// registers and memory , the scoreboard must be empty at HALTED , one MSHR
+// must beat the blocking cache and four MSHRs must stall MEM less than one.
+
+module test_mips32_ooo;
+
+  reg clk1, clk2, reset;
+  integer k;
+
+  `define TB_CORE0 ideal
+  `define TB_CORE1 blk
+  `define TB_CORE2 one
+  `define TB_CORE3 ooo
+  `define TB_CORE_NAMES "ideal , blocking , one MSHR , four MSHRs"
+  `include "mips_tb_common.vh"
+
+  MIPS #(.MUL_LATENCY(3)) ideal (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.MUL_LATENCY(3), .DCACHE(1), .DC_LINE_WORDS(2), .DMEM_LATENCY(8)) blk (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.MUL_LATENCY(3), .DCACHE(1), .DC_LINE_WORDS(2), .DMEM_LATENCY(8), .OOO_COMPLETE(1), .DC_MSHRS(1)) one (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.MUL_LATENCY(3), .DCACHE(1), .DC_LINE_WORDS(2), .DMEM_LATENCY(8), .OOO_COMPLETE(1), .DC_MSHRS(4)) ooo (`MIPS_TB_PORTS(1'b0));
+
+  initial two_phase_clock(1000);
+
+  initial begin
+    reset = 1;
+    start_program;
+    for (k = 0; k < 8; k = k + 1) data(100 + k, k + 1);
+    data(120, 50); data(121, 51); data(130, 60);
+
+    put(ri(ADDI,  1, 0, 100));     // 0        R1 = 100          p
+    put(ri(ADDI,  2, 0, 8));       // 1        R2 = 8            n
+    put(ri(LW,    4, 1, 0));       // 2 loop:  R4 = *p           misses on every new line
+    put(ri(ADDI,  1, 1, 1));       // 3        p++               independent of the load
+    put(rr(MUL,   6, 2, 2));       // 4        R6 = n * n        shares the late write port
+    put(rr(ADD,   7, 7, 6));       // 5        R7 += R6          waits for the multiply
+    put(ri(SUBI,  2, 2, 1));       // 6        n--
+    put(rr(ADD,   3, 3, 4));       // 7        R3 += R4          waits for the load
+    put(ri(BNEQZ, 0, 2, -16'd7));  // 8        BNEQZ R2 , loop   R3 = 36 , R7 = 204
+    put(ri(LW,   10, 0, 120));     // 9        R10 = 50          miss
+    put(ri(LW,   13, 0, 101));     // 10       R13 = 2           hit under the miss
+    put(ri(LW,   15, 0, 121));     // 11       R15 = 51          second target of the same line
+    put(ri(LW,   11, 0, 130));     // 12       R11 = 60          miss to another line
+    put(rr(ADD,  12, 10, 11));     // 13       R12 = 110
+    put(rr(ADD,  16, 13, 15));     // 14       R16 = 53
+    put(ri(SW,    3, 0, 200));     // 15       Mem[200] = 36
+    put(ri(SW,    7, 0, 201));     // 16       Mem[201] = 204
+    put(ri(SW,   12, 0, 202));     // 17       Mem[202] = 110
+    put(ri(SW,   16, 0, 203));     // 18       Mem[203] = 53
+    put(rr(HLT,   0, 0, 0));       // 19
+
+    #22 reset = 0;
+  end
+
+  initial begin
+    wait (all_halted && blk.MEM_SYNCED === 1 && one.MEM_SYNCED === 1 && ooo.MEM_SYNCED === 1);
+    #1;
+    check(1, 108); check(2, 0); check(3, 36); check(7, 204); check(10, 50); check(11, 60); check(12, 110);
+    check(13, 2); check(15, 51); check(16, 53);
+    check_mem(200, 36); check_mem(201, 204); check_mem(202, 110); check_mem(203, 53);
+    if (one.MDU_PENDING != 0 || one.LM_PENDING != 0 || ooo.MDU_PENDING != 0 || ooo.LM_PENDING != 0) begin
+      $display("FAIL scoreboard not empty at HALTED : %h %h , %h %h", one.MDU_PENDING, one.LM_PENDING,
+               ooo.MDU_PENDING, ooo.LM_PENDING);
+      errors = errors + 1;
+    end
+    if (one.RETIRED != blk.RETIRED || one.CYCLES >= blk.CYCLES || one.MEM_STALLS >= blk.MEM_STALLS) begin
+      $display("FAIL nothing completed out of order : blocking %0d cycles / %0d MEM stalls , 1 MSHR %0d / %0d",
+               blk.CYCLES, blk.MEM_STALLS, one.CYCLES, one.MEM_STALLS);
+      errors = errors + 1;
+    end
+    if (ooo.RETIRED != one.RETIRED || ooo.CYCLES > one.CYCLES || ooo.MEM_STALLS >= one.MEM_STALLS) begin
+      $display("FAIL no miss overlap : 1 MSHR %0d cycles / %0d MEM stalls , 4 MSHRs %0d / %0d",
+               one.CYCLES, one.MEM_STALLS, ooo.CYCLES, ooo.MEM_STALLS);
+      errors = errors + 1;
+    end
+
+    $display("ideal DMEM : CYCLES %0d , RETIRED %0d", ideal.CYCLES, ideal.RETIRED);
+    $display("blocking   : CYCLES %0d , MEM_STALLS %0d , %0d misses", blk.CYCLES, blk.MEM_STALLS, blk.dcache.MISSES);
+    $display("1 MSHR     : CYCLES %0d , MEM_STALLS %0d , MDU_STALLS %0d , %0d misses",
+             one.CYCLES, one.MEM_STALLS, one.MDU_STALLS, one.dcache.MISSES);
+    $display("4 MSHRs    : CYCLES %0d , MEM_STALLS %0d , MDU_STALLS %0d , %0d misses",
+             ooo.CYCLES, ooo.MEM_STALLS, ooo.MDU_STALLS, ooo.dcache.MISSES);
+    pass_fail;
+  end
+
+  initial watchdog(20000);
+
+endmodule
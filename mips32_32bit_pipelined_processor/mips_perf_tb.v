@@ -0,0 +1,87 @@
+`timescale 1ns / 1ps
+// Performance counter regression : a short loop followed by a store into the
+// counter range and three counter loads , on MIPS and MIPS_1clk. The loads
+// must see the counters , the store must not reach DMEM (Mem[768] aliases the
+// counter range) and at HALTED CYCLES / RETIRED / BRANCH_FLUSHES must match
+// what the testbench counted.
+
+module test_mips32_perf;
+
+  reg clk1, clk2, clk, reset;
+  integer cyc_2ph, cyc_1clk;
+
+  `define TB_CORE0 two
+  `define TB_CORE1 one
+  `define TB_CORE_NAMES "two-phase , single clock"
+  `include "mips_tb_common.vh"
+
+  MIPS      two  (`MIPS_TB_PORTS(1'b0));
+  MIPS_1clk one  (clk, reset, 1'b0);
+
+  task expect;
+    input [8*24-1:0] what; input [31:0] got, expected;
+    if (got !== expected) begin
+      $display("FAIL %s : %0d , expected %0d", what, got, expected);
+      errors = errors + 1;
+    end
+  endtask
+
+  initial two_phase_clock(100);
+
+  initial begin
+    clk = 0;
+    repeat (200) #5 clk = ~clk;
+  end
+
+  initial begin
+    reset = 1;
+    start_program;
+    data(768, 32'hdeadbeef);
+
+    put(ri(ADDI,  1, 0, 3));       // 0        R1 = 3
+    put(ri(SUBI,  1, 1, 1));       // 1 loop:  R1 = R1 - 1
+    put(ri(BNEQZ, 0, 1, -16'd2));  // 2        BNEQZ R1 , loop
+    put(ri(SW,    1, 0, -16'd256));// 3        store to CYCLES : dropped
+    put(ri(LW,    2, 0, -16'd256));// 4        R2 = CYCLES
+    put(ri(LW,    3, 0, -16'd255));// 5        R3 = RETIRED
+    put(ri(LW,    4, 0, -16'd254));// 6        R4 = BRANCH_FLUSHES
+    put(rr(HLT,   0, 0, 0));       // 7
+
+    #22 reset = 0;
+  end
+
+  initial begin cyc_2ph = 0; cyc_1clk = 0; end
+  always @(posedge clk1) if (two.HALTED == 0 && reset == 0) cyc_2ph = cyc_2ph + 1;
+  always @(posedge clk)  if (one.HALTED == 0 && reset == 0) cyc_1clk = cyc_1clk + 1;
+
+  initial begin
+    wait (all_halted);
+    #1;
+    expect("two CYCLES", two.CYCLES, cyc_2ph);
+    expect("two RETIRED", two.RETIRED, 12);
+    expect("two BRANCH_FLUSHES", two.BRANCH_FLUSHES, two.BP_BRANCHES - two.BP_HITS);
+    expect("one CYCLES", one.CYCLES, cyc_1clk);
+    expect("one RETIRED", one.RETIRED, 12);
+    expect("one BRANCH_FLUSHES", one.BRANCH_FLUSHES, 2);
+    // counter loads : RETIRED counts the instructions already through WB ,
+    // which on the single-clock core excludes the one retiring alongside MEM
+    expect("two LW RETIRED", two.Reg[3], 9);
+    expect("one LW RETIRED", one.Reg[3], 8);
+    expect("two LW BRANCH_FLUSHES", two.Reg[4], 2);
+    expect("one LW BRANCH_FLUSHES", one.Reg[4], 2);
+    if (two.Reg[2] == 0 || two.Reg[2] >= two.CYCLES || one.Reg[2] == 0 || one.Reg[2] >= one.CYCLES) begin
+      $display("FAIL LW CYCLES : %0d / %0d , %0d / %0d", two.Reg[2], two.CYCLES, one.Reg[2], one.CYCLES);
+      errors = errors + 1;
+    end
+    check_mem(768, 32'hdeadbeef);
+
+    $display("two-phase    : CYCLES %0d , RETIRED %0d , CPI %0.2f , BRANCH_FLUSHES %0d , STALL_CYCLES %0d",
+             two.CYCLES, two.RETIRED, two.CYCLES * 1.0 / two.RETIRED, two.BRANCH_FLUSHES, two.STALL_CYCLES);
+    $display("single clock : CYCLES %0d , RETIRED %0d , CPI %0.2f , BRANCH_FLUSHES %0d , STALL_CYCLES %0d",
+             one.CYCLES, one.RETIRED, one.CYCLES * 1.0 / one.RETIRED, one.BRANCH_FLUSHES, one.STALL_CYCLES);
+    pass_fail;
+  end
+
+  initial watchdog(2000);
+
+endmodule
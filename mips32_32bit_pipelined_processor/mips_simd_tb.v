@@ -0,0 +1,105 @@
+`timescale 1ns / 1ps
+// Packed SIMD regression : every packed op on two operand words with carries
+// , saturation and equal / unequal lanes , and a 32-byte checksum done twice
+// , a byte per word with LW / ADD and four bytes per word with LW / SUMB. It
+// runs on MIPS , MIPS with DUAL_ISSUE and MIPS_1clk ; the CYCLES counter read
+// around each loop must show the packed one at least three times faster.
+
+module test_mips32_simd;
+
+  reg clk1, clk2, clk, reset;
+  integer k;
+
+  `define TB_CORE0 two
+  `define TB_CORE1 dual
+  `define TB_CORE2 one
+  `define TB_CORE_NAMES "two-phase , dual , single clock"
+  `define TB_HEX
+  `include "mips_tb_common.vh"
+
+  MIPS                    two  (`MIPS_TB_PORTS(1'b0));
+  MIPS #(.DUAL_ISSUE(1))  dual (`MIPS_TB_PORTS(1'b0));
+  MIPS_1clk               one  (clk, reset, 1'b0);
+
+  initial two_phase_clock(600);
+
+  initial begin
+    clk = 0;
+    repeat (1200) #5 clk = ~clk;
+  end
+
+  initial begin
+    reset = 1;
+    start_program;
+    for (k = 0; k < 32; k = k + 1) data(k, 8 * k);    // bytes 0x00 , 0x08 .. 0xf8 , one per word
+    data(32, 32'h18100800); data(33, 32'h38302820); data(34, 32'h58504840); data(35, 32'h78706860);   // packed
+    data(36, 32'h98908880); data(37, 32'hb8b0a8a0); data(38, 32'hd8d0c8c0); data(39, 32'hf8f0e8e0);
+    data(50, 32'h80ff1002); data(51, 32'h80011003);
+
+    put(ri(LW,   20, 0, -16'd256)); // 0        R20 = CYCLES
+    put(ri(ADDI,  1, 0, 0));        // 1        p = 0
+    put(ri(ADDI,  2, 0, 32));       // 2        n = 32
+    put(ri(ADDI,  3, 0, 0));        // 3        R3 = 0
+    put(ri(LW,    4, 1, 0));        // 4 byte:  R4 = *p
+    put(rr(ADD,   3, 3, 4));        // 5        R3 += R4
+    put(ri(ADDI,  1, 1, 1));        // 6        p++
+    put(ri(SUBI,  2, 2, 1));        // 7        n--
+    put(ri(BNEQZ, 0, 2, -16'd5));   // 8        BNEQZ R2 , byte   R3 = 3968
+    put(ri(LW,   21, 0, -16'd256)); // 9        R21 = CYCLES
+    put(ri(ADDI,  1, 0, 32));       // 10       p = 32
+    put(ri(ADDI,  2, 0, 8));        // 11       n = 8
+    put(ri(ADDI,  5, 0, 0));        // 12       R5 = 0
+    put(ri(LW,    4, 1, 0));        // 13 word: R4 = *p
+    put(rr(SUMB,  5, 4, 5));        // 14       R5 += bytes of R4
+    put(ri(ADDI,  1, 1, 1));        // 15       p++
+    put(ri(SUBI,  2, 2, 1));        // 16       n--
+    put(ri(BNEQZ, 0, 2, -16'd5));   // 17       BNEQZ R2 , word   R5 = 3968
+    put(ri(LW,   22, 0, -16'd256)); // 18       R22 = CYCLES
+    put(ri(LW,    6, 0, 50));       // 19       R6 = 80ff1002
+    put(ri(LW,    7, 0, 51));       // 20       R7 = 80011003
+    put(rr(ADDB,  8, 6, 7));        // 21       R8 = 00002005     lanes wrap
+    put(rr(SUBB,  9, 6, 7));        // 22       R9 = 00fe00ff
+    put(rr(ADDH, 10, 6, 7));        // 23       R10 = 01002005
+    put(rr(SUBH, 11, 6, 7));        // 24       R11 = 00feffff
+    put(rr(ADDUSB, 12, 6, 7));      // 25       R12 = ffff2005    lanes saturate
+    put(rr(ADDUSH, 13, 6, 7));      // 26       R13 = ffff2005
+    put(rr(CMPEQB, 14, 6, 7));      // 27       R14 = ff00ff00
+    put(rr(CMPEQH, 15, 6, 6));      // 28       R15 = ffffffff
+    put(rr(CMPLTB, 16, 6, 7));      // 29       R16 = 000000ff
+    put(rr(CMPLTH, 17, 6, 7));      // 30       R17 = 0000ffff
+    put(rr(SUMB, 18, 6, 7));        // 31       R18 = 80011003 + 0x80 + 0xff + 0x10 + 0x02
+    put(rr(SUB,  23, 21, 20));      // 32       R23 = scalar loop cycles
+    put(rr(SUB,  24, 22, 21));      // 33       R24 = packed loop cycles
+    put(ri(SW,    3, 0, 60));       // 34       Mem[60] = 3968
+    put(ri(SW,    5, 0, 61));       // 35       Mem[61] = 3968
+    put(rr(HLT,   0, 0, 0));        // 36
+
+    #22 reset = 0;
+  end
+
+  initial begin
+    wait (all_halted);
+    #1;
+    check(3, 3968); check(5, 3968);
+    check(8, 32'h00002005); check(9, 32'h00fe00ff); check(10, 32'h01002005); check(11, 32'h00feffff);
+    check(12, 32'hffff2005); check(13, 32'hffff2005); check(14, 32'hff00ff00); check(15, 32'hffffffff);
+    check(16, 32'h000000ff); check(17, 32'h0000ffff); check(18, 32'h80011003 + 32'h80 + 32'hff + 32'h10 + 32'h02);
+    if (two.dmem.Mem[60] !== 3968 || two.dmem.Mem[61] !== 3968 || one.dmem.Mem[60] !== 3968 || one.dmem.Mem[61] !== 3968) begin
+      $display("FAIL Mem[60..61] : two-phase %0d %0d , single clock %0d %0d",
+               two.dmem.Mem[60], two.dmem.Mem[61], one.dmem.Mem[60], one.dmem.Mem[61]);
+      errors = errors + 1;
+    end
+    if (two.Reg[23] < 3 * two.Reg[24] || dual.Reg[23] < 3 * dual.Reg[24] || one.Reg[23] < 3 * one.Reg[24]) begin
+      $display("FAIL packed loop not 3x faster : two-phase %0d / %0d , dual %0d / %0d , single clock %0d / %0d",
+               two.Reg[23], two.Reg[24], dual.Reg[23], dual.Reg[24], one.Reg[23], one.Reg[24]);
+      errors = errors + 1;
+    end
+
+    $display("checksum cycles , byte per word / SUMB : two-phase %0d / %0d , dual %0d / %0d , single clock %0d / %0d",
+             two.Reg[23], two.Reg[24], dual.Reg[23], dual.Reg[24], one.Reg[23], one.Reg[24]);
+    pass_fail;
+  end
+
+  initial watchdog(12000);
+
+endmodule
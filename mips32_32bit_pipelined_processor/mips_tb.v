@@ -1,10 +1,13 @@
 module test_mips32;
 
-  reg clk1, clk2;
+  reg clk1, clk2, reset;
   integer k;
 
-  // Instantiate the MIPS processor module
-  pipe_MIPS32 mips (clk1, clk2);
+  // Instantiate the MIPS processor module , with no interrupt and the unused
+  // AXI port idle
+  MIPS mips (.clk1(clk1), .clk2(clk2), .reset(reset), .irq(1'b0),
+    .M_AXI_ARREADY(1'b0), .M_AXI_RDATA(32'd0), .M_AXI_RRESP(2'b00), .M_AXI_RLAST(1'b0), .M_AXI_RVALID(1'b0),
+    .M_AXI_AWREADY(1'b0), .M_AXI_WREADY(1'b0), .M_AXI_BRESP(2'b00), .M_AXI_BVALID(1'b0));
 
   // Generate two-phase clock
   initial begin
@@ -20,24 +23,23 @@ module test_mips32;
     for (k = 0; k < 31; k = k + 1)
       mips.Reg[k] = k;
 
-    mips.Mem[0] = 32'h2801000a; // ADDI R1, R0, 10
-    mips.Mem[1] = 32'h28020014; // ADDI R2, R0, 20
-    mips.Mem[2] = 32'h28030019; // ADDI R3, R0, 25
-    mips.Mem[3] = 32'h0ce77800; // OR R7, R7, R7 -- dummy instruction
-    mips.Mem[4] = 32'h0ce77800; // OR R7, R7, R7 -- dummy instruction
-    mips.Mem[5] = 32'h00221800; // ADD R4, R1, R2
-    mips.Mem[6] = 32'h0ce77800; // OR R7, R7, R7 -- dummy instruction
-    mips.Mem[7] = 32'h00832800; // ADD R5, R4, R3
-    mips.Mem[8] = 32'hfc000000; // HLT
+    mips.imem.Mem[0] = 32'h2801000a; // ADDI R1, R0, 10
+    mips.imem.Mem[1] = 32'h28020014; // ADDI R2, R0, 20
+    mips.imem.Mem[2] = 32'h28030019; // ADDI R3, R0, 25
+    mips.imem.Mem[3] = 32'h0ce73800; // OR R7, R7, R7 -- dummy instruction
+    mips.imem.Mem[4] = 32'h0ce73800; // OR R7, R7, R7 -- dummy instruction
+    mips.imem.Mem[5] = 32'h00222000; // ADD R4, R1, R2
+    mips.imem.Mem[6] = 32'h0ce73800; // OR R7, R7, R7 -- dummy instruction
+    mips.imem.Mem[7] = 32'h00832800; // ADD R5, R4, R3
+    mips.imem.Mem[8] = 32'hfc000000; // HLT
   end
 
-  // Reset signals and display results
+  // Reset , then display results once the core halts
   initial begin
-    mips.HALTED = 0;
-    mips.PC = 0;
-    mips.TAKEN_BRANCH = 0;
+    reset = 1;
+    #22 reset = 0;   // after the first clk1 and clk2 edges
 
-    #280
+    wait (mips.HALTED === 1);
     for (k = 0; k < 6; k = k + 1)
       $display("R%1d - %2d", k, mips.Reg[k]);
   end
@@ -46,7 +48,7 @@ module test_mips32;
   initial begin
     $dumpfile("mips.vcd");
     $dumpvars(0, test_mips32);
-    #300 $finish;
+    #400 $finish;
   end
 
-endmodule
\ No newline at end of file
+endmodule
@@ -0,0 +1,226 @@
+// What the mips_*_tb.v regressions share : the opcodes , the instruction
+// encoders , the MIPS port list , the two-phase clock , loading the same
+// program into every core , comparing their registers and memory , waiting
+// for all of them to halt and the PASS / FAIL line. A testbench names its
+// cores (instance names , in order) and their labels before the include :
+//
+//   `define TB_CORE0 two
+//   `define TB_CORE1 one
+//   `define TB_CORE_NAMES "two-phase , single clock"
+//
+// up to TB_CORE6 , and `includes it inside the module after declaring clk1 ,
+// clk2 and reset ; iverilog finds it when run from this directory (or with
+// -I). TB_HEX prints check values in hex. What is left in the testbench is
+// its program and the checks that are its own.
+
+  parameter ADD = 6'b000000, SUB = 6'b000001, AND = 6'b000010, OR = 6'b000011, SLT = 6'b000100, MUL = 6'b000101,
+            DIV = 6'b000110, REM = 6'b000111, LW = 6'b001000, SW = 6'b001001, ADDI = 6'b001010, SUBI = 6'b001011,
+            SLTI = 6'b001100, BNEQZ = 6'b001101, BEQZ = 6'b001110,
+            J = 6'b010000, JAL = 6'b010001, JR = 6'b010010, ERET = 6'b010011,
+            ADDB = 6'b010100, SUBB = 6'b010101, ADDH = 6'b010110, SUBH = 6'b010111, ADDUSB = 6'b011000,
+            ADDUSH = 6'b011001, CMPEQB = 6'b011010, CMPEQH = 6'b011011, CMPLTB = 6'b011100, CMPLTH = 6'b011101,
+            SUMB = 6'b011110, LOOP = 6'b011111, HLT = 6'b111111;
+  parameter STATUS = -16'd245, CAUSE = -16'd244, EPC = -16'd243;   // PERF_BASE + 11 .. 13 , as LW / SW offsets from R0
+
+  // port list of a MIPS instance without the AXI port (DMEM_AXI = 0) : its
+  // M_AXI_* inputs are held idle and irq is the given signal or 1'b0 , so
+  // neither floats to Z and turns the trap logic X
+  `define MIPS_TB_PORTS(irq_in) .clk1(clk1), .clk2(clk2), .reset(reset), .irq(irq_in), \
+    .M_AXI_ARREADY(1'b0), .M_AXI_RDATA(32'd0), .M_AXI_RRESP(2'b00), .M_AXI_RLAST(1'b0), .M_AXI_RVALID(1'b0), \
+    .M_AXI_AWREADY(1'b0), .M_AXI_WREADY(1'b0), .M_AXI_BRESP(2'b00), .M_AXI_BVALID(1'b0)
+
+  function [31:0] rr;  // rd <- rs op rt , JR rs
+    input [5:0] op; input [4:0] rd, rs, rt;
+    rr = {op, rs, rt, rd, 11'b0};
+  endfunction
+
+  function [31:0] ri;   // rt <- rs op imm , LW/SW rt, imm(rs) , branch / LOOP on rs to NPC + imm
+    input [5:0] op; input [4:0] rt, rs; input [15:0] imm;
+    ri = {op, rs, rt, imm};
+  endfunction
+
+  function [31:0] jj;   // J / JAL to {NPC[31:26] , target}
+    input [5:0] op; input [25:0] target;
+    jj = {op, target};
+  endfunction
+
+  // periods of clk1 then clk2 , 20 ns each ; started from an initial block
+  task two_phase_clock;
+    input integer periods;
+    begin
+      clk1 = 0; clk2 = 0;
+      repeat (periods) begin
+        #5 clk1 = 1;  #5 clk1 = 0;
+        #5 clk2 = 1;  #5 clk2 = 0;
+      end
+    end
+  endtask
+
+  integer n;        // next IMEM word put() writes
+  integer errors;
+
+  // every core halted ; the testbench waits on it , then checks
+  wire all_halted = `TB_CORE0.HALTED === 1
+`ifdef TB_CORE1 && `TB_CORE1.HALTED === 1 `endif
+`ifdef TB_CORE2 && `TB_CORE2.HALTED === 1 `endif
+`ifdef TB_CORE3 && `TB_CORE3.HALTED === 1 `endif
+`ifdef TB_CORE4 && `TB_CORE4.HALTED === 1 `endif
+`ifdef TB_CORE5 && `TB_CORE5.HALTED === 1 `endif
+`ifdef TB_CORE6 && `TB_CORE6.HALTED === 1 `endif
+    ;
+
+  // empty program , no errors , every register 0 ; call it first , with reset high
+  task start_program;
+    integer r;
+    begin
+      n = 0; errors = 0;
+      for (r = 0; r < 32; r = r + 1) begin
+        `TB_CORE0.Reg[r] = 0;
+`ifdef TB_CORE1 `TB_CORE1.Reg[r] = 0; `endif
+`ifdef TB_CORE2 `TB_CORE2.Reg[r] = 0; `endif
+`ifdef TB_CORE3 `TB_CORE3.Reg[r] = 0; `endif
+`ifdef TB_CORE4 `TB_CORE4.Reg[r] = 0; `endif
+`ifdef TB_CORE5 `TB_CORE5.Reg[r] = 0; `endif
+`ifdef TB_CORE6 `TB_CORE6.Reg[r] = 0; `endif
+      end
+    end
+  endtask
+
+  // next program word , into every core's IMEM
+  task put;
+    input [31:0] ir;
+    begin
+      `TB_CORE0.imem.Mem[n] = ir;
+`ifdef TB_CORE1 `TB_CORE1.imem.Mem[n] = ir; `endif
+`ifdef TB_CORE2 `TB_CORE2.imem.Mem[n] = ir; `endif
+`ifdef TB_CORE3 `TB_CORE3.imem.Mem[n] = ir; `endif
+`ifdef TB_CORE4 `TB_CORE4.imem.Mem[n] = ir; `endif
+`ifdef TB_CORE5 `TB_CORE5.imem.Mem[n] = ir; `endif
+`ifdef TB_CORE6 `TB_CORE6.imem.Mem[n] = ir; `endif
+      n = n + 1;
+    end
+  endtask
+
+  // DMEM word a = v in every core
+  task data;
+    input [31:0] a, v;
+    begin
+      `TB_CORE0.dmem.Mem[a] = v;
+`ifdef TB_CORE1 `TB_CORE1.dmem.Mem[a] = v; `endif
+`ifdef TB_CORE2 `TB_CORE2.dmem.Mem[a] = v; `endif
+`ifdef TB_CORE3 `TB_CORE3.dmem.Mem[a] = v; `endif
+`ifdef TB_CORE4 `TB_CORE4.dmem.Mem[a] = v; `endif
+`ifdef TB_CORE5 `TB_CORE5.dmem.Mem[a] = v; `endif
+`ifdef TB_CORE6 `TB_CORE6.dmem.Mem[a] = v; `endif
+    end
+  endtask
+
+  // one value per core on the current line , " , " between them
+  task show;
+    input [31:0] v; input first;
+    begin
+      if (!first) $write(" , ");
+`ifdef TB_HEX
+      $write("%h", v);
+`else
+      $write("%0d", v);
+`endif
+    end
+  endtask
+
+  task mismatch_end;
+    input [31:0] expected;
+    begin
+`ifdef TB_HEX
+      $display(" , expected %h (%s)", expected, `TB_CORE_NAMES);
+`else
+      $display(" , expected %0d (%s)", expected, `TB_CORE_NAMES);
+`endif
+      errors = errors + 1;
+    end
+  endtask
+
+  // register r must hold expected on every core
+  task check;
+    input [4:0] r; input [31:0] expected;
+    begin
+      if (`TB_CORE0.Reg[r] !== expected
+`ifdef TB_CORE1 || `TB_CORE1.Reg[r] !== expected `endif
+`ifdef TB_CORE2 || `TB_CORE2.Reg[r] !== expected `endif
+`ifdef TB_CORE3 || `TB_CORE3.Reg[r] !== expected `endif
+`ifdef TB_CORE4 || `TB_CORE4.Reg[r] !== expected `endif
+`ifdef TB_CORE5 || `TB_CORE5.Reg[r] !== expected `endif
+`ifdef TB_CORE6 || `TB_CORE6.Reg[r] !== expected `endif
+          ) begin
+        $write("FAIL R%0d : ", r);
+        show(`TB_CORE0.Reg[r], 1);
+`ifdef TB_CORE1 show(`TB_CORE1.Reg[r], 0); `endif
+`ifdef TB_CORE2 show(`TB_CORE2.Reg[r], 0); `endif
+`ifdef TB_CORE3 show(`TB_CORE3.Reg[r], 0); `endif
+`ifdef TB_CORE4 show(`TB_CORE4.Reg[r], 0); `endif
+`ifdef TB_CORE5 show(`TB_CORE5.Reg[r], 0); `endif
+`ifdef TB_CORE6 show(`TB_CORE6.Reg[r], 0); `endif
+        mismatch_end(expected);
+      end
+    end
+  endtask
+
+  // DMEM word a must hold expected on every core
+  task check_mem;
+    input [31:0] a, expected;
+    begin
+      if (`TB_CORE0.dmem.Mem[a] !== expected
+`ifdef TB_CORE1 || `TB_CORE1.dmem.Mem[a] !== expected `endif
+`ifdef TB_CORE2 || `TB_CORE2.dmem.Mem[a] !== expected `endif
+`ifdef TB_CORE3 || `TB_CORE3.dmem.Mem[a] !== expected `endif
+`ifdef TB_CORE4 || `TB_CORE4.dmem.Mem[a] !== expected `endif
+`ifdef TB_CORE5 || `TB_CORE5.dmem.Mem[a] !== expected `endif
+`ifdef TB_CORE6 || `TB_CORE6.dmem.Mem[a] !== expected `endif
+          ) begin
+        $write("FAIL Mem[%0d] : ", a);
+        show(`TB_CORE0.dmem.Mem[a], 1);
+`ifdef TB_CORE1 show(`TB_CORE1.dmem.Mem[a], 0); `endif
+`ifdef TB_CORE2 show(`TB_CORE2.dmem.Mem[a], 0); `endif
+`ifdef TB_CORE3 show(`TB_CORE3.dmem.Mem[a], 0); `endif
+`ifdef TB_CORE4 show(`TB_CORE4.dmem.Mem[a], 0); `endif
+`ifdef TB_CORE5 show(`TB_CORE5.dmem.Mem[a], 0); `endif
+`ifdef TB_CORE6 show(`TB_CORE6.dmem.Mem[a], 0); `endif
+        mismatch_end(expected);
+      end
+    end
+  endtask
+
+  // give up after ns , naming the cores still running ; started from an initial block
+  task watchdog;
+    input integer ns;
+    begin
+      #ns $write("FAIL : timeout , HALTED %b", `TB_CORE0.HALTED);
+`ifdef TB_CORE1 $write(" %b", `TB_CORE1.HALTED); `endif
+`ifdef TB_CORE2 $write(" %b", `TB_CORE2.HALTED); `endif
+`ifdef TB_CORE3 $write(" %b", `TB_CORE3.HALTED); `endif
+`ifdef TB_CORE4 $write(" %b", `TB_CORE4.HALTED); `endif
+`ifdef TB_CORE5 $write(" %b", `TB_CORE5.HALTED); `endif
+`ifdef TB_CORE6 $write(" %b", `TB_CORE6.HALTED); `endif
+      $display(" (%s)", `TB_CORE_NAMES);
+      $finish;
+    end
+  endtask
+
+  task pass_fail;
+    begin
+      if (errors == 0) $display("PASS");
+      else $display("FAIL : %0d mismatches", errors);
+      $finish;
+    end
+  endtask
+
+  // the core list is spent , a later testbench in the same compile sets its own
+  `undef TB_CORE0
+  `ifdef TB_CORE1 `undef TB_CORE1 `endif
+  `ifdef TB_CORE2 `undef TB_CORE2 `endif
+  `ifdef TB_CORE3 `undef TB_CORE3 `endif
+  `ifdef TB_CORE4 `undef TB_CORE4 `endif
+  `ifdef TB_CORE5 `undef TB_CORE5 `endif
+  `ifdef TB_CORE6 `undef TB_CORE6 `endif
+  `undef TB_CORE_NAMES
+  `ifdef TB_HEX `undef TB_HEX `endif
@@ -0,0 +1,11 @@
+# nested loop kernel : R2 = sum over 5 passes of 10..1 = 275 , stored to Mem[200]
+        ADDI  R3, R0, 5         # outer count
+        ADDI  R2, R0, 0         # sum
+outer:  ADDI  R1, R0, 10        # inner count
+inner:  ADD   R2, R2, R1
+        SUBI  R1, R1, 1
+        BNEQZ R1, inner
+        SUBI  R3, R3, 1
+        BNEQZ R3, outer
+        SW    R2, 200(R0)
+        HLT
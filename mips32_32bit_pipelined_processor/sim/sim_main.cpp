@@ -0,0 +1,542 @@
+// Verilator harness for MIPS / MIPS_1clk.
+//
+//   V<top> +IMEM=prog.hex [+DMEM=data.hex] [--max-cycles N] [--mem A:N]
+//          [--check [--imem-depth N] [--dmem-depth N]] [--irq CYCLE ...]
+//          [--trace FILE] [--max-instructions N] [--warmup N]
+//          [--save FILE] [--restore FILE]
+//
+// The program image is loaded by IMEM / DMEM themselves from the plusargs.
+// The core is held in reset over one clock, then run until HALTED (or the
+// cycle limit). The registers are dumped, plus N data words from A for each
+// --mem given, then the performance counters of the core, followed by cycles,
+// retired instructions and simulation speed.
+// A cycle is one clk1/clk2 period for MIPS and one clk period for MIPS_1clk.
+// With --check the ISS (tools/iss.cpp) runs the same images in lock step :
+// every instruction leaving WB must be the one the ISS executes next and
+// leave the same value in its destination register (a counter read is taken
+// from the RTL) , and after HALTED the
+// whole data memory must match (with DCACHE , once MEM_SYNCED). An MDU slot
+// (MUL / DIV / REM in the multiply / divide unit of MIPS) leaves WB before its
+// result is written , its register is compared once the scoreboard bit clears.
+// Load misses under OOO_COMPLETE are such slots too. A pair (MIPS
+// DUAL_ISSUE) leaves WB together , first slot first.
+// --irq pulses the irq input for the one cycle CYCLE (counted from the end
+// of reset , repeat it for more). A trap is checked too : a reserved
+// instruction by the ISS trapping in the same place , an interrupt by the
+// ISS taking it (Iss::interrupt) behind the instruction the core took it
+// behind.
+// --trace writes the commit trace of tools/trace.h , a few bytes per cycle :
+// what IF , ID , EX and MEM work on , the stall , flush and trap reasons the
+// counters moved on , and each instruction leaving WB with its register
+// value. tools/mips_trace prints pipeline diagrams and hotspots from it.
+// --restore starts from a checkpoint (tools/checkpoint.h , e.g. from
+// mips_iss --save) instead of PC 0 : after reset the memories , registers ,
+// PC , the trap and the loop registers are set from it , +IMEM / +DMEM
+// are not needed , --imem-depth / --dmem-depth must be the core's. With
+// --check the ISS starts from it too. The counters count from the restore.
+// --max-instructions stops the run after N retired instructions like
+// --max-cycles does after N cycles. With --save the pipeline is drained
+// there first (ID takes no more instructions , the ones in flight retire , a
+// D-cache is flushed) and a checkpoint of where it stopped , or of the
+// halted core , is written ; with --check it must match the ISS's.
+// --warmup N also prints cycles and CPI from the N-th retired instruction on
+// , for a sample that leaves out the cold caches and predictors.
+// The exit status is 0 only when the core halted or stopped for --save (and
+// --check found nothing).
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "checkpoint.h"
+#include "hexfile.h"
+#include "iss.h"
+#include "trace.h"
+#include "verilated.h"
+
+#if defined(TOP_MIPS_1clk)
+#include "VMIPS_1clk.h"
+#include "VMIPS_1clk___024root.h"
+typedef VMIPS_1clk Top;
+#define SIG(name) rootp->MIPS_1clk__DOT__##name
+#else
+#include "VMIPS.h"
+#include "VMIPS___024root.h"
+typedef VMIPS Top;
+#define SIG(name) rootp->MIPS__DOT__##name
+#endif
+
+static const unsigned NOP_TYPE = 6;   // TYPE code of a bubble
+static const unsigned MDU_TYPE = 7;   // TYPE code of a slot finished by the MDU
+
+struct Tracer;
+struct Drain;
+
+// One cycle. Returns the number of instructions (*ir , then *ir2) that left
+// WB on it.
+static int tick(Top *top, uint32_t *ir = nullptr, uint32_t *ir2 = nullptr, Tracer *tr = nullptr,
+                Drain *dr = nullptr);
+
+// COMMIT TRACE (--trace). begin() samples before the cycle , middle()
+// between clk1 and clk2 (MIPS) , end() after it and writes the record. The
+// WB PC is the one MEM worked on the cycle before.
+struct Tracer {
+    mips::TraceWriter out;
+    mips::TraceCycle c;
+    uint32_t count[6] = {};     // STALL_CYCLES , MDU_STALLS , MEM_STALLS , FETCH_STALLS , BRANCH_FLUSHES , TRAPS
+    uint32_t mem_pc = 0;        // MEM's instruction , in WB next cycle
+    bool fetch_wait = false;    // IF retries its PC (I-cache miss)
+    bool id_new = false, mem_busy = false;
+    uint32_t ex_pc = 0;         // MIPS_1clk : EX's instruction , in MEM next cycle
+    bool ex_valid = false, hold = false, div_stall = false;
+
+    void counters(Top *top, uint32_t *n) {
+        n[0] = top->SIG(STALL_CYCLES);
+        n[1] = top->SIG(MDU_STALLS);
+        n[4] = top->SIG(BRANCH_FLUSHES);
+        n[5] = top->SIG(TRAPS);
+#if !defined(TOP_MIPS_1clk)
+        n[2] = top->SIG(MEM_STALLS);
+        n[3] = top->SIG(FETCH_STALLS);
+#endif
+    }
+    void begin(Top *top) {
+        c = mips::TraceCycle();
+        counters(top, count);
+        c.retired = 0;
+        if (top->SIG(MEM_WB_TYPE) != NOP_TYPE) slot(top->SIG(MEM_WB_IR), mem_pc, top->SIG(MEM_WB_TYPE) == MDU_TYPE);
+#if !defined(TOP_MIPS_1clk)
+        if (top->SIG(MEM_WB_TYPE2) != NOP_TYPE) slot(top->SIG(MEM_WB_IR2), mem_pc + 1, false);
+        c.valid[mips::ST_IF] = top->SIG(FETCH_GO);
+        c.pc[mips::ST_IF] = top->SIG(FETCH_PC);
+        c.held[mips::ST_IF] = fetch_wait;
+        fetch_wait = top->SIG(FETCH_GO) && !top->SIG(FETCH_READY);
+        c.valid[mips::ST_EX] = top->SIG(ID_EX_TYPE) != NOP_TYPE;
+        c.pc[mips::ST_EX] = top->SIG(ID_EX_NPC) - 1;
+        c.held[mips::ST_EX] = top->SIG(MEM_BUSY);
+        id_new = top->SIG(FETCH_GO) && (top->SIG(FQ_FLUSH) || !top->SIG(HAZARD_STALL));
+        mem_busy = top->SIG(MEM_BUSY);
+        c.flush_pc = top->SIG(RESOLVE_NPC) - 1;
+#else
+        c.valid[mips::ST_IF] = !top->SIG(HALTED) && !top->SIG(FETCH_STOP) && !top->SIG(ID_HALT) && !top->SIG(EX_TAKEN) &&
+                               !top->SIG(TRAP);
+        c.pc[mips::ST_IF] = top->SIG(PC);
+        c.held[mips::ST_IF] = c.held[mips::ST_ID] = hold;
+        c.valid[mips::ST_ID] = top->SIG(IF_ID_VALID);
+        c.pc[mips::ST_ID] = top->SIG(IF_ID_NPC) - 1;
+        c.valid[mips::ST_EX] = top->SIG(ID_EX_TYPE) != NOP_TYPE;
+        c.pc[mips::ST_EX] = top->SIG(ID_EX_NPC) - 1;
+        c.held[mips::ST_EX] = div_stall;
+        c.valid[mips::ST_MEM] = ex_valid && top->SIG(EX_MEM_TYPE) != NOP_TYPE;
+        c.pc[mips::ST_MEM] = ex_pc;
+        c.flush_pc = top->SIG(ID_EX_NPC) - 1;
+        mem_pc = ex_pc;
+        ex_valid = c.valid[mips::ST_EX];
+        ex_pc = c.pc[mips::ST_EX];
+        hold = (top->SIG(LOAD_USE) || top->SIG(DIV_STALL)) && !top->SIG(EX_TAKEN) && !top->SIG(TRAP);
+        div_stall = top->SIG(DIV_STALL);
+#endif
+    }
+    void middle(Top *top) {
+#if !defined(TOP_MIPS_1clk)
+        c.valid[mips::ST_ID] = top->SIG(IF_ID_VALID);
+        c.pc[mips::ST_ID] = top->SIG(IF_ID_NPC) - 1;
+        c.held[mips::ST_ID] = !id_new;
+        c.valid[mips::ST_MEM] = top->SIG(EX_MEM_TYPE) != NOP_TYPE;
+        c.pc[mips::ST_MEM] = top->SIG(EX_MEM_NPC) - 1;
+        c.held[mips::ST_MEM] = mem_busy;
+        mem_pc = c.pc[mips::ST_MEM];
+#else
+        (void)top;
+#endif
+    }
+    void end(Top *top) {
+        uint32_t now[6] = {};
+        counters(top, now);
+        const uint8_t reason[6] = {mips::C_HAZARD, mips::C_MDU, mips::C_MEM, mips::C_FETCH, mips::C_FLUSH, mips::C_TRAP};
+        for (int k = 0; k < 6; k++)
+            if (now[k] != count[k]) c.flags |= reason[k];
+        if (c.flags & mips::C_MDU) c.flags &= ~mips::C_HAZARD;   // an MDU wait also counts as a stall cycle
+        for (int k = 0; k < c.retired; k++)
+            if (c.slot[k].dest >= 0) c.slot[k].value = top->SIG(Reg)[c.slot[k].dest];
+        out.write(c);
+    }
+
+private:
+    void slot(uint32_t ir, uint32_t pc, bool late) {
+        mips::TraceSlot &r = c.slot[c.retired++];
+        r.pc = pc;
+        r.ir = ir;
+        r.late = late;
+        r.dest = late ? -1 : mips::dest_of(ir);
+        if (r.dest == 0) r.dest = -1;
+    }
+};
+
+// CHECKPOINTS (--save). pc and loop_count are where the program goes on
+// after the youngest instruction that has left EX : EX_MEM_NEXT and the
+// count it carries , as a trap takes them for EPC (MIPS , after clk1 ;
+// MIPS_1clk , EX_NEXT and EX_LCNT before the edge) ; the trap vector on a
+// trap. With squash set IF_ID is cleared each cycle before ID decodes it , so
+// nothing more starts and the pipeline drains.
+struct Drain {
+    uint32_t pc = 0, loop_count = 0;
+    bool exc = false;       // pc is the vector of a reserved-instruction trap
+    bool squash = false;
+
+    void before(Top *top) {
+#if !defined(TOP_MIPS_1clk)
+        if (top->SIG(TRAP)) {
+            pc = top->SIG(FETCH_PC);
+            loop_count = top->SIG(LP_COUNT);
+            exc = top->SIG(EX_MEM_EXC);
+        }
+#else
+        if (top->SIG(TRAP)) {
+            pc = mips::EXC_VECTOR;
+            loop_count = top->SIG(TRAP_LCNT);
+            exc = top->SIG(MEM_WB_EXC);
+        } else if (top->SIG(ID_EX_TYPE) != NOP_TYPE) {
+            pc = top->SIG(EX_NEXT);
+            loop_count = top->SIG(EX_LCNT);
+            exc = false;
+        }
+        if (squash) {
+            top->SIG(IF_ID_VALID) = 0;
+            top->eval();
+        }
+#endif
+    }
+    void middle(Top *top) {
+#if !defined(TOP_MIPS_1clk)
+        if (top->SIG(EX_MEM_TYPE) != NOP_TYPE) {
+            pc = top->SIG(EX_MEM_NEXT);
+            loop_count = top->SIG(EX_MEM_LOOP) ? top->SIG(EX_MEM_B) : top->SIG(EX_MEM_LCNT);
+            exc = false;
+        }
+        if (squash) {
+            top->SIG(IF_ID_VALID) = 0;
+            top->SIG(IF_ID_VALID2) = 0;
+            top->eval();
+        }
+#else
+        (void)top;
+#endif
+    }
+    // Nothing left in ID_EX .. MEM_WB or the MDU , no trap to take.
+    bool drained(Top *top) const {
+        bool empty = top->SIG(ID_EX_TYPE) == NOP_TYPE && top->SIG(EX_MEM_TYPE) == NOP_TYPE &&
+                     top->SIG(MEM_WB_TYPE) == NOP_TYPE && !top->SIG(ID_EX_EXC) && !top->SIG(EX_MEM_EXC);
+#if !defined(TOP_MIPS_1clk)
+        empty = empty && top->SIG(ID_EX_TYPE2) == NOP_TYPE && top->SIG(EX_MEM_TYPE2) == NOP_TYPE &&
+                top->SIG(MEM_WB_TYPE2) == NOP_TYPE && !top->SIG(MEM_BUSY) &&
+                !(top->SIG(MDU_PENDING) | top->SIG(LM_PENDING));
+#else
+        empty = empty && !top->SIG(MEM_WB_EXC);
+#endif
+        return empty;
+    }
+};
+
+static void restore(Top *top, const mips::Checkpoint &ck) {
+    top->SIG(PC) = ck.pc;
+    for (int r = 0; r < 32; r++) top->SIG(Reg)[r] = ck.reg[r];
+    for (size_t a = 0; a < ck.imem.size(); a++) top->SIG(imem__DOT__Mem)[a] = ck.imem[a];
+    for (size_t a = 0; a < ck.dmem.size(); a++) top->SIG(dmem__DOT__Mem)[a] = ck.dmem[a];
+    top->SIG(STATUS_IE) = (ck.status & mips::STATUS_IE) != 0;
+    top->SIG(STATUS_EXL) = (ck.status & mips::STATUS_EXL) != 0;
+    top->SIG(CAUSE) = ck.cause;
+    top->SIG(EPC) = ck.epc;
+    top->SIG(LOOP_START) = ck.loop_start;
+    top->SIG(LOOP_END) = ck.loop_end;
+    top->SIG(LOOP_COUNT) = ck.loop_count;
+    top->SIG(HALTED) = ck.halted;
+    top->eval();
+}
+
+// The drained (or halted) core as a checkpoint , pc and the loop count from
+// the drain.
+static void save(Top *top, const Drain &drain, bool halted, size_t imem_depth, size_t dmem_depth, mips::Checkpoint &ck) {
+    ck.pc = drain.pc;
+    ck.halted = halted;
+    for (int r = 0; r < 32; r++) ck.reg[r] = top->SIG(Reg)[r];
+    ck.imem.resize(imem_depth);
+    ck.dmem.resize(dmem_depth);
+    for (size_t a = 0; a < imem_depth; a++) ck.imem[a] = top->SIG(imem__DOT__Mem)[a];
+    for (size_t a = 0; a < dmem_depth; a++) ck.dmem[a] = top->SIG(dmem__DOT__Mem)[a];
+    ck.status = (top->SIG(STATUS_IE) ? mips::STATUS_IE : 0) | (top->SIG(STATUS_EXL) ? mips::STATUS_EXL : 0);
+    ck.cause = top->SIG(CAUSE);
+    ck.epc = top->SIG(EPC);
+    ck.loop_start = top->SIG(LOOP_START);
+    ck.loop_end = top->SIG(LOOP_END);
+    ck.loop_count = drain.loop_count;
+}
+
+static int tick(Top *top, uint32_t *ir, uint32_t *ir2, Tracer *tr, Drain *dr) {
+    if (dr) dr->before(top);
+    if (tr) tr->begin(top);
+    int retired = top->SIG(MEM_WB_TYPE) != NOP_TYPE;
+    if (ir) *ir = top->SIG(MEM_WB_IR);
+#if !defined(TOP_MIPS_1clk)
+    retired += top->SIG(MEM_WB_TYPE2) != NOP_TYPE;
+    if (ir2) *ir2 = top->SIG(MEM_WB_IR2);
+#endif
+#if defined(TOP_MIPS_1clk)
+    top->clk = 1; top->eval();
+    top->clk = 0; top->eval();
+#else
+    top->clk1 = 1; top->eval();
+    top->clk1 = 0; top->eval();
+    if (dr) dr->middle(top);
+    if (tr) tr->middle(top);
+    top->clk2 = 1; top->eval();
+    top->clk2 = 0; top->eval();
+#endif
+    if (tr) tr->end(top);
+    return retired;
+}
+
+int main(int argc, char **argv) {
+    uint64_t max_cycles = 10000000, max_instructions = ~0ull, warmup = 0;
+    std::vector<std::pair<long, long>> mem_ranges;   // --mem A:N
+    std::vector<uint64_t> irq_cycles;                 // --irq CYCLE
+    bool check = false;
+    size_t imem_depth = 1024, dmem_depth = 1024;
+    std::string imem_file, dmem_file, trace_file, save_file, restore_file;
+    for (int i = 1; i < argc; i++) {
+        if (!strncmp(argv[i], "+IMEM=", 6)) imem_file = argv[i] + 6;
+        else if (!strncmp(argv[i], "+DMEM=", 6)) dmem_file = argv[i] + 6;
+        else if (!strcmp(argv[i], "--check")) check = true;
+        else if (!strcmp(argv[i], "--imem-depth") && i + 1 < argc) imem_depth = strtoul(argv[++i], nullptr, 0);
+        else if (!strcmp(argv[i], "--dmem-depth") && i + 1 < argc) dmem_depth = strtoul(argv[++i], nullptr, 0);
+        else if (!strcmp(argv[i], "--max-cycles") && i + 1 < argc) max_cycles = strtoull(argv[++i], nullptr, 0);
+        else if (!strcmp(argv[i], "--irq") && i + 1 < argc) irq_cycles.push_back(strtoull(argv[++i], nullptr, 0));
+        else if (!strcmp(argv[i], "--trace") && i + 1 < argc) trace_file = argv[++i];
+        else if (!strcmp(argv[i], "--max-instructions") && i + 1 < argc) max_instructions = strtoull(argv[++i], nullptr, 0);
+        else if (!strcmp(argv[i], "--warmup") && i + 1 < argc) warmup = strtoull(argv[++i], nullptr, 0);
+        else if (!strcmp(argv[i], "--save") && i + 1 < argc) save_file = argv[++i];
+        else if (!strcmp(argv[i], "--restore") && i + 1 < argc) restore_file = argv[++i];
+        else if (!strcmp(argv[i], "--mem") && i + 1 < argc) {
+            long base, words;
+            if (sscanf(argv[++i], "%li:%li", &base, &words) != 2) {
+                fprintf(stderr, "--mem wants ADDR:WORDS\n");
+                return 2;
+            }
+            mem_ranges.push_back({base, words});
+        }
+    }
+    mips::Checkpoint ck;   // --restore
+    if (!restore_file.empty()) {
+        std::string err;
+        if (!mips::load_checkpoint(restore_file, ck, &err)) {
+            fprintf(stderr, "--restore : %s\n", err.c_str());
+            return 2;
+        }
+        if (ck.imem.size() != imem_depth || ck.dmem.size() != dmem_depth) {
+            fprintf(stderr, "--restore : %s has %zu IMEM / %zu DMEM words , --imem-depth / --dmem-depth say %zu / %zu\n",
+                    restore_file.c_str(), ck.imem.size(), ck.dmem.size(), imem_depth, dmem_depth);
+            return 2;
+        }
+    }
+
+    mips::Iss iss(imem_depth, dmem_depth);
+    if (check && !restore_file.empty()) {
+        iss.restore(ck);
+    } else if (check) {
+        std::string err;
+        if (imem_file.empty() || !mips::load_hex(imem_file, iss.imem, &err) ||
+            (!dmem_file.empty() && !mips::load_hex(dmem_file, iss.dmem, &err))) {
+            fprintf(stderr, "--check : %s\n", imem_file.empty() ? "needs +IMEM=" : err.c_str());
+            return 2;
+        }
+    }
+    uint64_t mismatches = 0;
+    std::unique_ptr<Tracer> tracer;
+    if (!trace_file.empty()) {
+        tracer.reset(new Tracer);
+#if defined(TOP_MIPS_1clk)
+        bool opened = tracer->out.open(trace_file, 0);
+#else
+        bool opened = tracer->out.open(trace_file, mips::TRACE_TWO_PHASE);
+#endif
+        if (!opened) {
+            fprintf(stderr, "--trace : cannot write %s\n", trace_file.c_str());
+            return 2;
+        }
+    }
+
+    auto ctx = std::make_unique<VerilatedContext>();
+    ctx->commandArgs(argc, argv);
+    auto top = std::make_unique<Top>(ctx.get());
+
+    struct Expect { mips::Retired r; uint64_t retired; };
+    std::vector<Expect> mdu_expect;   // MDU results not yet written back
+    auto compare = [&](const mips::Retired &r, uint32_t ir, uint64_t cycle, uint64_t n) {
+        if (r.ir != ir || (r.dest >= 0 && top->SIG(Reg)[r.dest] != r.value)) {
+            printf("MISMATCH at cycle %llu , instruction %llu : RTL retired %08x", (unsigned long long)cycle,
+                   (unsigned long long)n, ir);
+            if (r.dest >= 0) printf(" R%d = %08x", r.dest, top->SIG(Reg)[r.dest]);
+            printf(" , ISS pc %u %08x", r.pc, r.ir);
+            if (r.dest >= 0) printf(" R%d = %08x", r.dest, r.value);
+            printf("\n");
+            mismatches++;
+        }
+    };
+
+    top->reset = 1;
+    tick(top.get());
+    top->reset = 0;
+    top->eval();
+    if (!restore_file.empty()) restore(top.get(), ck);
+    std::unique_ptr<Drain> drain;
+    if (!save_file.empty()) {
+        drain.reset(new Drain);
+        drain->pc = ck.pc;
+        drain->loop_count = ck.loop_count;
+    }
+
+    uint64_t cycles = 0, retired = 0;
+    uint64_t warm_cycles = 0, warm_retired = 0;   // where --warmup was reached
+    bool warm = false, stopped = false;
+    auto t0 = std::chrono::steady_clock::now();
+    while (!top->SIG(HALTED) && !ctx->gotFinish()) {
+        if (cycles >= max_cycles || retired >= max_instructions) {
+            if (!drain) break;
+            drain->squash = true;   // stop taking instructions , then save once drained
+        }
+        if (drain && drain->squash && drain->drained(top.get())) {
+            stopped = true;
+            break;
+        }
+        if (warmup && !warm && retired >= warmup) {
+            warm = true;
+            warm_cycles = cycles;
+            warm_retired = retired;
+        }
+        uint32_t ir[2] = {0, 0};
+        bool mdu = top->SIG(MEM_WB_TYPE) == MDU_TYPE;
+        top->irq = 0;
+        for (uint64_t c : irq_cycles) top->irq |= (c == cycles);
+        top->eval();
+#if !defined(TOP_MIPS_1clk)
+        bool interrupt = top->SIG(TRAP) && !top->SIG(EX_MEM_EXC);
+#else
+        bool interrupt = top->SIG(TRAP) && !top->SIG(MEM_WB_EXC);
+#endif
+        int n = tick(top.get(), &ir[0], &ir[1], tracer.get(), drain.get());
+        for (int k = 0; k < n; k++) {
+            retired++;
+            if (check && !mismatches) {
+                mips::Retired r = iss.step();
+                while (r.trap) r = iss.step();
+                if (r.perf && r.dest >= 0) iss.reg[r.dest] = top->SIG(Reg)[r.dest];
+                if (!k && mdu && r.ir == ir[k]) {
+                    if (r.dest > 0) mdu_expect.push_back({r, retired});
+                } else {
+                    compare(r, ir[k], cycles, retired);
+                }
+            }
+        }
+        if (check && !mismatches && interrupt && !iss.interrupt()) {
+            printf("MISMATCH at cycle %llu : RTL took an interrupt , ISS has it masked (STATUS %x)\n",
+                   (unsigned long long)cycles, iss.status);
+            mismatches++;
+        }
+#if !defined(TOP_MIPS_1clk)
+        uint32_t pending = top->SIG(MDU_PENDING) | top->SIG(LM_PENDING);
+        for (size_t k = 0; k < mdu_expect.size();)
+            if (!((pending >> mdu_expect[k].r.dest) & 1)) {
+                compare(mdu_expect[k].r, mdu_expect[k].r.ir, cycles, mdu_expect[k].retired);
+                mdu_expect.erase(mdu_expect.begin() + k);
+            } else {
+                k++;
+            }
+#endif
+        cycles++;
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    bool halted = top->SIG(HALTED);
+#if !defined(TOP_MIPS_1clk)
+    if (stopped) {   // HALTED flushes the D-cache , nothing is left to freeze
+        top->SIG(HALTED) = 1;
+        top->eval();
+    }
+    for (uint64_t n = 0; (halted || stopped) && !top->SIG(MEM_SYNCED) && n < max_cycles; n++) tick(top.get());   // D-cache flush
+#endif
+    mips::Checkpoint out;
+    if (drain && (halted || stopped)) {
+        save(top.get(), *drain, halted, imem_depth, dmem_depth, out);
+        out.retired = ck.retired + retired;
+        out.traps = ck.traps + top->SIG(TRAPS);
+    }
+    if (check && halted && !mismatches) {
+        if (!iss.halted) {
+            printf("MISMATCH : RTL halted , ISS did not after %llu instructions\n", (unsigned long long)iss.retired);
+            mismatches++;
+        }
+        for (size_t a = 0; a < dmem_depth; a++)
+            if (top->SIG(dmem__DOT__Mem)[a] != iss.dmem[a]) {
+                if (mismatches++ < 8) printf("MISMATCH Mem[%zu] : RTL %08x , ISS %08x\n", a, top->SIG(dmem__DOT__Mem)[a], iss.dmem[a]);
+            }
+    }
+
+    if (check && stopped && !mismatches) {
+        if (drain->exc) iss.step();   // the ISS takes a trap on the next step
+        mips::Checkpoint ref;
+        iss.save(ref);
+        for (const std::string &d : mips::checkpoint_diff(out, ref))
+            if (mismatches++ < 8) printf("MISMATCH at the checkpoint : %s (RTL / ISS)\n", d.c_str());
+    }
+
+    for (int r = 0; r < 32; r++)
+        printf("R%-2d = %08x (%d)%s", r, top->SIG(Reg)[r], (int)top->SIG(Reg)[r], (r % 4 == 3) ? "\n" : "   ");
+    for (auto &m : mem_ranges)
+        for (long a = m.first; a < m.first + m.second; a++) {
+            uint32_t w = top->SIG(dmem__DOT__Mem)[a & (dmem_depth - 1)];
+            printf("Mem[%ld] = %08x (%d)\n", a, w, (int)w);
+        }
+
+    // PERFORMANCE COUNTERS , as mapped at PERF_BASE
+    printf("CYCLES %u , RETIRED %u , BRANCH_FLUSHES %u , STALL_CYCLES %u , BP %u / %u , MDU_STALLS %u", top->SIG(CYCLES),
+           top->SIG(RETIRED), top->SIG(BRANCH_FLUSHES), top->SIG(STALL_CYCLES), top->SIG(BP_HITS), top->SIG(BP_BRANCHES),
+           top->SIG(MDU_STALLS));
+#if !defined(TOP_MIPS_1clk)
+    printf(" , MEM_STALLS %u , FETCH_STALLS %u , ISSUE_PAIRS %u , TRAPS %u , LB_HITS %u , FQ_STALLS_HIDDEN %u",
+           top->SIG(MEM_STALLS), top->SIG(FETCH_STALLS), top->SIG(ISSUE_PAIRS), top->SIG(TRAPS), top->SIG(LB_HITS), top->SIG(FQ_STALLS_HIDDEN));
+#else
+    printf(" , TRAPS %u", top->SIG(TRAPS));
+#endif
+    printf("\n");
+    printf("%s after %llu cycles , %llu instructions retired , CPI %.2f\n",
+           halted ? "HALTED" : stopped ? "STOPPED (drained)" : "NOT HALTED",
+           (unsigned long long)cycles, (unsigned long long)retired, retired ? (double)cycles / retired : 0.0);
+    printf("%.3f s , %.0f cycles/s , %.0f instructions/s\n", secs, secs > 0 ? cycles / secs : 0.0,
+           secs > 0 ? retired / secs : 0.0);
+
+    if (warm)
+        printf("after a warm-up of %llu instructions : %llu cycles , %llu instructions , CPI %.2f\n",
+               (unsigned long long)warm_retired, (unsigned long long)(cycles - warm_cycles),
+               (unsigned long long)(retired - warm_retired),
+               retired > warm_retired ? (double)(cycles - warm_cycles) / (retired - warm_retired) : 0.0);
+    if (!restore_file.empty()) printf("restored from %s at instruction %llu\n", restore_file.c_str(), (unsigned long long)ck.retired);
+
+    if (check) printf("lock-step check against the ISS : %s\n", mismatches ? "FAIL" : "PASS");
+
+    if (tracer && !tracer->out.close()) fprintf(stderr, "--trace : write error on %s\n", trace_file.c_str());
+    if (drain && (halted || stopped)) {
+        if (!mips::save_checkpoint(save_file, out)) {
+            fprintf(stderr, "--save : cannot write %s\n", save_file.c_str());
+            top->final();
+            return 2;
+        }
+        printf("checkpoint %s : pc %u after %llu instructions\n", save_file.c_str(), out.pc, (unsigned long long)out.retired);
+    }
+    top->final();
+    return !(halted || stopped) ? 1 : mismatches ? 3 : 0;
+}
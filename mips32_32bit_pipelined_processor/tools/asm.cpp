@@ -0,0 +1,362 @@
+#include "asm.h"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+#include "mips_isa.h"
+
+namespace mips {
+
+namespace {
+
+struct Stmt {
+    int line;
+    bool data;                  // section
+    uint32_t addr;
+    std::string op;             // upper-case mnemonic or directive
+    std::vector<std::string> args;
+    std::string src;
+};
+
+std::string trim(const std::string &s) {
+    size_t b = 0, e = s.size();
+    while (b < e && isspace((unsigned char)s[b])) b++;
+    while (e > b && isspace((unsigned char)s[e - 1])) e--;
+    return s.substr(b, e - b);
+}
+
+std::string upper(std::string s) {
+    for (auto &c : s) c = (char)toupper((unsigned char)c);
+    return s;
+}
+
+bool is_ident_start(char c) { return isalpha((unsigned char)c) || c == '_' || c == '.'; }
+bool is_ident(char c) { return isalnum((unsigned char)c) || c == '_' || c == '.'; }
+
+// drops the comment , honouring 'c' literals
+std::string strip_comment(const std::string &s) {
+    for (size_t i = 0; i < s.size(); i++) {
+        if (s[i] == '\'' && i + 2 < s.size() && s[i + 2] == '\'') { i += 2; continue; }
+        if (s[i] == '#' || s[i] == ';' || (s[i] == '/' && i + 1 < s.size() && s[i + 1] == '/')) return s.substr(0, i);
+    }
+    return s;
+}
+
+std::vector<std::string> split_args(const std::string &s) {
+    std::vector<std::string> out;
+    if (trim(s).empty()) return out;
+    std::string cur;
+    for (size_t i = 0; i < s.size(); i++) {
+        if (s[i] == '\'' && i + 2 < s.size() && s[i + 2] == '\'') { cur += s.substr(i, 3); i += 2; continue; }
+        if (s[i] == ',') { out.push_back(trim(cur)); cur.clear(); }
+        else cur += s[i];
+    }
+    out.push_back(trim(cur));
+    return out;
+}
+
+class Assembler {
+public:
+    Assembler(const std::string &file, Program &p) : file(file), prog(p) {}
+    bool run(const std::string &source);
+
+private:
+    void error(int line, const std::string &msg) { prog.errors.push_back(file + ":" + std::to_string(line) + ": " + msg); }
+    bool eval(const std::string &expr, int line, int64_t &v, bool need_defined = true);
+    bool reg(const std::string &s, int line, unsigned &r);
+    bool imm16(const std::string &expr, int line, int64_t &v);
+    void encode(const Stmt &st);
+
+    std::string file;
+    Program &prog;
+};
+
+bool Assembler::eval(const std::string &expr, int line, int64_t &v, bool need_defined) {
+    std::string e = trim(expr);
+    if (e.empty()) { error(line, "missing expression"); return false; }
+    v = 0;
+    size_t i = 0;
+    int sign = 1;
+    bool want_term = true;
+    while (i < e.size()) {
+        char c = e[i];
+        if (isspace((unsigned char)c)) { i++; continue; }
+        if (want_term) {
+            if (c == '-' || c == '+') { if (c == '-') sign = -sign; i++; continue; }
+            int64_t t;
+            if (isdigit((unsigned char)c)) {
+                size_t b = i;
+                while (i < e.size() && isalnum((unsigned char)e[i])) i++;
+                std::string num = e.substr(b, i - b);
+                char *end;
+                // decimal unless 0x , a leading 0 is no octal prefix
+                bool hex = num.size() > 2 && num[0] == '0' && (num[1] == 'x' || num[1] == 'X');
+                errno = 0;
+                unsigned long long u = strtoull(num.c_str() + (hex ? 2 : 0), &end, hex ? 16 : 10);
+                if (*end) { error(line, "bad number '" + num + "'"); return false; }
+                // a literal is at most a 32-bit word , strtoull saturates on overflow
+                if (errno == ERANGE || u > 0xffffffffull) { error(line, "number '" + num + "' out of range"); return false; }
+                t = (int64_t)u;
+            } else if (c == '\'' && i + 2 < e.size() && e[i + 2] == '\'') {
+                t = (unsigned char)e[i + 1];
+                i += 3;
+            } else if (is_ident_start(c)) {
+                size_t b = i;
+                while (i < e.size() && is_ident(e[i])) i++;
+                std::string name = e.substr(b, i - b);
+                auto it = prog.symbols.find(name);
+                if (it == prog.symbols.end()) {
+                    if (need_defined) error(line, "undefined symbol '" + name + "'");
+                    return false;
+                }
+                t = it->second;
+            } else {
+                error(line, "bad expression '" + e + "'");
+                return false;
+            }
+            v += sign * t;
+            sign = 1;
+            want_term = false;
+        } else {
+            if (c != '+' && c != '-') { error(line, "bad expression '" + e + "'"); return false; }
+            sign = (c == '-') ? -1 : 1;
+            i++;
+            want_term = true;
+        }
+    }
+    if (want_term) { error(line, "bad expression '" + e + "'"); return false; }
+    return true;
+}
+
+bool Assembler::reg(const std::string &s, int line, unsigned &r) {
+    std::string t = trim(s);
+    if (t.size() >= 2 && (t[0] == 'R' || t[0] == 'r' || t[0] == '$')) {
+        char *end;
+        unsigned long n = strtoul(t.c_str() + 1, &end, 10);
+        if (!*end && end != t.c_str() + 1 && n < 32) { r = (unsigned)n; return true; }
+    }
+    error(line, "bad register '" + t + "'");
+    return false;
+}
+
+bool Assembler::imm16(const std::string &expr, int line, int64_t &v) {
+    if (!eval(expr, line, v)) return false;
+    // every core sign-extends the 16 bits , 32768 .. 65535 would come out negative
+    if (v < -32768 || v > 32767) { error(line, "immediate " + std::to_string(v) + " does not fit in 16 bits"); return false; }
+    return true;
+}
+
+void Assembler::encode(const Stmt &st) {
+    std::vector<uint32_t> words;
+    const std::string &op = st.op;
+    auto nargs = [&](size_t n) {
+        if (st.args.size() != n) { error(st.line, op + " takes " + std::to_string(n) + " operands"); return false; }
+        return true;
+    };
+
+    if (op == ".WORD") {
+        for (auto &a : st.args) {
+            int64_t v;
+            if (!eval(a, st.line, v)) return;
+            if (v < -2147483648ll || v > 4294967295ll) { error(st.line, ".word value out of range"); return; }
+            words.push_back((uint32_t)v);
+        }
+    } else if (op == ".SPACE") {
+        int64_t n;
+        if (!eval(st.args[0], st.line, n)) return;
+        words.assign((size_t)n, 0);
+    } else if (op == "NOP") {
+        if (!nargs(0)) return;
+        words.push_back(rr(OP_OR, 0, 0, 0));
+    } else if (op == "MOV") {
+        unsigned d, s;
+        if (!nargs(2) || !reg(st.args[0], st.line, d) || !reg(st.args[1], st.line, s)) return;
+        words.push_back(rr(OP_ADD, d, s, 0));
+    } else if (op == "LI") {
+        unsigned d;
+        int64_t v;
+        if (!nargs(2) || !reg(st.args[0], st.line, d) || !imm16(st.args[1], st.line, v)) return;
+        words.push_back(ri(OP_ADDI, d, 0, (int32_t)v));
+    } else {
+        size_t n;
+        const OpInfo *t = op_table(&n), *info = nullptr;
+        for (size_t i = 0; i < n; i++)
+            if (op == t[i].name) info = &t[i];
+        if (!info) { error(st.line, "unknown instruction '" + op + "'"); return; }
+        unsigned a, b, c;
+        int64_t v;
+        switch (info->fmt) {
+        case F_RRR:
+            if (!nargs(3) || !reg(st.args[0], st.line, a) || !reg(st.args[1], st.line, b) || !reg(st.args[2], st.line, c)) return;
+            words.push_back(rr(info->op, a, b, c));
+            break;
+        case F_RRI:
+            if (!nargs(3) || !reg(st.args[0], st.line, a) || !reg(st.args[1], st.line, b) || !imm16(st.args[2], st.line, v)) return;
+            words.push_back(ri(info->op, a, b, (int32_t)v));
+            break;
+        case F_MEM: {
+            if (!nargs(2) || !reg(st.args[0], st.line, a)) return;
+            std::string m = st.args[1];
+            b = 0;
+            size_t lp = m.rfind('(');
+            if (lp != std::string::npos) {
+                size_t rp = m.find(')', lp);
+                if (rp == std::string::npos || !trim(m.substr(rp + 1)).empty()) { error(st.line, "bad address '" + m + "'"); return; }
+                if (!reg(m.substr(lp + 1, rp - lp - 1), st.line, b)) return;
+                m = m.substr(0, lp);
+            }
+            if (trim(m).empty()) v = 0;
+            else if (!imm16(m, st.line, v)) return;
+            words.push_back(ri(info->op, a, b, (int32_t)v));
+            break;
+        }
+        case F_BRANCH: {
+            if (!nargs(2) || !reg(st.args[0], st.line, a) || !eval(st.args[1], st.line, v)) return;
+            int64_t off = v - (int64_t)(st.addr + 1);
+            if (off < -32768 || off > 32767) { error(st.line, "branch target out of range"); return; }
+            words.push_back(ri(info->op, 0, a, (int32_t)off));
+            break;
+        }
+        case F_JUMP:
+            if (!nargs(1) || !eval(st.args[0], st.line, v)) return;
+            if (v < 0 || (uint64_t)v >> 26 != (st.addr + 1) >> 26) { error(st.line, "jump target out of range"); return; }
+            words.push_back(info->op << 26 | ((uint32_t)v & 0x03ffffff));
+            break;
+        case F_JR:
+            if (!nargs(1) || !reg(st.args[0], st.line, a)) return;
+            words.push_back(rr(info->op, 0, a, 0));
+            break;
+        case F_NONE:
+            if (!nargs(0)) return;
+            words.push_back(rr(info->op, 0, 0, 0));
+            break;
+        }
+    }
+
+    std::vector<uint32_t> &img = st.data ? prog.data : prog.text;
+    std::vector<std::string> &src = st.data ? prog.data_src : prog.text_src;
+    for (size_t k = 0; k < words.size(); k++) {
+        uint32_t a = st.addr + (uint32_t)k;
+        if (a >= img.size()) { img.resize(a + 1, 0); src.resize(a + 1); }
+        if (!src[a].empty()) error(st.line, "overlaps an earlier statement at address " + std::to_string(a));
+        img[a] = words[k];
+        src[a] = k == 0 ? st.src : st.src + " +" + std::to_string(k);
+    }
+}
+
+bool Assembler::run(const std::string &source) {
+    std::vector<Stmt> stmts;
+    uint32_t loc[2] = {0, 0};
+    bool data = false;
+    std::istringstream in(source);
+    std::string raw;
+    int line = 0;
+
+    // pass 1 : addresses and symbols
+    while (std::getline(in, raw)) {
+        line++;
+        std::string s = trim(strip_comment(raw));
+        while (!s.empty()) {   // labels
+            size_t i = 0;
+            if (!is_ident_start(s[0]) || s[0] == '.') break;
+            while (i < s.size() && is_ident(s[i])) i++;
+            size_t j = i;
+            while (j < s.size() && isspace((unsigned char)s[j])) j++;
+            if (j >= s.size() || s[j] != ':') break;
+            std::string name = s.substr(0, i);
+            if (prog.symbols.count(name)) error(line, "duplicate symbol '" + name + "'");
+            prog.symbols[name] = loc[data];
+            s = trim(s.substr(j + 1));
+        }
+        if (s.empty()) continue;
+
+        size_t sp = 0;
+        while (sp < s.size() && !isspace((unsigned char)s[sp])) sp++;
+        Stmt st;
+        st.line = line;
+        st.op = upper(s.substr(0, sp));
+        st.args = split_args(s.substr(sp));
+        st.src = s;
+
+        if (st.op == ".TEXT" || st.op == ".DATA") {
+            data = (st.op == ".DATA");
+            int64_t v;
+            if (!st.args.empty()) {
+                if (eval(st.args[0], line, v)) loc[data] = (uint32_t)v;
+            }
+            continue;
+        }
+        if (st.op == ".ORG") {
+            int64_t v;
+            if (st.args.size() != 1) error(line, ".org takes one address");
+            else if (eval(st.args[0], line, v)) loc[data] = (uint32_t)v;
+            continue;
+        }
+        if (st.op == ".EQU") {
+            int64_t v;
+            if (st.args.size() != 2 || !is_ident_start(st.args[0][0])) error(line, ".equ takes a name and a value");
+            else if (eval(st.args[1], line, v)) {
+                if (prog.symbols.count(st.args[0])) error(line, "duplicate symbol '" + st.args[0] + "'");
+                prog.symbols[st.args[0]] = (uint32_t)v;
+            }
+            continue;
+        }
+
+        st.data = data;
+        st.addr = loc[data];
+        uint32_t size = 1;
+        if (st.op == ".WORD") {
+            if (st.args.empty()) error(line, ".word needs a value");
+            size = (uint32_t)st.args.size();
+        } else if (st.op == ".SPACE") {
+            int64_t v = 0;
+            if (st.args.size() != 1) { error(line, ".space takes a count"); continue; }
+            if (!eval(st.args[0], line, v)) continue;
+            if (v < 0 || v > (1 << 24)) { error(line, "bad .space count"); continue; }
+            size = (uint32_t)v;
+        } else if (st.op[0] == '.') {
+            error(line, "unknown directive '" + st.op + "'");
+            continue;
+        } else if (data) {
+            error(line, "instruction in the .data section");
+            continue;
+        }
+        loc[data] += size;
+        stmts.push_back(st);
+    }
+
+    // pass 2 : encode
+    for (auto &st : stmts) encode(st);
+    return prog.errors.empty();
+}
+
+} // namespace
+
+bool assemble(const std::string &source, const std::string &filename, Program &prog) {
+    Assembler a(filename, prog);
+    return a.run(source);
+}
+
+std::string disassemble(uint32_t ir, uint32_t pc) {
+    const OpInfo *info = op_info(op_of(ir));
+    char buf[64];
+    if (!info) {
+        snprintf(buf, sizeof buf, ".word 0x%08x", ir);   // decodes as HLT
+        return buf;
+    }
+    switch (info->fmt) {
+    case F_RRR: snprintf(buf, sizeof buf, "%-5s R%u, R%u, R%u", info->name, rd_of(ir), rs_of(ir), rt_of(ir)); break;
+    case F_RRI: snprintf(buf, sizeof buf, "%-5s R%u, R%u, %d", info->name, rt_of(ir), rs_of(ir), (int32_t)imm_of(ir)); break;
+    case F_MEM: snprintf(buf, sizeof buf, "%-5s R%u, %d(R%u)", info->name, rt_of(ir), (int32_t)imm_of(ir), rs_of(ir)); break;
+    case F_BRANCH: snprintf(buf, sizeof buf, "%-5s R%u, %u", info->name, rs_of(ir), pc + 1 + imm_of(ir)); break;
+    case F_JUMP: snprintf(buf, sizeof buf, "%-5s %u", info->name, jump_target(ir, pc)); break;
+    case F_JR: snprintf(buf, sizeof buf, "%-5s R%u", info->name, rs_of(ir)); break;
+    default: snprintf(buf, sizeof buf, "%s", info->name); break;
+    }
+    return buf;
+}
+
+} // namespace mips
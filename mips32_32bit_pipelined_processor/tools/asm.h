@@ -0,0 +1,57 @@
+// Assembler for the MIPS.v ISA.
+//
+// One statement per line , comments start with '#', ';' or '//'.
+//
+//   label:                      labels may share a line with a statement
+//   ADD   R3, R1, R2            rd, rs, rt          (registers R0-R31 , r5 , $5)
+//   ADDI  R1, R0, 10            rt, rs, imm
+//   LW    R4, 8(R2)             rt, imm(rs)         imm(rs) may omit (rs) for R0
+//   SW    R4, buf+1(R0)
+//   BNEQZ R1, loop              rs, label           offset = label - NPC
+//   JAL   func                  label               in the NPC's 64M-word region
+//   JR    R31                   rs
+//   HLT
+//   NOP                         OR R0, R0, R0
+//   MOV   R2, R1                ADD R2, R1, R0
+//   LI    R2, 100               ADDI R2, R0, 100
+//
+// Immediates are expressions of numbers (decimal , 0x hex , 'c'), labels and
+// .equ names joined by + and -. A 16-bit immediate or offset must lie in
+// -32768 .. 32767 , as the cores sign-extend it (LI takes no more).
+//
+// Directives:
+//   .text / .data [addr]        switch section (text starts at 0 , data at 0
+//                               or addr) ; addresses are in words
+//   .org addr                   move the current section's location
+//   .word e1, e2, ...           one word per expression
+//   .space n                    n zero words
+//   .equ name, expr             named constant
+//
+// The text section becomes the IMEM image and the data section the DMEM
+// image , both as $readmemh files.
+#ifndef MIPS_ASM_H
+#define MIPS_ASM_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace mips {
+
+struct Program {
+    std::vector<uint32_t> text, data;           // images , index = word address
+    std::vector<std::string> text_src, data_src; // source statement of each word , for listings
+    std::map<std::string, uint32_t> symbols;     // labels and .equ names
+    std::vector<std::string> errors;             // "file:line: message"
+};
+
+// Assembles source ; returns false (with prog.errors filled) on any error.
+bool assemble(const std::string &source, const std::string &filename, Program &prog);
+
+// Text form of one instruction word , branch targets shown relative to pc.
+std::string disassemble(uint32_t ir, uint32_t pc);
+
+} // namespace mips
+
+#endif
@@ -0,0 +1,80 @@
+// mips_asm : assembles a source file into $readmemh images.
+//
+//   mips_asm prog.s [-o prog.hex] [-d data.hex] [-l]
+//
+// -o names the IMEM image (default: the source name with .hex), -d the DMEM
+// image (written only when the program has a .data section, default: the
+// source name with .data.hex), -l prints a listing with addresses and the
+// symbol table.
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "asm.h"
+#include "hexfile.h"
+
+static void usage() {
+    fprintf(stderr, "usage: mips_asm prog.s [-o prog.hex] [-d data.hex] [-l]\n");
+    exit(2);
+}
+
+static std::string stem(const std::string &path) {
+    size_t dot = path.rfind('.'), slash = path.rfind('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return path;
+    return path.substr(0, dot);
+}
+
+int main(int argc, char **argv) {
+    std::string src, out, data_out;
+    bool listing = false;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a == "-o" && i + 1 < argc) out = argv[++i];
+        else if (a == "-d" && i + 1 < argc) data_out = argv[++i];
+        else if (a == "-l") listing = true;
+        else if (a[0] != '-' && src.empty()) src = a;
+        else usage();
+    }
+    if (src.empty()) usage();
+    if (out.empty()) out = stem(src) + ".hex";
+    if (data_out.empty()) data_out = stem(src) + ".data.hex";
+
+    std::ifstream in(src);
+    if (!in) {
+        fprintf(stderr, "cannot open %s\n", src.c_str());
+        return 2;
+    }
+    std::stringstream ss;
+    ss << in.rdbuf();
+
+    mips::Program prog;
+    if (!mips::assemble(ss.str(), src, prog)) {
+        for (auto &e : prog.errors) fprintf(stderr, "%s\n", e.c_str());
+        return 1;
+    }
+
+    if (!mips::save_hex(out, prog.text, prog.text.size(), &prog.text_src)) {
+        fprintf(stderr, "cannot write %s\n", out.c_str());
+        return 2;
+    }
+    if (!prog.data.empty() && !mips::save_hex(data_out, prog.data, prog.data.size(), &prog.data_src)) {
+        fprintf(stderr, "cannot write %s\n", data_out.c_str());
+        return 2;
+    }
+
+    if (listing) {
+        for (size_t a = 0; a < prog.text.size(); a++)
+            printf("%5zu  %08x  %-24s  %s\n", a, prog.text[a], mips::disassemble(prog.text[a], (uint32_t)a).c_str(),
+                   prog.text_src[a].c_str());
+        if (!prog.data.empty()) printf("\n.data\n");
+        for (size_t a = 0; a < prog.data.size(); a++)
+            printf("%5zu  %08x  %s\n", a, prog.data[a], prog.data_src[a].c_str());
+        printf("\nsymbols\n");
+        for (auto &s : prog.symbols) printf("  %-20s %u\n", s.first.c_str(), s.second);
+    }
+    printf("%s : %zu text words%s", out.c_str(), prog.text.size(), prog.data.empty() ? "\n" : "");
+    if (!prog.data.empty()) printf(" , %s : %zu data words\n", data_out.c_str(), prog.data.size());
+    return 0;
+}
@@ -0,0 +1,292 @@
+// mips_bench : runs the benchmark programs (bench/*.s) and checks their results.
+//
+//   mips_bench [--rtl obj_dir/V<top>] [--timing two-phase|single] [--no-forwarding]
+//              [--no-bpred] [--early-branch] [--btb N] [--pht N] [--ras N] [--mul-latency N]
+//              [--dual-issue] prog.s ...
+//
+// Each program is assembled , run until HLT and checked against the expect
+// lines in its comments:
+//   # expect R2 = 275                  register
+//   # expect Mem[dst+8] = 1 2 0x30     consecutive data words from a label or address
+// By default the programs run on the ISS with the cycle model (two-phase
+// unless --timing single). With --rtl the images are written next to the
+// source (prog.hex , prog.data.hex) and run on the Verilator harness instead ;
+// cycles and branch counts are then the RTL's own and the timing options are
+// ignored (core parameters go to the Verilator build).
+// One line per program : instructions , cycles , CPI , branches with the
+// prediction rate , stall cycles , memory stall cycles (MEM_STALLS , RTL only :
+// the ISS has ideal memory) and PASS / FAIL. The exit status is 0 only
+// when every program passes.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "asm.h"
+#include "hexfile.h"
+#include "iss.h"
+
+namespace {
+
+struct Expect {
+    bool is_reg = false;
+    uint32_t where = 0;              // register or first word address
+    std::vector<uint32_t> values;
+    int line = 0;
+};
+
+struct Result {
+    bool ok = false;                 // ran to HLT
+    std::string error;
+    uint32_t reg[32] = {};
+    std::map<uint32_t, uint32_t> mem;
+    uint64_t instructions = 0, cycles = 0, branches = 0, predicted = 0, stalls = 0, mem_stalls = 0;
+};
+
+std::string trim(const std::string &s) {
+    size_t b = s.find_first_not_of(" \t\r"), e = s.find_last_not_of(" \t\r");
+    return b == std::string::npos ? "" : s.substr(b, e - b + 1);
+}
+
+std::string stem(const std::string &path) {
+    size_t dot = path.rfind('.'), slash = path.rfind('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return path;
+    return path.substr(0, dot);
+}
+
+// label , number , or label +/- number
+bool address(const std::string &expr, const mips::Program &prog, uint32_t *addr) {
+    std::string e = trim(expr);
+    size_t op = e.find_first_of("+-", 1);
+    std::string base = trim(e.substr(0, op));
+    char *end;
+    uint32_t a;
+    auto it = prog.symbols.find(base);
+    if (it != prog.symbols.end()) a = it->second;
+    else {
+        a = (uint32_t)strtoul(base.c_str(), &end, 0);
+        if (base.empty() || *end) return false;
+    }
+    if (op != std::string::npos) {
+        std::string off = trim(e.substr(op + 1));
+        uint32_t o = (uint32_t)strtoul(off.c_str(), &end, 0);
+        if (off.empty() || *end) return false;
+        a = (e[op] == '+') ? a + o : a - o;
+    }
+    *addr = a;
+    return true;
+}
+
+bool parse_expects(const std::string &src, const std::string &file, const mips::Program &prog,
+                   std::vector<Expect> &out, std::string *err) {
+    std::istringstream in(src);
+    std::string line;
+    for (int n = 1; std::getline(in, line); n++) {
+        size_t hash = line.find('#');
+        if (hash == std::string::npos) continue;
+        std::string c = trim(line.substr(hash + 1));
+        if (c.compare(0, 7, "expect ") != 0) continue;
+        auto bad = [&](const char *what) {
+            *err = file + ":" + std::to_string(n) + ": " + what;
+            return false;
+        };
+        size_t eq = c.find('=');
+        if (eq == std::string::npos) return bad("expect wants TARGET = VALUE...");
+        std::string target = trim(c.substr(7, eq - 7));
+        Expect x;
+        x.line = n;
+        if ((target[0] == 'R' || target[0] == 'r') && target.size() > 1) {
+            char *end;
+            x.is_reg = true;
+            x.where = (uint32_t)strtoul(target.c_str() + 1, &end, 10);
+            if (*end || x.where > 31) return bad("bad register");
+        } else if (target.compare(0, 4, "Mem[") == 0 && target.back() == ']') {
+            if (!address(target.substr(4, target.size() - 5), prog, &x.where)) return bad("bad address");
+        } else {
+            return bad("expect target is R<n> or Mem[addr]");
+        }
+        std::istringstream vs(c.substr(eq + 1));
+        std::string v;
+        while (vs >> v) {
+            char *end;
+            x.values.push_back((uint32_t)strtoll(v.c_str(), &end, 0));
+            if (*end) return bad("bad value");
+        }
+        if (x.values.empty() || (x.is_reg && x.values.size() != 1)) return bad("bad value count");
+        out.push_back(x);
+    }
+    if (out.empty()) {
+        *err = file + ": no expect lines";
+        return false;
+    }
+    return true;
+}
+
+Result run_iss(const mips::Program &prog, const mips::TimingConfig &tc, const std::vector<Expect> &expects) {
+    Result res;
+    mips::Iss iss;
+    if (prog.text.size() > iss.imem.size() || prog.data.size() > iss.dmem.size()) {
+        res.error = "image larger than IMEM / DMEM";
+        return res;
+    }
+    for (size_t i = 0; i < prog.text.size(); i++) iss.imem[i] = prog.text[i];
+    for (size_t i = 0; i < prog.data.size(); i++) iss.dmem[i] = prog.data[i];
+    mips::Timing model(tc, iss.imem);
+    while (!iss.halted && iss.retired + iss.traps < 100000000ull) model.retire(iss.step());
+    res.ok = iss.halted;
+    if (!res.ok) res.error = "no HLT";
+    for (int r = 0; r < 32; r++) res.reg[r] = iss.read_reg(r);
+    for (auto &x : expects)
+        if (!x.is_reg)
+            for (size_t k = 0; k < x.values.size(); k++)
+                res.mem[x.where + k] = iss.dmem[(x.where + k) & (iss.dmem.size() - 1)];
+    res.instructions = iss.retired;
+    res.cycles = model.cycles();
+    res.branches = model.branches;
+    res.predicted = model.predicted;
+    res.stalls = model.stalls;
+    return res;
+}
+
+Result run_rtl(const std::string &bin, const std::string &src, const mips::Program &prog,
+               const std::vector<Expect> &expects) {
+    Result res;
+    std::string hex = stem(src) + ".hex", data = stem(src) + ".data.hex";
+    if (!mips::save_hex(hex, prog.text, prog.text.size(), &prog.text_src) ||
+        (!prog.data.empty() && !mips::save_hex(data, prog.data, prog.data.size(), &prog.data_src))) {
+        res.error = "cannot write " + hex;
+        return res;
+    }
+    std::string cmd = bin + " +IMEM=" + hex;
+    if (!prog.data.empty()) cmd += " +DMEM=" + data;
+    for (auto &x : expects)
+        if (!x.is_reg) cmd += " --mem " + std::to_string(x.where) + ":" + std::to_string(x.values.size());
+    FILE *p = popen((cmd + " 2>&1").c_str(), "r");
+    if (!p) {
+        res.error = "cannot run " + bin;
+        return res;
+    }
+    // the harness prints R<n> = <hex> four to a line , Mem[<a>] = <hex> ,
+    // the counters and HALTED after <cycles> cycles , <n> instructions retired
+    char buf[512];
+    while (fgets(buf, sizeof buf, p)) {
+        unsigned r, v, c[6];
+        long a;
+        unsigned long long cyc, ins;
+        if (buf[0] == 'R' && buf[1] != 'E') {
+            for (char *s = buf; (s = strchr(s, 'R')); s++)
+                if (sscanf(s, "R%u = %x", &r, &v) == 2 && r < 32) res.reg[r] = v;
+        } else if (sscanf(buf, "Mem[%ld] = %x", &a, &v) == 2) {
+            res.mem[(uint32_t)a] = v;
+        } else if (sscanf(buf, "CYCLES %u , RETIRED %u , BRANCH_FLUSHES %u , STALL_CYCLES %u , BP %u / %u",
+                          &c[0], &c[1], &c[2], &c[3], &c[4], &c[5]) == 6) {
+            res.stalls = c[3];
+            res.predicted = c[4];
+            res.branches = c[5];
+            if (const char *m = strstr(buf, "MEM_STALLS ")) res.mem_stalls = strtoull(m + 11, nullptr, 10);
+        } else if (sscanf(buf, "HALTED after %llu cycles , %llu instructions", &cyc, &ins) == 2) {
+            res.ok = true;
+            res.cycles = cyc;
+            res.instructions = ins;
+        }
+    }
+    int status = pclose(p);
+    if (!res.ok) res.error = status ? "harness failed or did not halt" : "no HALTED line from the harness";
+    return res;
+}
+
+// compares res against the expect lines , the first few differences go to diffs
+bool verify(const std::string &file, const Result &res, const std::vector<Expect> &expects, std::string *diffs) {
+    int bad = 0;
+    char buf[160];
+    for (auto &x : expects)
+        for (size_t k = 0; k < x.values.size(); k++) {
+            uint32_t got = x.is_reg ? res.reg[x.where] : res.mem.count(x.where + k) ? res.mem.at(x.where + k) : 0;
+            if (got == x.values[k] || bad++ >= 4) continue;
+            if (x.is_reg) snprintf(buf, sizeof buf, "  %s:%d: R%u = 0x%08x , expected 0x%08x\n", file.c_str(), x.line,
+                                   x.where, got, x.values[k]);
+            else snprintf(buf, sizeof buf, "  %s:%d: Mem[%u] = 0x%08x , expected 0x%08x\n", file.c_str(), x.line,
+                          (unsigned)(x.where + k), got, x.values[k]);
+            *diffs += buf;
+        }
+    return bad == 0;
+}
+
+void usage() {
+    fprintf(stderr, "usage: mips_bench [--rtl obj_dir/V<top>] [--timing two-phase|single] [--no-forwarding]\n"
+                    "                  [--no-bpred] [--early-branch] [--btb N] [--pht N] [--ras N] [--mul-latency N]\n"
+                    "                  [--dual-issue] prog.s ...\n");
+    exit(2);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string rtl, timing = "two-phase";
+    std::vector<std::string> files;
+    mips::TimingConfig tc;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> const char * { if (i + 1 >= argc) usage(); return argv[++i]; };
+        if (a == "--rtl") rtl = next();
+        else if (a == "--timing") timing = next();
+        else if (a == "--no-forwarding") tc.forwarding = false;
+        else if (a == "--no-bpred") tc.bpred = false;
+        else if (a == "--early-branch") tc.early_branch = true;
+        else if (a == "--btb") tc.btb_entries = strtoul(next(), nullptr, 0);
+        else if (a == "--pht") tc.pht_entries = strtoul(next(), nullptr, 0);
+        else if (a == "--ras") tc.ras_entries = strtoul(next(), nullptr, 0);
+        else if (a == "--mul-latency") tc.mul_latency = strtoul(next(), nullptr, 0);
+        else if (a == "--dual-issue") tc.dual_issue = true;
+        else if (a[0] != '-') files.push_back(a);
+        else usage();
+    }
+    if (files.empty() || (timing != "two-phase" && timing != "single")) usage();
+    tc.single_clock = (timing == "single");
+
+    printf("%s\n", rtl.empty() ? ("ISS , " + timing + " cycle model").c_str() : ("RTL , " + rtl).c_str());
+    printf("%-12s %8s %9s %6s %9s %6s %8s %8s  %s\n", "program", "instr", "cycles", "CPI", "branches", "pred", "stalls",
+           "mem", "result");
+    int failed = 0;
+    uint64_t all_instr = 0, all_cycles = 0;
+    for (auto &file : files) {
+        std::string name = stem(file);
+        name = name.substr(name.rfind('/') + 1);
+        std::ifstream in(file);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        mips::Program prog;
+        std::vector<Expect> expects;
+        std::string err;
+        if (!in || !mips::assemble(ss.str(), file, prog) || !parse_expects(ss.str(), file, prog, expects, &err)) {
+            printf("%-12s %s\n", name.c_str(), !in ? "cannot open" : !prog.errors.empty() ? prog.errors[0].c_str() : err.c_str());
+            failed++;
+            continue;
+        }
+        Result res = rtl.empty() ? run_iss(prog, tc, expects) : run_rtl(rtl, file, prog, expects);
+        if (!res.ok) {
+            printf("%-12s FAIL : %s\n", name.c_str(), res.error.c_str());
+            failed++;
+            continue;
+        }
+        std::string diffs;
+        bool pass = verify(file, res, expects, &diffs);
+        printf("%-12s %8llu %9llu %6.2f %9llu %5.1f%% %8llu %8llu  %s\n%s", name.c_str(),
+               (unsigned long long)res.instructions, (unsigned long long)res.cycles,
+               res.instructions ? (double)res.cycles / res.instructions : 0.0, (unsigned long long)res.branches,
+               res.branches ? 100.0 * res.predicted / res.branches : 100.0, (unsigned long long)res.stalls,
+               (unsigned long long)res.mem_stalls, pass ? "PASS" : "FAIL", diffs.c_str());
+        failed += !pass;
+        all_instr += res.instructions;
+        all_cycles += res.cycles;
+    }
+    printf("%d / %zu passed , %llu instructions , %llu cycles , CPI %.2f , IPC %.2f\n", (int)files.size() - failed,
+           files.size(), (unsigned long long)all_instr, (unsigned long long)all_cycles,
+           all_instr ? (double)all_cycles / all_instr : 0.0, all_cycles ? (double)all_instr / all_cycles : 0.0);
+    return failed != 0;
+}
@@ -0,0 +1,150 @@
+// Checkpoints : the state of a program stopped between two instructions ,
+// saved and restored by mips_iss and the Verilator harness (--save FILE ,
+// --restore FILE) , so a long run can be fast-forwarded on the ISS and go on
+// on the RTL from there.
+//
+// A checkpoint is always of a drained pipeline : every instruction before pc
+// has retired , with its MDU result written back and its stores in DMEM
+// (past the D-cache) , and none after it has started. What the pipeline
+// keeps in flight then comes down to pc , the hardware-loop registers (the
+// count is the one the instruction before pc left , as a trap takes it) and
+// the trap registers. Caches , the fetch queue and the branch predictors are
+// not part of it , a restored core starts them cold.
+//
+// File : an 8-byte header , "MCKP" , a version byte and three zero bytes ,
+// then , all little-endian ,
+//   u32  pc , flags (CK_HALTED)
+//   u64  retired , traps     instructions retired and traps taken before pc
+//   u32  reg[32]
+//   u32  status , cause , epc , loop_start , loop_end , loop_count
+//   u32  IMEM words , then the words ; the same for DMEM
+#ifndef MIPS_CHECKPOINT_H
+#define MIPS_CHECKPOINT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace mips {
+
+const uint32_t CK_HALTED = 1;   // HLT has retired , pc is the word after it
+
+struct Checkpoint {
+    uint32_t pc = 0;
+    bool halted = false;
+    uint64_t retired = 0, traps = 0;
+    uint32_t reg[32] = {};
+    uint32_t status = 0, cause = 0, epc = 0;   // as in Iss
+    uint32_t loop_start = 0, loop_end = 0, loop_count = 0;
+    std::vector<uint32_t> imem, dmem;
+};
+
+namespace ckpt_detail {
+
+inline void put(FILE *f, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) fputc((int)((v >> (8 * i)) & 0xff), f);
+}
+
+inline bool get(FILE *f, uint64_t *v, int bytes) {
+    *v = 0;
+    for (int i = 0; i < bytes; i++) {
+        int b = fgetc(f);
+        if (b == EOF) return false;
+        *v |= (uint64_t)b << (8 * i);
+    }
+    return true;
+}
+
+inline bool get32(FILE *f, uint32_t *v) {
+    uint64_t w;
+    if (!get(f, &w, 4)) return false;
+    *v = (uint32_t)w;
+    return true;
+}
+
+inline bool get_mem(FILE *f, std::vector<uint32_t> &mem) {
+    uint32_t n;
+    // a power of two , as the memories are
+    if (!get32(f, &n) || n == 0 || (n & (n - 1)) || n > (1u << 26)) return false;
+    mem.assign(n, 0);
+    for (uint32_t &w : mem)
+        if (!get32(f, &w)) return false;
+    return true;
+}
+
+} // namespace ckpt_detail
+
+inline bool save_checkpoint(const std::string &path, const Checkpoint &ck) {
+    using ckpt_detail::put;
+    FILE *f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    const uint8_t head[8] = {'M', 'C', 'K', 'P', 1, 0, 0, 0};
+    fwrite(head, 1, 8, f);
+    put(f, ck.pc, 4);
+    put(f, ck.halted ? CK_HALTED : 0, 4);
+    put(f, ck.retired, 8);
+    put(f, ck.traps, 8);
+    for (uint32_t r : ck.reg) put(f, r, 4);
+    for (uint32_t v : {ck.status, ck.cause, ck.epc, ck.loop_start, ck.loop_end, ck.loop_count}) put(f, v, 4);
+    for (const std::vector<uint32_t> *mem : {&ck.imem, &ck.dmem}) {
+        put(f, mem->size(), 4);
+        for (uint32_t w : *mem) put(f, w, 4);
+    }
+    bool ok = !ferror(f);
+    return fclose(f) == 0 && ok;
+}
+
+// Returns false (with *err) if the file cannot be read or is no checkpoint.
+inline bool load_checkpoint(const std::string &path, Checkpoint &ck, std::string *err = nullptr) {
+    using namespace ckpt_detail;
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f) {
+        if (err) *err = "cannot open " + path;
+        return false;
+    }
+    uint8_t head[8];
+    uint32_t flags = 0;
+    ck = Checkpoint();
+    bool ok = fread(head, 1, 8, f) == 8 && head[0] == 'M' && head[1] == 'C' && head[2] == 'K' && head[3] == 'P' &&
+              head[4] == 1 && get32(f, &ck.pc) && get32(f, &flags) && get(f, &ck.retired, 8) &&
+              get(f, &ck.traps, 8);
+    for (uint32_t &r : ck.reg) ok = ok && get32(f, &r);
+    for (uint32_t *v : {&ck.status, &ck.cause, &ck.epc, &ck.loop_start, &ck.loop_end, &ck.loop_count})
+        ok = ok && get32(f, v);
+    ok = ok && get_mem(f, ck.imem) && get_mem(f, ck.dmem) && fgetc(f) == EOF;
+    ck.halted = flags & CK_HALTED;
+    fclose(f);
+    if (!ok && err) *err = path + " is not a version 1 checkpoint";
+    return ok;
+}
+
+// What differs between two checkpoints of the same program , one line each
+// ("pc 12 / 13" , "R4 5 / 6" , "Mem[40] 0 / 7" , ...) ; R0 and the
+// instruction and trap counts are left out.
+inline std::vector<std::string> checkpoint_diff(const Checkpoint &a, const Checkpoint &b) {
+    std::vector<std::string> d;
+    auto field = [&](const std::string &name, uint64_t x, uint64_t y) {
+        if (x != y) d.push_back(name + " " + std::to_string(x) + " / " + std::to_string(y));
+    };
+    field("pc", a.pc, b.pc);
+    field("halted", a.halted, b.halted);
+    for (int r = 1; r < 32; r++) field("R" + std::to_string(r), a.reg[r], b.reg[r]);
+    field("STATUS", a.status, b.status);
+    field("CAUSE", a.cause, b.cause);
+    field("EPC", a.epc, b.epc);
+    field("LOOP_START", a.loop_start, b.loop_start);
+    field("LOOP_END", a.loop_end, b.loop_end);
+    field("LOOP_COUNT", a.loop_count, b.loop_count);
+    field("IMEM words", a.imem.size(), b.imem.size());
+    field("DMEM words", a.dmem.size(), b.dmem.size());
+    for (size_t i = 0; i < a.imem.size() && i < b.imem.size(); i++)
+        field("IMEM[" + std::to_string(i) + "]", a.imem[i], b.imem[i]);
+    for (size_t i = 0; i < a.dmem.size() && i < b.dmem.size(); i++)
+        field("Mem[" + std::to_string(i) + "]", a.dmem[i], b.dmem[i]);
+    return d;
+}
+
+} // namespace mips
+
+#endif
@@ -0,0 +1,87 @@
+// $readmemh images : whitespace separated hex words, // and /* */ comments,
+// @addr (hex, in words) moves the load address.
+#ifndef MIPS_HEXFILE_H
+#define MIPS_HEXFILE_H
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace mips {
+
+// Loads path into mem (which keeps its size, words past the end are
+// dropped). Returns false if the file cannot be read or has a bad token ,
+// e.g. a word of more than 8 hex digits (err gives the line).
+inline bool load_hex(const std::string &path, std::vector<uint32_t> &mem, std::string *err = nullptr) {
+    std::ifstream in(path);
+    if (!in) {
+        if (err) *err = "cannot open " + path;
+        return false;
+    }
+    std::stringstream ss;
+    ss << in.rdbuf();
+    const std::string s = ss.str();
+    size_t i = 0, addr = 0;
+    int line = 1;
+    while (i < s.size()) {
+        char c = s[i];
+        if (c == '\n') { line++; i++; continue; }
+        if (isspace((unsigned char)c)) { i++; continue; }
+        if (c == '/' && i + 1 < s.size() && s[i + 1] == '/') {
+            while (i < s.size() && s[i] != '\n') i++;
+            continue;
+        }
+        if (c == '/' && i + 1 < s.size() && s[i + 1] == '*') {
+            size_t e = s.find("*/", i + 2);
+            for (size_t k = i; k < (e == std::string::npos ? s.size() : e); k++)
+                if (s[k] == '\n') line++;
+            i = (e == std::string::npos) ? s.size() : e + 2;
+            continue;
+        }
+        bool at = (c == '@');
+        if (at) i++;
+        size_t b = i;
+        while (i < s.size() && (isxdigit((unsigned char)s[i]) || s[i] == '_')) i++;
+        if (i == b) {
+            if (err) *err = path + ":" + std::to_string(line) + ": bad character '" + std::string(1, s[i]) + "'";
+            return false;
+        }
+        std::string tok;
+        for (size_t k = b; k < i; k++)
+            if (s[k] != '_') tok += s[k];
+        if (tok.empty() || tok.size() > 8) {   // one 32-bit word (or address) at most
+            if (err) *err = path + ":" + std::to_string(line) + ": bad word '" + s.substr(b, i - b) + "'";
+            return false;
+        }
+        uint32_t v = (uint32_t)std::stoul(tok, nullptr, 16);
+        if (at) addr = v;
+        else {
+            if (addr < mem.size()) mem[addr] = v;
+            addr++;
+        }
+    }
+    return true;
+}
+
+// Writes words [0, count) of mem, one per line, with an optional comment
+// per word.
+inline bool save_hex(const std::string &path, const std::vector<uint32_t> &mem, size_t count,
+                     const std::vector<std::string> *comments = nullptr) {
+    FILE *f = fopen(path.c_str(), "w");
+    if (!f) return false;
+    for (size_t a = 0; a < count && a < mem.size(); a++) {
+        if (comments && a < comments->size() && !(*comments)[a].empty())
+            fprintf(f, "%08x  // %s\n", mem[a], (*comments)[a].c_str());
+        else
+            fprintf(f, "%08x\n", mem[a]);
+    }
+    return fclose(f) == 0;
+}
+
+} // namespace mips
+
+#endif
@@ -0,0 +1,410 @@
+#include "iss.h"
+
+#include <algorithm>
+
+namespace mips {
+
+// packed ops : lane by lane over w-bit lanes , SUMB adds the bytes of a to b
+static uint32_t simd(uint32_t op, uint32_t a, uint32_t b) {
+    if (op == OP_SUMB) return (a & 0xff) + ((a >> 8) & 0xff) + ((a >> 16) & 0xff) + (a >> 24) + b;
+    const bool bytes = op == OP_ADDB || op == OP_SUBB || op == OP_ADDUSB || op == OP_CMPEQB || op == OP_CMPLTB;
+    const unsigned w = bytes ? 8 : 16;
+    const uint32_t mask = (1u << w) - 1;
+    uint32_t v = 0;
+    for (unsigned l = 0; l < 32; l += w) {
+        const uint32_t x = (a >> l) & mask, y = (b >> l) & mask;
+        uint32_t z = 0;
+        switch (op) {
+        case OP_ADDB: case OP_ADDH: z = x + y; break;
+        case OP_SUBB: case OP_SUBH: z = x - y; break;
+        case OP_ADDUSB: case OP_ADDUSH: z = std::min(x + y, mask); break;
+        case OP_CMPEQB: case OP_CMPEQH: z = x == y ? mask : 0; break;
+        case OP_CMPLTB: case OP_CMPLTH: z = x < y ? mask : 0; break;
+        }
+        v |= (z & mask) << l;
+    }
+    return v;
+}
+
+Iss::Iss(size_t imem_words, size_t dmem_words) : imem(imem_words, 0), dmem(dmem_words, 0) {
+    for (auto &r : reg) r = 0;
+}
+
+void Iss::reset() {
+    pc = 0;
+    halted = false;
+    retired = 0;
+    status = cause = epc = 0;
+    traps = 0;
+    loop_start = loop_end = loop_count = 0;
+}
+
+void Iss::trap(uint32_t code) {
+    epc = pc;
+    cause = code;
+    status |= STATUS_EXL;
+    pc = exc_vector;
+    traps++;
+}
+
+bool Iss::interrupt() {
+    if (halted || (status & (STATUS_IE | STATUS_EXL)) != STATUS_IE) return false;
+    trap(CAUSE_INT);
+    return true;
+}
+
+void Iss::save(Checkpoint &ck) const {
+    ck.pc = pc;
+    ck.halted = halted;
+    ck.retired = retired;
+    ck.traps = traps;
+    for (int r = 0; r < 32; r++) ck.reg[r] = reg[r];
+    ck.status = status;
+    ck.cause = cause;
+    ck.epc = epc;
+    ck.loop_start = loop_start;
+    ck.loop_end = loop_end;
+    ck.loop_count = loop_count;
+    ck.imem = imem;
+    ck.dmem = dmem;
+}
+
+bool Iss::restore(const Checkpoint &ck, std::string *err) {
+    if (ck.imem.size() != imem.size() || ck.dmem.size() != dmem.size()) {
+        if (err) *err = "checkpoint has " + std::to_string(ck.imem.size()) + " IMEM / " + std::to_string(ck.dmem.size()) +
+                        " DMEM words , the memories " + std::to_string(imem.size()) + " / " + std::to_string(dmem.size());
+        return false;
+    }
+    pc = ck.pc;
+    halted = ck.halted;
+    retired = ck.retired;
+    traps = ck.traps;
+    for (int r = 0; r < 32; r++) reg[r] = ck.reg[r];
+    status = ck.status;
+    cause = ck.cause;
+    epc = ck.epc;
+    loop_start = ck.loop_start;
+    loop_end = ck.loop_end;
+    loop_count = ck.loop_count;
+    imem = ck.imem;
+    dmem = ck.dmem;
+    return true;
+}
+
+uint32_t Iss::read_csr(uint32_t addr) const {
+    switch (addr - PERF_BASE) {
+    case CSR_STATUS: return status;
+    case CSR_CAUSE: return cause;
+    default: return epc;
+    }
+}
+
+void Iss::write_csr(uint32_t addr, uint32_t v) {
+    switch (addr - PERF_BASE) {
+    case CSR_STATUS: status = v & (STATUS_IE | STATUS_EXL); break;
+    case CSR_EPC: epc = v; break;
+    default: break;   // CAUSE is read-only
+    }
+}
+
+Retired Iss::step() {
+    Retired r;
+    r.pc = pc;
+    r.ir = imem[pc & (imem.size() - 1)];
+    const uint32_t ir = r.ir;
+    if (is_reserved(ir)) {
+        trap(CAUSE_RI);
+        r.trap = true;
+        r.next_pc = pc;
+        return r;
+    }
+    const uint32_t a = read_reg(rs_of(ir)), b = read_reg(rt_of(ir)), imm = imm_of(ir);
+    uint32_t next = pc + 1;
+
+    switch (type_of(ir)) {
+    case RR_ALU:
+        switch (op_of(ir)) {
+        case OP_ADD: r.value = a + b; break;
+        case OP_SUB: r.value = a - b; break;
+        case OP_AND: r.value = a & b; break;
+        case OP_OR:  r.value = a | b; break;
+        case OP_SLT: r.value = a < b; break;
+        case OP_MUL: r.value = a * b; break;
+        case OP_DIV: r.value = b ? a / b : 0xffffffff; break;
+        case OP_REM: r.value = b ? a % b : a; break;
+        default: r.value = simd(op_of(ir), a, b); break;
+        }
+        break;
+    case RM_ALU:
+        switch (op_of(ir)) {
+        case OP_ADDI: r.value = a + imm; break;
+        case OP_SUBI: r.value = a - imm; break;
+        case OP_SLTI: r.value = a < imm; break;
+        }
+        break;
+    case LOAD:
+        r.load = true;
+        r.addr = a + imm;
+        r.perf = is_perf(r.addr) && !is_csr(r.addr);
+        r.value = is_csr(r.addr) ? read_csr(r.addr) : r.perf ? 0 : dmem[r.addr & (dmem.size() - 1)];
+        break;
+    case STORE:
+        r.store = true;
+        r.addr = a + imm;
+        r.data = b;
+        r.perf = is_perf(r.addr) && !is_csr(r.addr);
+        if (is_csr(r.addr)) write_csr(r.addr, b);
+        else if (!r.perf) dmem[r.addr & (dmem.size() - 1)] = b;
+        break;
+    case BRANCH:
+        r.branch = op_of(ir) != OP_LOOP;
+        switch (op_of(ir)) {
+        case OP_BEQZ: r.taken = a == 0; if (r.taken) next = pc + 1 + imm; break;
+        case OP_BNEQZ: r.taken = a != 0; if (r.taken) next = pc + 1 + imm; break;
+        case OP_JR: r.taken = true; next = a; break;
+        case OP_ERET: r.taken = true; next = epc; status &= ~STATUS_EXL; break;
+        case OP_LOOP: loop_start = pc + 1; loop_end = pc + 1 + imm; loop_count = a; break;
+        default: r.taken = true; r.value = pc + 1; next = jump_target(ir, pc); break;   // J , JAL (links in R31)
+        }
+        break;
+    default:
+        halted = true;
+        break;
+    }
+
+    // the body's last instruction counts an iteration , IF follows it to the
+    // start while there are more
+    if (loop_count && pc == loop_end) {
+        r.loop_tail = true;
+        if (--loop_count) {
+            r.looped = true;
+            next = loop_start;
+        }
+    }
+
+    r.dest = dest_of(ir);
+    if (r.dest >= 0) reg[r.dest] = r.value;
+    r.next_pc = next;
+    pc = next;
+    retired++;
+    return r;
+}
+
+uint64_t Iss::run(uint64_t max_steps) {
+    const uint64_t start = retired;
+    for (uint64_t n = 0; !halted && n < max_steps; n++) step();
+    return retired - start;
+}
+
+Timing::Timing(const TimingConfig &c, const std::vector<uint32_t> &im)
+    : cfg(c), imem(im), btb_valid(c.btb_entries, false), btb_tag(c.btb_entries, 0),
+      btb_target(c.btb_entries, 0), pht(c.pht_entries, 1), ras(c.ras_entries, 0) {}
+
+void Timing::train(const Train &t) {
+    uint8_t &ctr = pht[t.pc & (cfg.pht_entries - 1)];
+    if (t.taken) {
+        if (ctr != 3) ctr++;
+        unsigned i = t.pc & (cfg.btb_entries - 1);
+        btb_valid[i] = true;
+        btb_tag[i] = t.pc / cfg.btb_entries;
+        btb_target[i] = t.target;
+    } else if (ctr != 0) {
+        ctr--;
+    }
+}
+
+bool Timing::predict(uint32_t pc, uint32_t *target) const {
+    unsigned i = pc & (cfg.btb_entries - 1);
+    bool hit = btb_valid[i] && btb_tag[i] == pc / cfg.btb_entries;
+    *target = btb_target[i];
+    return cfg.bpred && hit && (pht[pc & (cfg.pht_entries - 1)] & 2);
+}
+
+// First clk2 period whose ID may take r past the MDU scoreboard : every
+// register it reads or writes written back , the divider free for a divide
+// and the whole unit empty for HLT.
+uint64_t Timing::mdu_wait(const Retired &r) const {
+    uint64_t p = 0;
+    auto need = [&](unsigned reg) { if (reg && reg_ready[reg] > p) p = reg_ready[reg]; };
+    if (uses_rs(r.ir)) need(rs_of(r.ir));
+    if (uses_rt(r.ir)) need(rt_of(r.ir));
+    if (dest_of(r.ir) > 0) need(dest_of(r.ir));
+    if (is_div(r.ir) && div_write > p) p = div_write;
+    if (type_of(r.ir) == HALT && mdu_drain > p) p = mdu_drain;
+    // a squashed MDU op left in ID_EX still claims its rd for one period
+    if (ahead_wrong && to_mdu(ahead_ir) && rd_of(ahead_ir)) {
+        unsigned d = rd_of(ahead_ir);
+        if ((uses_rs(r.ir) && rs_of(r.ir) == d) || (uses_rt(r.ir) && rt_of(r.ir) == d) || dest_of(r.ir) == (int)d)
+            p = std::max(p, next_fetch + 1);
+    }
+    return p;
+}
+
+static bool reads(uint32_t ir, int reg) {
+    return reg > 0 && ((uses_rs(ir) && (int)rs_of(ir) == reg) || (uses_rt(ir) && (int)rt_of(ir) == reg));
+}
+
+// DUAL_ISSUE : r issues beside pair_ir when it is a simple ALU op that
+// neither reads nor writes pair_ir's destination , is clear of the MDU
+// scoreboard by then and , without forwarding , of the pair one ahead.
+bool Timing::pairs_with(const Retired &r) const {
+    if (!pair_open || !second_slot(r.ir) || r.loop_tail) return false;   // a loop's last word is fetched alone
+    int d = dest_of(pair_ir);
+    if (reads(r.ir, d) || (d > 0 && dest_of(r.ir) == d)) return false;
+    if (mdu_wait(r) > pair_period) return false;
+    return cfg.forwarding || !((pair_ahead_valid && !to_mdu(pair_ahead_ir) && reads(r.ir, dest_of(pair_ahead_ir))) ||
+                               (pair_ahead2_valid && reads(r.ir, dest_of(pair_ahead2_ir))));
+}
+
+// MDU op leaving EX on clk1 edge e : a multiply writes back MUL_LATENCY edges
+// later , a divide 33 edges later or after that if the multiplier has the port.
+void Timing::mdu_issue(uint32_t ir, uint64_t e) {
+    uint64_t w;
+    if (is_div(ir)) {
+        w = e + 33;
+        while (std::find(mul_writes.begin(), mul_writes.end(), w) != mul_writes.end()) w++;
+        div_write = w;
+        div_dest = rd_of(ir);
+    } else {
+        w = e + cfg.mul_latency;
+        mul_writes.push_back(w);
+        if (w == div_write && w > e) {
+            while (std::find(mul_writes.begin(), mul_writes.end(), div_write) != mul_writes.end()) div_write++;
+            reg_ready[div_dest] = div_write;
+            mdu_drain = std::max(mdu_drain, div_write);
+        }
+        mul_writes.erase(std::remove_if(mul_writes.begin(), mul_writes.end(), [&](uint64_t x) { return x <= e; }),
+                         mul_writes.end());
+    }
+    reg_ready[rd_of(ir)] = w;
+    mdu_drain = std::max(mdu_drain, w);
+}
+
+void Timing::retire(const Retired &r) {
+    const uint64_t f = next_fetch;
+    if (r.trap && cfg.single_clock) {
+        // MIPS_1clk traps as the reserved instruction leaves WB , four edges
+        // after its fetch : it and the three behind it are squashed
+        flush_slots += 4;
+        next_fetch = f + 5;
+        ahead_valid = false;
+        return;
+    }
+    if (r.trap) {
+        // MIPS flushes the reserved instruction from EX_MEM and fetches the
+        // handler two edges after it , the slot between is squashed
+        flush_slots++;
+        next_fetch = f + 2;
+        ahead_valid = ahead2_valid = pair_open = false;
+        return;
+    }
+    instructions++;
+
+    if (cfg.single_clock) {
+        // load one ahead feeding this instruction : one bubble in ID
+        int d = ahead_valid ? dest_of(ahead_ir) : -1;
+        bool stall = ahead_valid && type_of(ahead_ir) == LOAD && d > 0 &&
+                     ((uses_rs(r.ir) && (int)rs_of(r.ir) == d) || (uses_rt(r.ir) && (int)rt_of(r.ir) == d));
+        stalls += stall;
+        // LOOP sets up from EX and refetches the body like a taken branch
+        uint64_t lost = ((r.branch && r.taken) || op_of(r.ir) == OP_LOOP) ? 2 : 0;
+        uint64_t div = is_div(r.ir) ? 33 : 0;   // EX holds while the divider runs
+        flush_slots += lost;
+        mdu_stalls += div;
+        // BP_BRANCHES counts BEQZ / BNEQZ / JR as MIPS does , not J / JAL
+        branches += r.branch && !is_jump(r.ir);
+        predicted += r.branch && !is_jump(r.ir) && !r.taken;
+        next_fetch = f + 1 + stall + lost + div;
+        if (type_of(r.ir) == HALT) halt_cycle = f + 4 + stall;
+        ahead_ir = r.ir;
+        ahead_valid = true;
+        return;
+    }
+
+    if (cfg.dual_issue && pairs_with(r)) {   // second slot : fetched and issued with pair_ir
+        pairs++;
+        pair_open = false;
+        ahead2_ir = r.ir;
+        ahead2_valid = true;
+        return;
+    }
+
+    // fetch at edge f sees the trainings of edges before f
+    while (!pending.empty() && pending.front().edge < f) {
+        train(pending.front());
+        pending.pop_front();
+    }
+    uint32_t pred_target;
+    bool pred = predict(r.pc, &pred_target);
+    // J / JAL are followed in IF , JR R31 pops the return-address stack that
+    // JAL pushes ; fetch order is program order on the right path and the
+    // RTL puts the stack pointer back after a wrong-path fetch
+    const unsigned ras_mask = cfg.ras_entries - 1;
+    if (is_jump(r.ir)) {
+        pred = true;
+        pred_target = r.next_pc;
+    } else if (cfg.ras_entries && op_of(r.ir) == OP_JR && rs_of(r.ir) == 31) {
+        ras_sp = (ras_sp - 1) & ras_mask;
+        pred = true;
+        pred_target = ras[ras_sp];
+    }
+    if (cfg.ras_entries && op_of(r.ir) == OP_JAL) {
+        ras[ras_sp] = r.pc + 1;
+        ras_sp = (ras_sp + 1) & ras_mask;
+    }
+
+    // ID compares against whatever is one ahead in ID_EX , which after a late
+    // mispredict is the squashed wrong-path instruction
+    int d = ahead_valid && !to_mdu(ahead_ir) ? dest_of(ahead_ir) : -1;
+    bool raw = reads(r.ir, d);
+    bool raw2 = ahead2_valid && reads(r.ir, dest_of(ahead2_ir));
+    const bool loop = op_of(r.ir) == OP_LOOP;
+    uint64_t stall = cfg.forwarding ? (cfg.early_branch && (r.branch || loop) && raw && type_of(ahead_ir) == LOAD)
+                                    : (raw || raw2);
+    // the scoreboard holds ID on top of that , the bubbles overlap
+    uint64_t wait = mdu_wait(r);
+    if (wait > f) {
+        mdu_stalls += wait - f;
+        stall = std::max(stall, wait - f);
+    }
+    stalls += stall;
+    if (to_mdu(r.ir)) mdu_issue(r.ir, f + stall + 1);
+    pair_ahead_ir = ahead_ir;
+    pair_ahead_valid = ahead_valid;
+    pair_ahead2_ir = ahead2_ir;
+    pair_ahead2_valid = ahead2_valid;
+    pair_ir = r.ir;
+    pair_period = f + stall;
+    pair_open = cfg.dual_issue && !r.branch && !loop && !pred && !r.looped && type_of(r.ir) != HALT && !to_mdu(r.ir);
+    ahead_ir = r.ir;
+    ahead_valid = true;
+    ahead_wrong = false;
+    ahead2_valid = false;
+
+    uint64_t next = f + 1 + stall;
+    if (r.branch && !is_jump(r.ir)) {
+        bool mispredict = pred ? (!r.taken || pred_target != r.next_pc) : r.taken;   // JR : or the wrong target
+        branches++;
+        predicted += !mispredict;
+        uint64_t edge = cfg.early_branch ? f + 1 + stall : f + 2 + stall;
+        pending.push_back({edge, r.pc, r.taken, r.next_pc});
+        if (mispredict && !cfg.early_branch) {
+            ahead_ir = imem[(pred ? pred_target : r.pc + 1) & (imem.size() - 1)];
+            ahead_wrong = true;
+            next++;
+            flush_slots++;
+        }
+    }
+    // LOOP sets up from EX_MEM and refetches the body's start , it is free
+    // from ID ; going back at the end of the body is always free
+    if (loop && !cfg.early_branch) {
+        ahead_ir = imem[(r.pc + 1) & (imem.size() - 1)];
+        ahead_wrong = true;
+        next++;
+        flush_slots++;
+    }
+    next_fetch = next;
+    if (type_of(r.ir) == HALT) halt_cycle = f + 2 + stall;
+}
+
+} // namespace mips
@@ -0,0 +1,143 @@
+// Instruction-set simulator for the MIPS.v ISA , the golden model for the
+// RTL, plus an optional cycle model of the pipelines.
+#ifndef MIPS_ISS_H
+#define MIPS_ISS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "checkpoint.h"
+#include "mips_isa.h"
+
+namespace mips {
+
+// One executed instruction, in program order.
+struct Retired {
+    uint32_t pc = 0, ir = 0;
+    int dest = -1;          // register written , -1 for none
+    uint32_t value = 0;     // value written to dest
+    bool load = false, store = false;
+    uint32_t addr = 0;      // data word address of a load / store
+    uint32_t data = 0;      // word stored
+    bool perf = false;      // load / store in the counter range : loads read 0 here , stores are dropped
+    bool branch = false, taken = false;
+    uint32_t next_pc = 0;
+    bool trap = false;      // nothing retired : the reserved instruction at pc trapped to next_pc
+    bool loop_tail = false; // last instruction of an active hardware loop ...
+    bool looped = false;    // ... and the body runs again , next_pc is its start
+};
+
+class Iss {
+public:
+    // Memory sizes are in words and must be powers of two ; addresses wrap
+    // the way IMEM / DMEM index them.
+    explicit Iss(size_t imem_words = 1024, size_t dmem_words = 1024);
+
+    // Back to PC 0 and running , trap and loop registers cleared. Registers and
+    // memories are kept, as the RTL reset leaves Reg[] and Mem[] alone.
+    void reset();
+    Retired step();
+    // Steps until HLT (or max_steps) , returns the number of instructions.
+    uint64_t run(uint64_t max_steps);
+    // The external interrupt , between the last step and the next : taken
+    // (EPC = pc , pc = exc_vector) when STATUS has IE set and EXL clear.
+    bool interrupt();
+    // The state at pc as a checkpoint (checkpoint.h) , and back. restore()
+    // fails (with *err) when the memory sizes are not the checkpoint's.
+    void save(Checkpoint &ck) const;
+    bool restore(const Checkpoint &ck, std::string *err = nullptr);
+
+    uint32_t read_reg(unsigned r) const { return r ? reg[r] : 0; }
+
+    std::vector<uint32_t> imem, dmem;
+    uint32_t reg[32];   // reg[0] is written like any other but always reads 0
+    uint32_t pc = 0;
+    bool halted = false;
+    uint64_t retired = 0;
+    uint32_t status = 0, cause = 0, epc = 0;   // trap registers (CSR_*)
+    uint32_t exc_vector = EXC_VECTOR;
+    uint64_t traps = 0;
+    uint32_t loop_start = 0, loop_end = 0, loop_count = 0;   // hardware loop (LOOP) , off at count 0
+
+private:
+    void trap(uint32_t code);
+    uint32_t read_csr(uint32_t addr) const;
+    void write_csr(uint32_t addr, uint32_t v);
+};
+
+// Cycle model of the pipelines without caches. Feed it every retired
+// instruction in order ; cycles() then counts what the Verilator harness
+// counts , clk1 periods (two-phase) or clk periods (single clock) from the
+// first fetch after reset until HALTED. It follows the RTL's stage timing as
+// written down here ; test_iss checks it against hand-counted pipelines , not
+// against a simulation of the RTL.
+struct TimingConfig {
+    bool single_clock = false;   // MIPS_1clk , the options below are ignored
+    bool forwarding = true;      // FORWARDING
+    bool bpred = true;           // BPRED
+    unsigned btb_entries = 16;   // BTB_ENTRIES
+    unsigned pht_entries = 64;   // PHT_ENTRIES
+    bool early_branch = false;   // EARLY_BRANCH
+    unsigned ras_entries = 8;    // RAS_ENTRIES , 0 or a power of two
+    unsigned mul_latency = 0;    // MUL_LATENCY , DIV / REM always go to the MDU
+    bool dual_issue = false;     // DUAL_ISSUE
+};
+
+class Timing {
+public:
+    Timing(const TimingConfig &cfg, const std::vector<uint32_t> &imem);
+    void retire(const Retired &r);
+    uint64_t cycles() const { return halt_cycle; }
+
+    uint64_t instructions = 0;
+    uint64_t stalls = 0;          // STALL_CYCLES
+    uint64_t branches = 0;        // BP_BRANCHES
+    uint64_t predicted = 0;       // BP_HITS
+    uint64_t flush_slots = 0;     // fetch slots lost to branches
+    uint64_t mdu_stalls = 0;      // MDU_STALLS
+    uint64_t pairs = 0;           // ISSUE_PAIRS
+
+private:
+    struct Train { uint64_t edge; uint32_t pc; bool taken; uint32_t target; };
+    void train(const Train &t);
+    bool predict(uint32_t pc, uint32_t *target) const;
+    bool to_mdu(uint32_t ir) const { return is_div(ir) || (cfg.mul_latency && op_of(ir) == OP_MUL); }
+    uint64_t mdu_wait(const Retired &r) const;
+    void mdu_issue(uint32_t ir, uint64_t edge);
+    bool pairs_with(const Retired &r) const;
+
+    TimingConfig cfg;
+    const std::vector<uint32_t> &imem;
+    uint64_t next_fetch = 1;      // edge the next instruction is fetched on
+    uint64_t halt_cycle = 0;
+    uint32_t ahead_ir = 0;        // instruction one ahead in ID_EX
+    bool ahead_valid = false;
+    bool ahead_wrong = false;     // ahead_ir is a squashed wrong-path instruction
+    uint32_t ahead2_ir = 0;       // second slot of the pair one ahead
+    bool ahead2_valid = false;
+    // DUAL_ISSUE : the instruction in the first slot , still open for a
+    // partner , the clk2 period ID issues it and the pair one ahead of it then
+    bool pair_open = false;
+    uint32_t pair_ir = 0, pair_ahead_ir = 0, pair_ahead2_ir = 0;
+    bool pair_ahead_valid = false, pair_ahead2_valid = false;
+    uint64_t pair_period = 0;
+    // MDU scoreboard : clk1 edge each register's result is written back ,
+    // the edges the multiplier writes on , and the divide still in flight
+    uint64_t reg_ready[32] = {};
+    std::vector<uint64_t> mul_writes;
+    uint64_t div_write = 0, mdu_drain = 0;
+    int div_dest = 0;
+    std::vector<bool> btb_valid;
+    std::vector<uint32_t> btb_tag, btb_target;
+    std::vector<uint8_t> pht;
+    std::deque<Train> pending;    // trainings not yet visible to fetch
+    std::vector<uint32_t> ras;    // return-address stack , ras_sp is the next free entry
+    unsigned ras_sp = 0;
+};
+
+} // namespace mips
+
+#endif
@@ -0,0 +1,157 @@
+// mips_iss : runs a $readmemh program on the instruction-set simulator.
+//
+//   mips_iss prog.hex [--dmem data.hex] [--imem-depth N] [--dmem-depth N]
+//            [--max N] [--mem ADDR:WORDS] [--trace] [--save FILE] [--compare FILE]
+//   mips_iss --restore FILE [--max N] ...
+//            [--timing two-phase|single] [--no-forwarding] [--no-bpred]
+//            [--early-branch] [--btb N] [--pht N] [--ras N] [--mul-latency N] [--dual-issue]
+//
+// Prints the registers (same layout as the Verilator harness), the requested
+// data words, the instruction count and the host speed. With --timing the
+// cycle model of the chosen pipeline also gives cycles, CPI, stalls and
+// branch statistics.
+// --save writes a checkpoint (tools/checkpoint.h) of where the run stopped ,
+// at HLT or after --max instructions , for the Verilator harness or
+// mips_iss --restore to go on from ; a restored run takes the memories and
+// sizes from the checkpoint and --max counts from there. --compare checks
+// where the run stopped against a checkpoint , e.g. the end of a full run
+// against the end of a fast-forwarded one (make ffwd-check). Exit status is
+// 0 only when the program halted , or the checkpoint was written , and
+// --compare found nothing.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "checkpoint.h"
+#include "hexfile.h"
+#include "iss.h"
+
+static void usage() {
+    fprintf(stderr, "usage: mips_iss prog.hex [--dmem data.hex] [--imem-depth N] [--dmem-depth N] [--max N]\n"
+                    "                [--mem ADDR:WORDS] [--trace] [--timing two-phase|single]\n"
+                    "                [--no-forwarding] [--no-bpred] [--early-branch] [--btb N] [--pht N] [--ras N]\n"
+                    "                [--mul-latency N] [--dual-issue] [--save FILE] [--compare FILE]\n"
+                    "       mips_iss --restore FILE [options]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    std::string prog, data, timing, save, restore, compare;
+    size_t imem_depth = 1024, dmem_depth = 1024;
+    uint64_t max = 1000000000ull;
+    long mem_base = 0, mem_words = 0;
+    bool trace = false;
+    mips::TimingConfig tc;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> const char * { if (i + 1 >= argc) usage(); return argv[++i]; };
+        if (a == "--dmem") data = next();
+        else if (a == "--imem-depth") imem_depth = strtoul(next(), nullptr, 0);
+        else if (a == "--dmem-depth") dmem_depth = strtoul(next(), nullptr, 0);
+        else if (a == "--max") max = strtoull(next(), nullptr, 0);
+        else if (a == "--mem") { if (sscanf(next(), "%li:%li", &mem_base, &mem_words) != 2) usage(); }
+        else if (a == "--trace") trace = true;
+        else if (a == "--timing") timing = next();
+        else if (a == "--save") save = next();
+        else if (a == "--restore") restore = next();
+        else if (a == "--compare") compare = next();
+        else if (a == "--no-forwarding") tc.forwarding = false;
+        else if (a == "--no-bpred") tc.bpred = false;
+        else if (a == "--early-branch") tc.early_branch = true;
+        else if (a == "--btb") tc.btb_entries = strtoul(next(), nullptr, 0);
+        else if (a == "--pht") tc.pht_entries = strtoul(next(), nullptr, 0);
+        else if (a == "--ras") tc.ras_entries = strtoul(next(), nullptr, 0);
+        else if (a == "--mul-latency") tc.mul_latency = strtoul(next(), nullptr, 0);
+        else if (a == "--dual-issue") tc.dual_issue = true;
+        else if (a[0] != '-' && prog.empty()) prog = a;
+        else usage();
+    }
+    if (prog.empty() == restore.empty() || (!timing.empty() && timing != "two-phase" && timing != "single")) usage();
+    tc.single_clock = (timing == "single");
+
+    mips::Checkpoint ck;
+    std::string err;
+    if (!restore.empty()) {
+        if (!mips::load_checkpoint(restore, ck, &err)) {
+            fprintf(stderr, "%s\n", err.c_str());
+            return 2;
+        }
+        imem_depth = ck.imem.size();
+        dmem_depth = ck.dmem.size();
+    }
+    mips::Iss iss(imem_depth, dmem_depth);
+    if (!restore.empty()) {
+        iss.restore(ck);
+    } else if (!mips::load_hex(prog, iss.imem, &err) || (!data.empty() && !mips::load_hex(data, iss.dmem, &err))) {
+        fprintf(stderr, "%s\n", err.c_str());
+        return 2;
+    }
+    const uint64_t start = iss.retired, start_steps = iss.retired + iss.traps;
+    mips::Timing model(tc, iss.imem);
+
+    auto t0 = std::chrono::steady_clock::now();
+    if (timing.empty() && !trace) {
+        iss.run(max);
+    } else {
+        while (!iss.halted && iss.retired + iss.traps < start_steps + max) {
+            mips::Retired r = iss.step();
+            if (!timing.empty()) model.retire(r);
+            if (trace) {
+                printf("%08x: %08x", r.pc, r.ir);
+                if (r.trap) printf("  trap -> %08x", r.next_pc);
+                if (r.dest >= 0) printf("  R%d = %08x", r.dest, r.value);
+                if (r.store) printf("  Mem[%u] = %08x", r.addr, r.data);
+                if (r.branch) printf("  %s", r.taken ? "taken" : "not taken");
+                printf("\n");
+            }
+        }
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    for (int r = 0; r < 32; r++)
+        printf("R%-2d = %08x (%d)%s", r, iss.reg[r], (int)iss.reg[r], (r % 4 == 3) ? "\n" : "   ");
+    for (long a = mem_base; a < mem_base + mem_words; a++) {
+        uint32_t w = iss.dmem[a & (dmem_depth - 1)];
+        printf("Mem[%ld] = %08x (%d)\n", a, w, (int)w);
+    }
+    printf("%s after %llu instructions", iss.halted ? "HALTED" : "NOT HALTED", (unsigned long long)iss.retired);
+    if (!restore.empty()) printf(" (%llu from the checkpoint)", (unsigned long long)start);
+    printf("\n");
+    if (!timing.empty())
+        printf("%s model : %llu cycles , CPI %.2f , %llu stall cycles (%llu MDU) , %llu / %llu branches predicted , "
+               "%llu flushed slots\n",
+               timing.c_str(), (unsigned long long)model.cycles(),
+               iss.retired > start ? (double)model.cycles() / (iss.retired - start) : 0.0, (unsigned long long)model.stalls,
+               (unsigned long long)model.mdu_stalls, (unsigned long long)model.predicted,
+               (unsigned long long)model.branches, (unsigned long long)model.flush_slots);
+    if (!timing.empty() && tc.dual_issue) printf("%llu pairs issued\n", (unsigned long long)model.pairs);
+    printf("%.3f s , %.1f MIPS\n", secs, secs > 0 ? (iss.retired - start) / secs / 1e6 : 0.0);
+
+    if (!compare.empty()) {
+        mips::Checkpoint ref, now;
+        if (!mips::load_checkpoint(compare, ref, &err)) {
+            fprintf(stderr, "%s\n", err.c_str());
+            return 2;
+        }
+        iss.save(now);
+        std::vector<std::string> diff = mips::checkpoint_diff(now, ref);
+        if (now.retired != ref.retired) diff.push_back("retired " + std::to_string(now.retired) + " / " + std::to_string(ref.retired));
+        for (size_t k = 0; k < diff.size() && k < 8; k++) printf("MISMATCH against %s : %s\n", compare.c_str(), diff[k].c_str());
+        if (!diff.empty()) return 1;
+        printf("same state as %s\n", compare.c_str());
+    }
+    if (!save.empty()) {
+        iss.save(ck);
+        if (!mips::save_checkpoint(save, ck)) {
+            fprintf(stderr, "cannot write %s\n", save.c_str());
+            return 2;
+        }
+        printf("checkpoint %s : pc %u after %llu instructions\n", save.c_str(), iss.pc, (unsigned long long)iss.retired);
+        return 0;
+    }
+    return iss.halted ? 0 : 1;
+}
@@ -0,0 +1,159 @@
+// Instruction set of MIPS.v / MIPS_1clk.v for the host tools.
+//
+// Every instruction is one 32-bit word, the PC counts words:
+//   [31:26] opcode  [25:21] rs  [20:16] rt  [15:11] rd  [15:0] imm (signed)
+// Register-register ops write rd, immediate ops and LW write rt, SW stores
+// rt, BEQZ / BNEQZ test rs and branch to NPC + imm. J / JAL jump to
+// {NPC[31:26] , ir[25:0]} , JAL writing NPC to R31 , and JR jumps to rs.
+// ERET returns from a trap to EPC. Any opcode not listed is a reserved
+// instruction : it traps to EXC_VECTOR with EPC at it. SLT / SLTI compare unsigned, as the RTL does, and so do
+// DIV / REM, with x / 0 = 0xffffffff and x % 0 = x.
+// The packed ops are register-register ops on four bytes (..B) or two
+// halfwords (..H) in each word, lane by lane : ADD / SUB wrap, ADDUS
+// saturates at the lane's maximum, CMPEQ / CMPLT (unsigned) give an
+// all-ones lane when true. SUMB adds the four bytes of rs to rt.
+// LOOP rs, end sets up a hardware loop over the instructions after it up to
+// and including end : the body runs rs times (once for rs = 0) and IF goes
+// back to its start with no branch. The last instruction of a body must not
+// be a branch, jump, LOOP or HLT and loops do not nest ; a trap handler must
+// not use LOOP.
+#ifndef MIPS_ISA_H
+#define MIPS_ISA_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mips {
+
+enum Opcode : uint32_t {
+    OP_ADD = 0x00, OP_SUB = 0x01, OP_AND = 0x02, OP_OR = 0x03, OP_SLT = 0x04, OP_MUL = 0x05,
+    OP_DIV = 0x06, OP_REM = 0x07,
+    OP_LW = 0x08, OP_SW = 0x09, OP_ADDI = 0x0a, OP_SUBI = 0x0b, OP_SLTI = 0x0c,
+    OP_BNEQZ = 0x0d, OP_BEQZ = 0x0e, OP_J = 0x10, OP_JAL = 0x11, OP_JR = 0x12, OP_ERET = 0x13,
+    OP_ADDB = 0x14, OP_SUBB = 0x15, OP_ADDH = 0x16, OP_SUBH = 0x17, OP_ADDUSB = 0x18, OP_ADDUSH = 0x19,
+    OP_CMPEQB = 0x1a, OP_CMPEQH = 0x1b, OP_CMPLTB = 0x1c, OP_CMPLTH = 0x1d, OP_SUMB = 0x1e,
+    OP_LOOP = 0x1f,
+    OP_HLT = 0x3f,
+};
+
+// performance counters , read-only at PERF_BASE + n (see MIPS.v)
+const uint32_t PERF_BASE = 0xffffff00, PERF_WORDS = 16;
+enum PerfCounter {
+    PERF_CYCLES = 0, PERF_RETIRED = 1, PERF_BRANCH_FLUSHES = 2, PERF_STALL_CYCLES = 3,
+    PERF_MEM_STALLS = 4, PERF_FETCH_STALLS = 5, PERF_BP_BRANCHES = 6, PERF_BP_HITS = 7,
+    PERF_MDU_STALLS = 8, PERF_ISSUE_PAIRS = 9, PERF_TRAPS = 10,
+    PERF_LB_HITS = 14,           // fetches served by the loop buffer , IMEM / I-cache not read
+    PERF_FQ_STALLS_HIDDEN = 15,  // I-cache miss cycles ID still took from the fetch queue
+};
+inline bool is_perf(uint32_t addr) { return (addr & ~(PERF_WORDS - 1)) == PERF_BASE; }
+
+// trap registers , in the same window : STATUS and EPC are also writable
+enum Csr { CSR_STATUS = 11, CSR_CAUSE = 12, CSR_EPC = 13 };
+const uint32_t STATUS_IE = 1, STATUS_EXL = 2;   // interrupts enabled , in a trap handler
+const uint32_t CAUSE_INT = 0, CAUSE_RI = 10;    // CAUSE : interrupt , reserved instruction
+const uint32_t EXC_VECTOR = 0x100;              // EXC_VECTOR , the handler's word address
+inline bool is_csr(uint32_t addr) {
+    return is_perf(addr) && (addr - PERF_BASE) >= CSR_STATUS && (addr - PERF_BASE) <= CSR_EPC;
+}
+
+// pipeline TYPE codes of the RTL
+enum Type { RR_ALU = 0, RM_ALU = 1, LOAD = 2, STORE = 3, BRANCH = 4, HALT = 5, NOP = 6 };
+
+inline uint32_t op_of(uint32_t ir) { return ir >> 26; }
+inline unsigned rs_of(uint32_t ir) { return (ir >> 21) & 31; }
+inline unsigned rt_of(uint32_t ir) { return (ir >> 16) & 31; }
+inline unsigned rd_of(uint32_t ir) { return (ir >> 11) & 31; }
+inline uint32_t imm_of(uint32_t ir) { return (uint32_t)(int32_t)(int16_t)(ir & 0xffff); }
+inline bool is_simd(uint32_t ir) { return op_of(ir) >= OP_ADDB && op_of(ir) <= OP_SUMB; }
+// J / JAL : the target is in the word , IF follows it without prediction
+inline bool is_jump(uint32_t ir) { return op_of(ir) == OP_J || op_of(ir) == OP_JAL; }
+inline uint32_t jump_target(uint32_t ir, uint32_t pc) { return ((pc + 1) & 0xfc000000) | (ir & 0x03ffffff); }
+
+inline Type type_of(uint32_t ir) {
+    switch (op_of(ir)) {
+    case OP_ADD: case OP_SUB: case OP_AND: case OP_OR: case OP_SLT: case OP_MUL:
+    case OP_DIV: case OP_REM: return RR_ALU;
+    case OP_ADDB: case OP_SUBB: case OP_ADDH: case OP_SUBH: case OP_ADDUSB: case OP_ADDUSH:
+    case OP_CMPEQB: case OP_CMPEQH: case OP_CMPLTB: case OP_CMPLTH: case OP_SUMB: return RR_ALU;
+    case OP_ADDI: case OP_SUBI: case OP_SLTI: return RM_ALU;
+    case OP_LW: return LOAD;
+    case OP_SW: return STORE;
+    case OP_BNEQZ: case OP_BEQZ: case OP_J: case OP_JAL: case OP_JR: case OP_ERET: case OP_LOOP: return BRANCH;
+    default: return HALT;
+    }
+}
+
+inline bool is_reserved(uint32_t ir) { return type_of(ir) == HALT && op_of(ir) != OP_HLT; }
+
+// destination register, -1 if the instruction writes none
+inline int dest_of(uint32_t ir) {
+    switch (type_of(ir)) {
+    case RR_ALU: return (int)rd_of(ir);
+    case RM_ALU: case LOAD: return (int)rt_of(ir);
+    case BRANCH: return op_of(ir) == OP_JAL ? 31 : -1;
+    default: return -1;
+    }
+}
+
+inline bool uses_rs(uint32_t ir) { return op_of(ir) != OP_HLT && op_of(ir) != OP_ERET && !is_jump(ir); }
+inline bool uses_rt(uint32_t ir) { return type_of(ir) == RR_ALU || type_of(ir) == STORE; }
+inline bool is_div(uint32_t ir) { return op_of(ir) == OP_DIV || op_of(ir) == OP_REM; }
+// may issue in the second slot of a pair (MIPS DUAL_ISSUE) : single-cycle ALU ops
+inline bool second_slot(uint32_t ir) {
+    return (type_of(ir) == RR_ALU && op_of(ir) != OP_MUL && !is_div(ir)) || type_of(ir) == RM_ALU;
+}
+
+// operand layout of each mnemonic , for the assembler and disassembler
+enum Format {
+    F_RRR,     // rd, rs, rt
+    F_RRI,     // rt, rs, imm
+    F_MEM,     // rt, imm(rs)
+    F_BRANCH,  // rs, target       imm = target - NPC
+    F_JUMP,    // target           ir[25:0] = target
+    F_JR,      // rs
+    F_NONE,
+};
+
+struct OpInfo {
+    const char *name;
+    uint32_t op;
+    Format fmt;
+};
+
+inline const OpInfo *op_table(size_t *count) {
+    static const OpInfo table[] = {
+        {"ADD", OP_ADD, F_RRR},     {"SUB", OP_SUB, F_RRR},     {"AND", OP_AND, F_RRR},   {"OR", OP_OR, F_RRR},
+        {"SLT", OP_SLT, F_RRR},     {"MUL", OP_MUL, F_RRR},     {"DIV", OP_DIV, F_RRR},   {"REM", OP_REM, F_RRR},
+        {"LW", OP_LW, F_MEM},       {"SW", OP_SW, F_MEM},
+        {"ADDI", OP_ADDI, F_RRI},   {"SUBI", OP_SUBI, F_RRI},   {"SLTI", OP_SLTI, F_RRI},
+        {"BNEQZ", OP_BNEQZ, F_BRANCH}, {"BEQZ", OP_BEQZ, F_BRANCH},
+        {"ADDB", OP_ADDB, F_RRR},   {"SUBB", OP_SUBB, F_RRR},   {"ADDH", OP_ADDH, F_RRR}, {"SUBH", OP_SUBH, F_RRR},
+        {"ADDUSB", OP_ADDUSB, F_RRR}, {"ADDUSH", OP_ADDUSH, F_RRR}, {"CMPEQB", OP_CMPEQB, F_RRR},
+        {"CMPEQH", OP_CMPEQH, F_RRR}, {"CMPLTB", OP_CMPLTB, F_RRR}, {"CMPLTH", OP_CMPLTH, F_RRR},
+        {"SUMB", OP_SUMB, F_RRR},
+        {"J", OP_J, F_JUMP},        {"JAL", OP_JAL, F_JUMP},    {"JR", OP_JR, F_JR},      {"ERET", OP_ERET, F_NONE},
+        {"LOOP", OP_LOOP, F_BRANCH},
+        {"HLT", OP_HLT, F_NONE},
+    };
+    *count = sizeof table / sizeof table[0];
+    return table;
+}
+
+inline const OpInfo *op_info(uint32_t op) {
+    size_t n;
+    const OpInfo *t = op_table(&n);
+    for (size_t i = 0; i < n; i++)
+        if (t[i].op == op) return &t[i];
+    return nullptr;
+}
+
+inline uint32_t rr(uint32_t op, unsigned rd, unsigned rs, unsigned rt) {
+    return (op << 26) | (rs << 21) | (rt << 16) | (rd << 11);
+}
+inline uint32_t ri(uint32_t op, unsigned rt, unsigned rs, int32_t imm) {
+    return (op << 26) | (rs << 21) | (rt << 16) | ((uint32_t)imm & 0xffff);
+}
+
+} // namespace mips
+
+#endif
@@ -0,0 +1,173 @@
+// Assembler regression : encodings , label and branch offset resolution ,
+// .data images , expressions and error reporting. The assembled programs are
+// run on the ISS.
+
+#include <cstdio>
+#include <string>
+
+#include "asm.h"
+#include "hexfile.h"
+#include "iss.h"
+
+using namespace mips;
+
+static int errors = 0;
+
+static void check(const char *what, uint64_t got, uint64_t expected) {
+    if (got != expected) {
+        printf("FAIL %s : 0x%llx , expected 0x%llx\n", what, (unsigned long long)got, (unsigned long long)expected);
+        errors++;
+    }
+}
+
+static void check_error(const char *what, const std::string &src, const std::string &needle) {
+    Program p;
+    if (assemble(src, "t.s", p)) {
+        printf("FAIL %s : assembled without error\n", what);
+        errors++;
+    } else if (p.errors[0].find(needle) == std::string::npos) {
+        printf("FAIL %s : '%s' , expected '%s'\n", what, p.errors[0].c_str(), needle.c_str());
+        errors++;
+    }
+}
+
+int main() {
+    // the hand-encoded words of mips_tb.v
+    Program tb;
+    bool ok = assemble("ADDI R1, R0, 10\n ADDI R2, R0, 20\n ADDI R3, R0, 25\n OR R7, R7, R7\n"
+                       "ADD R4, R1, R2\n ADD R5, R4, R3\n HLT\n", "tb.s", tb);
+    check("mips_tb.v assembles", ok, 1);
+    const uint32_t tb_words[] = {0x2801000a, 0x28020014, 0x28030019, 0x0ce73800, 0x00222000, 0x00832800, 0xfc000000};
+    for (unsigned i = 0; i < 7 && ok; i++) check("mips_tb.v word", tb.text[i], tb_words[i]);
+
+    // immediate limits : the cores sign-extend 16 bits ; 010 is ten , not octal
+    Program lim;
+    ok = assemble("ADDI R1, R0, 32767\n ADDI R2, R0, -32768\n ADDI R3, R0, 010\n ADDI R4, R0, 0x7FFF\n", "lim.s", lim);
+    check("limits assemble", ok, 1);
+    const uint32_t lim_words[] = {ri(OP_ADDI, 1, 0, 32767), ri(OP_ADDI, 2, 0, -32768), ri(OP_ADDI, 3, 0, 10),
+                                  ri(OP_ADDI, 4, 0, 32767)};
+    for (unsigned i = 0; i < 4 && ok; i++) check("limit word", lim.text[i], lim_words[i]);
+
+    // labels , branches both ways , .data , expressions , pseudo instructions
+    const char *src =
+        "        .equ  N, 4\n"
+        "        .data 16\n"
+        "vec:    .word 3, 5, 0x10, -1      ; four words\n"
+        "out:    .space 2\n"
+        "msg:    .word 'A', vec+N\n"
+        "        .text\n"
+        "start:  LI    R1, N               # count\n"
+        "        MOV   R2, R0\n"
+        "        ADDI  R3, R0, vec\n"
+        "loop:   LW    R4, 0(R3)\n"
+        "        ADD   R2, R2, R4\n"
+        "        ADDI  R3, R3, 1\n"
+        "        SUBI  R1, R1, 1\n"
+        "        BNEQZ R1, loop\n"
+        "        BEQZ  R0, done            // forward\n"
+        "        NOP\n"
+        "done:   SW    R2, out(R0)\n"
+        "        SW    R2, out+1\n"
+        "        LW    R5, msg+1(R0)\n"
+        "        HLT\n";
+    Program p;
+    ok = assemble(src, "t.s", p);
+    for (auto &e : p.errors) printf("  %s\n", e.c_str());
+    check("program assembles", ok, 1);
+    if (ok) {
+        check("data size", p.data.size(), 24);
+        check("vec[3]", p.data[19], 0xffffffff);
+        check("msg", p.data[22], 'A');
+        check("msg+1", p.data[23], 20);
+        check("symbol loop", p.symbols["loop"], 3);
+        check("BNEQZ backward", p.text[7], ri(OP_BNEQZ, 0, 1, -5));
+        check("BEQZ forward", p.text[8], ri(OP_BEQZ, 0, 0, 1));
+        check("SW label(R0)", p.text[10], ri(OP_SW, 2, 0, 20));
+        check("SW label without base", p.text[11], ri(OP_SW, 2, 0, 21));
+
+        Iss iss;
+        for (size_t i = 0; i < p.text.size(); i++) iss.imem[i] = p.text[i];
+        for (size_t i = 0; i < p.data.size(); i++) iss.dmem[i] = p.data[i];
+        iss.run(1000);
+        check("halted", iss.halted, 1);
+        check("sum", iss.reg[2], 3 + 5 + 16 - 1);
+        check("Mem[out]", iss.dmem[20], 23);
+        check("Mem[out+1]", iss.dmem[21], 23);
+        check("R5", iss.reg[5], 20);
+    }
+
+    // calls and returns
+    Program j;
+    ok = assemble("main: JAL f\n J main\nf: JR R31\n", "j.s", j);
+    check("jumps assemble", ok, 1);
+    if (ok) {
+        check("JAL", j.text[0], OP_JAL << 26 | 2);
+        check("J", j.text[1], OP_J << 26 | 0);
+        check("JR", j.text[2], rr(OP_JR, 0, 31, 0));
+    }
+    check("disassemble JAL", disassemble(OP_JAL << 26 | 40, 7) == "JAL   40", 1);
+    check("disassemble JR", disassemble(rr(OP_JR, 0, 31, 0), 0) == "JR    R31", 1);
+
+    check("disassemble SUMB", disassemble(rr(OP_SUMB, 3, 1, 2), 0) == "SUMB  R3, R1, R2", 1);
+    check("disassemble ADDUSB", disassemble(rr(OP_ADDUSB, 3, 1, 2), 0) == "ADDUSB R3, R1, R2", 1);
+
+    Program e;
+    ok = assemble("ERET\n", "e.s", e);
+    check("ERET assembles", ok && e.text[0] == OP_ERET << 26, 1);
+    check("disassemble ERET", disassemble(OP_ERET << 26, 0) == "ERET", 1);
+
+    Program lp;
+    ok = assemble("LOOP R2, end\nADDI R1, R1, 1\nend: ADD R3, R3, R1\n", "lp.s", lp);
+    check("LOOP assembles", ok && lp.text[0] == ri(OP_LOOP, 0, 2, 1), 1);
+    check("disassemble LOOP", disassemble(ri(OP_LOOP, 0, 2, 1), 0) == "LOOP  R2, 2", 1);
+
+    check("disassemble branch", disassemble(ri(OP_BNEQZ, 0, 1, -3), 5) == "BNEQZ R1, 3", 1);
+    check("disassemble load", disassemble(ri(OP_LW, 4, 2, 8), 0) == "LW    R4, 8(R2)", 1);
+
+    check_error("undefined label", "BEQZ R1, nowhere\n", "undefined symbol 'nowhere'");
+    check_error("bad register", "ADD R1, R2, R32\n", "bad register 'R32'");
+    check_error("immediate range", "ADDI R1, R0, 70000\n", "does not fit in 16 bits");
+    check_error("immediate sign", "LI R1, 40000\n", "does not fit in 16 bits");
+    check_error("offset sign", "LW R2, 0xfff0(R0)\n", "does not fit in 16 bits");
+    check_error("immediate low", "ADDI R1, R0, -32769\n", "does not fit in 16 bits");
+    check_error("decimal only", "ADDI R1, R0, 09x\n", "bad number '09x'");
+    check_error("decimal overflow", "LI R1, 18446744073709551616\n", "number '18446744073709551616' out of range");
+    check_error("hex overflow", "LI R1, 0x1FFFFFFFFFFFFFFFF\n", "out of range");
+    check_error("wider than a word", ".word 0x100000000\n", "out of range");
+    check_error("branch range", "BEQZ R0, far\n .org 40000\nfar: HLT\n", "branch target out of range");
+    check_error("jump range", "J -1\n", "jump target out of range");
+    check_error("operand count", "ADD R1, R2\n", "ADD takes 3 operands");
+    check_error("unknown mnemonic", "JMP R1\n", "unknown instruction 'JMP'");
+    check_error("duplicate label", "a: HLT\na: HLT\n", "duplicate symbol 'a'");
+    check_error("overlap", "HLT\n .org 0\n HLT\n", "overlaps");
+    check_error("instruction in data", ".data\n ADD R1, R1, R1\n", "instruction in the .data section");
+
+    // $readmemh images : a word of more than 8 hex digits (or none) is an
+    // error with its line , not an exception or a silently cut word
+    const char *hex_cases[][3] = {
+        {"ok", "// c\n@2 dead_beef\n00000001\n", ""},
+        {"9 digits", "00000000\n123456789\n", "t.hex:2: bad word '123456789'"},
+        {"20 digits", "ffffffffffffffffffff\n", "t.hex:1: bad word 'ffffffffffffffffffff'"},
+        {"underscores only", "@_\n", "t.hex:1: bad word '_'"},
+        {"bad character", "12g4\n", "t.hex:1: bad character 'g'"},
+    };
+    for (auto &hc : hex_cases) {
+        FILE *f = fopen("t.hex", "w");
+        fputs(hc[1], f);
+        fclose(f);
+        std::vector<uint32_t> mem(8, 0);
+        std::string err;
+        bool loaded = load_hex("t.hex", mem, &err);
+        check(hc[0], loaded, !*hc[2]);
+        if (*hc[2] && err != hc[2]) {
+            printf("FAIL %s : '%s' , expected '%s'\n", hc[0], err.c_str(), hc[2]);
+            errors++;
+        }
+        if (!*hc[2]) check("hex words", mem[2] == 0xdeadbeef && mem[3] == 1, 1);
+    }
+    remove("t.hex");
+
+    if (errors == 0) printf("PASS\n");
+    else printf("FAIL : %d mismatches\n", errors);
+    return errors != 0;
+}
@@ -0,0 +1,345 @@
+// ISS regression : the program of mips_1clk_tb.v and the loop kernel of
+// sim/loop.hex must end in the same state as the RTL testbenches expect, and
+// the cycle model must charge the documented penalties. A checkpoint must
+// give the run it was taken from back.
+
+#include <cstdio>
+#include <vector>
+
+#include "hexfile.h"
+#include "iss.h"
+
+using namespace mips;
+
+static int errors = 0;
+
+static void check(const char *what, uint64_t got, uint64_t expected) {
+    if (got != expected) {
+        printf("FAIL %s : %llu , expected %llu\n", what, (unsigned long long)got, (unsigned long long)expected);
+        errors++;
+    }
+}
+
+static uint64_t cycles_of(const std::vector<uint32_t> &prog, TimingConfig tc,
+                          uint64_t *branches = nullptr, uint64_t *flush_slots = nullptr, uint64_t *mdu_stalls = nullptr) {
+    Iss iss;
+    for (size_t i = 0; i < prog.size(); i++) iss.imem[i] = prog[i];
+    Timing t(tc, iss.imem);
+    while (!iss.halted && iss.retired + iss.traps < 100000) t.retire(iss.step());
+    if (branches) *branches = t.branches;
+    if (flush_slots) *flush_slots = t.flush_slots;
+    if (mdu_stalls) *mdu_stalls = t.mdu_stalls;
+    return t.cycles();
+}
+
+int main() {
+    // every opcode , as in mips_1clk_tb.v
+    std::vector<uint32_t> all = {
+        ri(OP_ADDI, 1, 0, 5),   ri(OP_ADDI, 2, 0, 3),   rr(OP_ADD, 3, 1, 2),    rr(OP_SUB, 4, 1, 2),
+        rr(OP_AND, 5, 1, 2),    rr(OP_OR, 6, 1, 2),     rr(OP_SLT, 7, 2, 1),    rr(OP_MUL, 8, 1, 2),
+        ri(OP_SLTI, 9, 1, 4),   ri(OP_SUBI, 10, 8, 1),  ri(OP_SW, 8, 1, 50),    ri(OP_LW, 11, 1, 50),
+        rr(OP_ADD, 12, 11, 11), ri(OP_BEQZ, 0, 9, 1),   ri(OP_ADDI, 13, 0, 99), ri(OP_BNEQZ, 0, 9, 1),
+        ri(OP_ADDI, 14, 0, 7),  rr(OP_ADD, 15, 15, 14), ri(OP_SUBI, 14, 14, 1), ri(OP_BNEQZ, 0, 14, -3),
+        ri(OP_SW, 15, 0, 60),   ri(OP_LW, 16, 0, 60),   ri(OP_BEQZ, 0, 16, 1),  rr(OP_HLT, 0, 0, 0),
+        ri(OP_ADDI, 17, 0, 1),  ri(OP_SW, 17, 0, 61),
+    };
+    Iss iss;
+    for (size_t i = 0; i < all.size(); i++) iss.imem[i] = all[i];
+    iss.run(1000);
+    const uint32_t expect[] = {0, 5, 3, 8, 2, 1, 7, 1, 15, 0, 14, 15, 30, 0, 0, 28, 28, 0};
+    for (unsigned r = 0; r < 18; r++) {
+        char what[16];
+        snprintf(what, sizeof what, "R%u", r);
+        check(what, iss.reg[r], expect[r]);
+    }
+    check("Mem[55]", iss.dmem[55], 15);
+    check("Mem[60]", iss.dmem[60], 28);
+    check("Mem[61]", iss.dmem[61], 0);
+    check("halted", iss.halted, 1);
+
+    // unsigned compares , as Verilog compares the 32-bit regs
+    std::vector<uint32_t> cmp = {ri(OP_ADDI, 1, 0, -1), ri(OP_SLTI, 2, 0, -1), rr(OP_SLT, 3, 1, 0), rr(OP_HLT, 0, 0, 0)};
+    Iss u;
+    for (size_t i = 0; i < cmp.size(); i++) u.imem[i] = cmp[i];
+    u.run(10);
+    check("SLTI 0 < -1", u.reg[2], 1);
+    check("SLT -1 < 0", u.reg[3], 0);
+
+    // counter range : loads read 0 and are flagged , stores do not reach the aliased DMEM word
+    std::vector<uint32_t> perf = {ri(OP_ADDI, 1, 0, 7), ri(OP_SW, 1, 0, -256), ri(OP_LW, 2, 0, -255), rr(OP_HLT, 0, 0, 0)};
+    Iss pc;
+    for (size_t i = 0; i < perf.size(); i++) pc.imem[i] = perf[i];
+    pc.dmem[768] = 0xdeadbeef;
+    pc.step();
+    check("store to counters flagged", pc.step().perf, 1);
+    Retired pl = pc.step();
+    check("counter load flagged", pl.perf, 1);
+    check("counter load value", pl.value, 0);
+    check("Mem[768] untouched", pc.dmem[768], 0xdeadbeef);
+
+    // packed ops , lane by lane
+    std::vector<uint32_t> pk = {rr(OP_ADDB, 3, 1, 2),   rr(OP_SUBB, 4, 1, 2),   rr(OP_ADDH, 5, 1, 2),
+                                rr(OP_SUBH, 6, 1, 2),   rr(OP_ADDUSB, 7, 1, 2), rr(OP_ADDUSH, 8, 1, 2),
+                                rr(OP_CMPEQB, 9, 1, 2), rr(OP_CMPEQH, 10, 1, 1), rr(OP_CMPLTB, 11, 1, 2),
+                                rr(OP_CMPLTH, 12, 1, 2), rr(OP_SUMB, 13, 1, 2),  rr(OP_HLT, 0, 0, 0)};
+    Iss pi;
+    for (size_t i = 0; i < pk.size(); i++) pi.imem[i] = pk[i];
+    pi.reg[1] = 0x80ff1002;
+    pi.reg[2] = 0x80011003;
+    pi.run(20);
+    check("ADDB", pi.reg[3], 0x00002005);
+    check("SUBB", pi.reg[4], 0x00fe00ff);
+    check("ADDH", pi.reg[5], 0x01002005);
+    check("SUBH", pi.reg[6], 0x00feffff);
+    check("ADDUSB", pi.reg[7], 0xffff2005);
+    check("ADDUSH", pi.reg[8], 0xffff2005);
+    check("CMPEQB", pi.reg[9], 0xff00ff00);
+    check("CMPEQH", pi.reg[10], 0xffffffff);
+    check("CMPLTB", pi.reg[11], 0x000000ff);
+    check("CMPLTH", pi.reg[12], 0x0000ffff);
+    check("SUMB", pi.reg[13], 0x80 + 0xff + 0x10 + 0x02 + 0x80011003u);
+
+    // traps : a reserved opcode goes to the vector with EPC at it , ERET
+    // returns , CSRs are read and written in the counter range and the
+    // interrupt is only taken with IE set and EXL clear
+    std::vector<uint32_t> tr(EXC_VECTOR + 8, 0);
+    tr[0] = ri(OP_ADDI, 1, 0, 1);
+    tr[1] = ri(OP_SW, 1, 0, -256 + CSR_STATUS);   // STATUS.IE
+    tr[2] = 0x2au << 26;                           // reserved
+    tr[3] = ri(OP_LW, 3, 0, -256 + PERF_TRAPS);
+    tr[4] = rr(OP_HLT, 0, 0, 0);
+    tr[EXC_VECTOR] = ri(OP_LW, 4, 0, -256 + CSR_CAUSE);
+    tr[EXC_VECTOR + 1] = ri(OP_LW, 5, 0, -256 + CSR_EPC);
+    tr[EXC_VECTOR + 2] = ri(OP_ADDI, 5, 5, 1);
+    tr[EXC_VECTOR + 3] = ri(OP_SW, 5, 0, -256 + CSR_EPC);
+    tr[EXC_VECTOR + 4] = rr(OP_ERET, 0, 0, 0);
+    Iss ti;
+    for (size_t i = 0; i < tr.size(); i++) ti.imem[i] = tr[i];
+    ti.step();
+    check("interrupt with IE clear", ti.interrupt(), 0);
+    ti.step();
+    Retired rt = ti.step();
+    check("reserved traps", rt.trap, 1);
+    check("trap vector", rt.next_pc, EXC_VECTOR);
+    check("trap not retired", ti.retired, 2);
+    check("EXL set", ti.status, STATUS_IE | STATUS_EXL);
+    check("CSR load not flagged", ti.step().perf, 0);
+    check("CAUSE", ti.reg[4], CAUSE_RI);
+    ti.step();
+    check("EPC", ti.reg[5], 2);
+    ti.step();
+    ti.step();
+    check("interrupt with EXL set", ti.interrupt(), 0);
+    Retired re = ti.step();
+    check("ERET taken", re.taken, 1);
+    check("ERET to EPC", re.next_pc, 3);
+    check("EXL cleared", ti.status, STATUS_IE);
+    check("interrupt taken", ti.interrupt(), 1);
+    check("interrupt EPC", ti.epc, 3);
+    check("interrupt CAUSE", ti.cause, CAUSE_INT);
+    check("interrupt vector", ti.pc, EXC_VECTOR);
+    ti.run(100);
+    check("traps", ti.traps, 2);
+    check("traps halted", ti.halted, 1);
+
+    // nested loop kernel of sim/loop.hex : 169 instructions , 49 taken branches
+    std::vector<uint32_t> loop = {
+        ri(OP_ADDI, 3, 0, 5), ri(OP_ADDI, 2, 0, 0), ri(OP_ADDI, 1, 0, 10), rr(OP_ADD, 2, 2, 1),
+        ri(OP_SUBI, 1, 1, 1), ri(OP_BNEQZ, 0, 1, -3), ri(OP_SUBI, 3, 3, 1), ri(OP_BNEQZ, 0, 3, -6),
+        ri(OP_SW, 2, 0, 200), rr(OP_HLT, 0, 0, 0),
+    };
+    Iss l;
+    for (size_t i = 0; i < loop.size(); i++) l.imem[i] = loop[i];
+    l.run(1000);
+    check("loop R2", l.reg[2], 275);
+    check("loop Mem[200]", l.dmem[200], 275);
+    check("loop instructions", l.retired, 169);
+
+    // the same kernel with the inner loop on LOOP : no SUBI / BNEQZ per
+    // iteration , rs = 0 runs the body once
+    std::vector<uint32_t> hl = {
+        ri(OP_ADDI, 3, 0, 5), ri(OP_ADDI, 1, 0, 10), ri(OP_LOOP, 0, 1, 1), ri(OP_ADDI, 4, 4, 1),
+        rr(OP_ADD, 2, 2, 4), ri(OP_SUBI, 3, 3, 1), ri(OP_BNEQZ, 0, 3, -5), ri(OP_LOOP, 0, 0, 0),
+        ri(OP_ADDI, 5, 5, 1), ri(OP_SW, 2, 0, 200), rr(OP_HLT, 0, 0, 0),
+    };
+    Iss h;
+    for (size_t i = 0; i < hl.size(); i++) h.imem[i] = hl[i];
+    Retired hr;
+    do hr = h.step(); while (!hr.loop_tail);
+    check("LOOP back", hr.looped, 1);
+    check("LOOP start", hr.next_pc, 3);
+    check("LOOP count", h.loop_count, 9);
+    h.run(1000);
+    check("LOOP R2", h.reg[2], 50 * 51 / 2);
+    check("LOOP R5", h.reg[5], 1);
+    check("LOOP instructions", h.retired, 2 + 5 * (1 + 20 + 2) + 4);
+    check("LOOP off", h.loop_count, 0);
+
+    // a checkpoint in the middle of the LOOP body , through a file , goes on
+    // to the same end as the run it was taken from ; other memory sizes and
+    // a file that is no checkpoint are refused
+    Iss full, part;
+    for (size_t i = 0; i < hl.size(); i++) full.imem[i] = part.imem[i] = hl[i];
+    full.run(1000);
+    part.run(17);
+    check("checkpoint in the loop", part.loop_count != 0, 1);
+    Checkpoint ck, back, done;
+    part.save(ck);
+    check("checkpoint save", save_checkpoint("test_iss.ckpt", ck), 1);
+    check("checkpoint load", load_checkpoint("test_iss.ckpt", back), 1);
+    check("checkpoint round trip", checkpoint_diff(ck, back).size(), 0);
+    check("checkpoint retired", back.retired, 17);
+    Iss resumed;
+    check("checkpoint restore", resumed.restore(back), 1);
+    resumed.run(1000);
+    resumed.save(back);
+    full.save(done);
+    check("checkpoint resumed", checkpoint_diff(back, done).size(), 0);
+    check("checkpoint resumed instructions", resumed.retired, full.retired);
+    Iss small(512, 1024);
+    check("checkpoint sizes", small.restore(ck), 0);
+    FILE *ckf = fopen("test_iss.ckpt", "r+b");
+    fseek(ckf, 0, SEEK_END);
+    long ck_bytes = ftell(ckf);
+    fclose(ckf);
+    check("checkpoint bytes", ck_bytes, 8 + 4 + 4 + 8 + 8 + 32 * 4 + 6 * 4 + 4 + 1024 * 4 + 4 + 1024 * 4);
+    std::vector<uint32_t> words(1024);
+    save_hex("test_iss.ckpt", words, 4);   // a hex file is no checkpoint
+    check("checkpoint refused", load_checkpoint("test_iss.ckpt", back), 0);
+    remove("test_iss.ckpt");
+
+    // multiply / divide , as in mips_mdu_tb.v
+    std::vector<uint32_t> md = {
+        ri(OP_ADDI, 1, 0, 100), ri(OP_ADDI, 2, 0, 7),   rr(OP_DIV, 3, 1, 2),    rr(OP_MUL, 5, 1, 2),
+        ri(OP_ADDI, 6, 0, 0),   ri(OP_ADDI, 7, 0, 10),  rr(OP_ADD, 6, 6, 7),    ri(OP_SUBI, 7, 7, 1),
+        ri(OP_BNEQZ, 0, 7, -3), rr(OP_REM, 4, 1, 2),    rr(OP_ADD, 8, 3, 4),    rr(OP_DIV, 9, 1, 0),
+        rr(OP_REM, 10, 1, 0),   ri(OP_SW, 8, 0, 40),    rr(OP_HLT, 0, 0, 0),
+    };
+    Iss m;
+    for (size_t i = 0; i < md.size(); i++) m.imem[i] = md[i];
+    m.run(1000);
+    const uint32_t md_expect[] = {0, 100, 7, 14, 2, 700, 55, 0, 16, 0xffffffff, 100};
+    for (int r = 0; r <= 10; r++) {
+        char what[32];
+        snprintf(what, sizeof what, "mdu R%d", r);
+        check(what, m.reg[r], md_expect[r]);
+    }
+    check("mdu Mem[40]", m.dmem[40], 16);
+
+    // calls from two sites : JAL links NPC in R31 , JR R31 returns
+    std::vector<uint32_t> calls = {
+        ri(OP_ADDI, 1, 0, 3), OP_JAL << 26 | 6, OP_JAL << 26 | 6, ri(OP_SUBI, 1, 1, 1),
+        ri(OP_BNEQZ, 0, 1, -4), rr(OP_HLT, 0, 0, 0), rr(OP_ADD, 2, 2, 31), rr(OP_JR, 0, 31, 0),
+    };
+    Iss cl;
+    for (size_t i = 0; i < calls.size(); i++) cl.imem[i] = calls[i];
+    cl.run(1000);
+    check("calls R2", cl.reg[2], 3 * (2 + 3));
+    check("calls R31", cl.reg[31], 3);
+    check("calls instructions", cl.retired, 26);
+
+    // cycle model : fill , stalls and branch penalties
+    TimingConfig two, single, nofwd, nobp;
+    single.single_clock = true;
+    nofwd.forwarding = false;
+    nobp.bpred = false;
+    std::vector<uint32_t> straight = {ri(OP_ADDI, 1, 0, 1), ri(OP_ADDI, 2, 0, 2), ri(OP_ADDI, 3, 0, 3), rr(OP_HLT, 0, 0, 0)};
+    check("two-phase straight line", cycles_of(straight, two), 4 + 2);
+    check("single clock straight line", cycles_of(straight, single), 4 + 4);
+    std::vector<uint32_t> dep = {ri(OP_ADDI, 1, 0, 1), ri(OP_ADDI, 2, 1, 2), rr(OP_HLT, 0, 0, 0)};
+    check("two-phase forwarded RAW", cycles_of(dep, two), 3 + 2);
+    check("two-phase interlocked RAW", cycles_of(dep, nofwd), 3 + 2 + 1);
+    std::vector<uint32_t> lu = {ri(OP_LW, 1, 0, 0), rr(OP_ADD, 2, 1, 1), rr(OP_HLT, 0, 0, 0)};
+    check("two-phase load-use", cycles_of(lu, two), 3 + 2);
+    check("single clock load-use", cycles_of(lu, single), 3 + 4 + 1);
+    std::vector<uint32_t> br = {ri(OP_BEQZ, 0, 0, 1), ri(OP_ADDI, 1, 0, 1), rr(OP_HLT, 0, 0, 0)};
+    check("two-phase taken branch", cycles_of(br, two), 2 + 2 + 1);
+    check("single clock taken branch", cycles_of(br, single), 2 + 4 + 2);
+    check("two-phase loop without predictor", cycles_of(loop, nobp), 169 + 2 + 49);
+    // MDU : a divide writes back 33 edges after it leaves EX , a consumer and
+    // HLT wait for it in ID while independent instructions go on
+    TimingConfig mul3;
+    mul3.mul_latency = 3;
+    uint64_t mdu_stalls;
+    std::vector<uint32_t> dv = {ri(OP_ADDI, 1, 0, 9), ri(OP_ADDI, 2, 0, 2), rr(OP_DIV, 3, 1, 2), ri(OP_ADDI, 4, 0, 1),
+                                ri(OP_ADDI, 5, 0, 1), rr(OP_ADD, 6, 3, 3), rr(OP_HLT, 0, 0, 0)};
+    check("two-phase divide consumer", cycles_of(dv, two, nullptr, nullptr, &mdu_stalls), 7 + 2 + 31);
+    check("two-phase divide consumer stalls", mdu_stalls, 31);
+    check("single clock divide", cycles_of(dv, single), 7 + 4 + 33);
+    std::vector<uint32_t> dh = {ri(OP_ADDI, 1, 0, 9), ri(OP_ADDI, 2, 0, 2), rr(OP_DIV, 3, 1, 2), rr(OP_HLT, 0, 0, 0)};
+    check("two-phase divide drained by HLT", cycles_of(dh, two), 4 + 2 + 33);
+    std::vector<uint32_t> mu = {ri(OP_ADDI, 1, 0, 3), rr(OP_MUL, 2, 1, 1), rr(OP_ADD, 3, 2, 2), rr(OP_HLT, 0, 0, 0)};
+    check("two-phase EX multiplier", cycles_of(mu, two), 4 + 2);
+    check("two-phase 3-stage multiplier", cycles_of(mu, mul3), 4 + 2 + 3);
+    uint64_t serial = cycles_of(md, single);
+    uint64_t overlapped = cycles_of(md, two, nullptr, nullptr, &mdu_stalls);
+    if (overlapped + 30 >= serial || mdu_stalls >= 4 * 33) {
+        printf("FAIL divide latency not hidden : %llu cycles , %llu MDU stalls , single clock %llu cycles\n",
+               (unsigned long long)overlapped, (unsigned long long)mdu_stalls, (unsigned long long)serial);
+        errors++;
+    }
+    // DUAL_ISSUE : independent ALU ops issue in pairs , HLT and a dependent
+    // op only go first
+    TimingConfig dual;
+    dual.dual_issue = true;
+    check("dual-issue straight line", cycles_of(straight, dual), 3 + 2);
+    check("dual-issue dependent pair", cycles_of(dep, dual), 3 + 2);
+    check("dual-issue divide drained by HLT", cycles_of(dh, dual), 3 + 2 + 33);
+    if (cycles_of(loop, dual) >= cycles_of(loop, two)) {
+        printf("FAIL dual issue saved nothing on the loop\n");
+        errors++;
+    }
+    // J / JAL cost nothing in the two-phase pipeline , the return-address
+    // stack predicts both return targets where the BTB keeps only one
+    TimingConfig noras;
+    noras.ras_entries = 0;
+    uint64_t branches, flushed, flushed_noras;
+    uint64_t cc = cycles_of(calls, two, &branches, &flushed);
+    check("two-phase calls branches", branches, 3 + 6);
+    check("two-phase calls cycles", cc, 26 + 2 + flushed);
+    cc = cycles_of(calls, noras, nullptr, &flushed_noras);
+    check("two-phase calls without RAS", cc, 26 + 2 + flushed_noras);
+    if (flushed > 2 || flushed_noras < flushed + 4) {
+        printf("FAIL returns not predicted : %llu flushed slots , %llu without the RAS\n",
+               (unsigned long long)flushed, (unsigned long long)flushed_noras);
+        errors++;
+    }
+    check("single clock calls", cycles_of(calls, single), 26 + 4 + 2 * (6 + 6 + 2));
+
+    uint64_t c = cycles_of(loop, two, &branches, &flushed);
+    check("two-phase loop branches", branches, 55);
+    check("two-phase loop cycles", c, 169 + 2 + flushed);
+    if (flushed >= 49) {
+        printf("FAIL predictor saved nothing : %llu flushed slots\n", (unsigned long long)flushed);
+        errors++;
+    }
+
+    // LOOP : one squashed slot per setup from EX_MEM , none from ID , and
+    // going back at the end of the body costs nothing either way
+    TimingConfig eb;
+    eb.early_branch = true;
+    const uint64_t hn = 2 + 5 * 23 + 4;
+    c = cycles_of(hl, two, &branches, &flushed);
+    check("two-phase LOOP branches", branches, 5);
+    check("two-phase LOOP cycles", c, hn + 2 + flushed);
+    if (flushed > 6 + 2) {
+        printf("FAIL LOOP costs more than its setup : %llu flushed slots\n", (unsigned long long)flushed);
+        errors++;
+    }
+    check("early LOOP cycles", cycles_of(hl, eb), hn + 2);
+    if (cycles_of(hl, dual) >= cycles_of(hl, two)) {
+        printf("FAIL dual issue saved nothing on the LOOP kernel\n");
+        errors++;
+    }
+
+    // MIPS_1clk sets LOOP up from EX like a taken branch , two squashed
+    // slots per LOOP and per taken BNEQZ
+    check("single clock LOOP cycles", cycles_of(hl, single), hn + 4 + 2 * (6 + 4));
+    // the reserved word traps from WB , squashing four slots ; five handler
+    // words with one load-use bubble , ERET taken from EX , two words back
+    check("single clock trap cycles", cycles_of(tr, single), 3 + 4 + 5 + 1 + 2 + 2 + 4);
+
+    if (errors == 0) printf("PASS\n");
+    else printf("FAIL : %d mismatches\n", errors);
+    return errors != 0;
+}
@@ -0,0 +1,153 @@
+// Commit trace regression : a hand-made two-phase run (a stall in ID , a
+// flush , a pair and an MDU slot) must read back as written , compress the
+// straight-line cycles to a few bytes , and give the stage cycles of each
+// instruction back ; a cut-short file must be reported.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "mips_isa.h"
+#include "trace.h"
+
+using namespace mips;
+
+static int errors = 0;
+
+static void check(const char *what, uint64_t got, uint64_t expected) {
+    if (got != expected) {
+        printf("FAIL %s : %llu , expected %llu\n", what, (unsigned long long)got, (unsigned long long)expected);
+        errors++;
+    }
+}
+
+static std::string file_bytes(const std::string &path) {
+    std::string bytes;
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f) return bytes;
+    for (int b; (b = fgetc(f)) != EOF;) bytes += (char)b;
+    fclose(f);
+    return bytes;
+}
+
+static void stage(TraceCycle &c, int s, uint32_t pc, bool held = false) {
+    c.valid[s] = true;
+    c.pc[s] = pc;
+    c.held[s] = held;
+}
+
+static void retire(TraceCycle &c, uint32_t pc, uint32_t ir, int dest, uint32_t value, bool late = false) {
+    TraceSlot &r = c.slot[c.retired++];
+    r.pc = pc;
+    r.ir = ir;
+    r.dest = dest;
+    r.value = value;
+    r.late = late;
+}
+
+int main() {
+    // 0 ADDI , 1 ADD held one cycle in ID behind it , 2 BNEQZ redirecting
+    // from MEM to 8 , 8 / 9 a pair , 10 DIV leaving WB before its result
+    std::vector<TraceCycle> run(9);
+    stage(run[0], ST_IF, 0); stage(run[0], ST_ID, 0);
+    stage(run[1], ST_IF, 1); stage(run[1], ST_ID, 1); stage(run[1], ST_EX, 0); stage(run[1], ST_MEM, 0);
+    stage(run[2], ST_ID, 1, true); run[2].flags = C_HAZARD;
+    retire(run[2], 0, ri(OP_ADDI, 1, 0, 5), 1, 5);
+    stage(run[3], ST_IF, 2); stage(run[3], ST_ID, 2); stage(run[3], ST_EX, 1); stage(run[3], ST_MEM, 1);
+    stage(run[4], ST_IF, 3); stage(run[4], ST_ID, 3); stage(run[4], ST_EX, 2); stage(run[4], ST_MEM, 2);
+    retire(run[4], 1, rr(OP_ADD, 2, 1, 1), 2, 10);
+    stage(run[5], ST_IF, 8); stage(run[5], ST_ID, 8); run[5].flags = C_FLUSH; run[5].flush_pc = 2;
+    retire(run[5], 2, ri(OP_BNEQZ, 0, 2, 5), -1, 0);
+    stage(run[6], ST_IF, 10); stage(run[6], ST_ID, 10); stage(run[6], ST_EX, 8); stage(run[6], ST_MEM, 8);
+    stage(run[7], ST_EX, 10); stage(run[7], ST_MEM, 10);
+    retire(run[7], 8, ri(OP_ADDI, 3, 0, 1), 3, 1); retire(run[7], 9, ri(OP_ADDI, 4, 0, 2), 4, 2);
+    retire(run[8], 10, rr(OP_DIV, 5, 2, 1), -1, 0, true); run[8].flags = C_MDU;
+
+    const std::string path = "test_trace.bin";
+    TraceWriter out;
+    check("open for writing", out.open(path, TRACE_TWO_PHASE), 1);
+    for (const TraceCycle &c : run) out.write(c);
+    check("close", out.close(), 1);
+
+    TraceReader in;
+    check("open for reading", in.open(path), 1);
+    check("two-phase", in.two_phase(), 1);
+    std::vector<TraceCycle> back;
+    TraceCycle c;
+    while (in.next(c)) back.push_back(c);
+    check("not truncated", in.truncated(), 0);
+    check("cycles", back.size(), run.size());
+    for (size_t i = 0; i < back.size() && i < run.size(); i++) {
+        check("flags", back[i].flags, run[i].flags);
+        check("retired", back[i].retired, run[i].retired);
+        for (int s = 0; s < 4; s++) {
+            check("valid", back[i].valid[s], run[i].valid[s]);
+            if (run[i].valid[s]) check("pc", back[i].pc[s], run[i].pc[s]);
+            if (run[i].valid[s]) check("held", back[i].held[s], run[i].held[s]);
+        }
+        if (run[i].flags & C_FLUSH) check("flush pc", back[i].flush_pc, run[i].flush_pc);
+        for (int k = 0; k < run[i].retired; k++) {
+            check("slot pc", back[i].slot[k].pc, run[i].slot[k].pc);
+            check("slot ir", back[i].slot[k].ir, run[i].slot[k].ir);
+            check("slot dest", (uint64_t)(back[i].slot[k].dest + 1), (uint64_t)(run[i].slot[k].dest + 1));
+            check("slot value", back[i].slot[k].value, run[i].slot[k].value);
+            check("slot late", back[i].slot[k].late, run[i].slot[k].late);
+        }
+    }
+
+    // straight-line code : after the first cycle , IF .. MEM one word on
+    // from the last cycle and one instruction retired at the next PC
+    // without a destination is 2 + 1 + 4 bytes (the first PC , 0 , is
+    // already "the last + 1")
+    const std::string line = "test_trace_line.bin";
+    TraceWriter lw;
+    check("open straight line", lw.open(line, TRACE_TWO_PHASE), 1);
+    for (uint32_t i = 0; i < 100; i++) {
+        TraceCycle s;
+        for (int k = 0; k < 4; k++) stage(s, k, 100 + i - k / 2);
+        retire(s, i, ri(OP_SW, 1, 0, 50), -1, 0);
+        lw.write(s);
+    }
+    check("close straight line", lw.close(), 1);
+    check("straight line bytes", file_bytes(line).size(), 8 + (2 + 16 + 5) + 99 * 7);
+    remove(line.c_str());
+
+    // stage cycles , F D X M W
+    std::vector<PipeRow> rows = pipe_rows(back, 100, 0, true);
+    check("rows", rows.size(), 6);
+    const uint64_t expect[6][5][2] = {
+        {{100, 100}, {100, 100}, {101, 101}, {101, 101}, {102, 102}},   // ADDI
+        {{101, 101}, {101, 102}, {103, 103}, {103, 103}, {104, 104}},   // ADD , held in ID
+        {{103, 103}, {103, 103}, {104, 104}, {104, 104}, {105, 105}},   // BNEQZ
+        {{105, 105}, {105, 105}, {106, 106}, {106, 106}, {107, 107}},   // pair
+        {{105, 105}, {105, 105}, {106, 106}, {106, 106}, {107, 107}},
+        {{106, 106}, {106, 106}, {107, 107}, {107, 107}, {108, 108}},   // DIV
+    };
+    for (size_t i = 0; i < rows.size() && i < 6; i++)
+        for (int s = 0; s < 5; s++) {
+            check("first", rows[i].first[s], expect[i][s][0]);
+            check("last", rows[i].last[s], expect[i][s][1]);
+        }
+    check("second slot pc", rows.size() > 4 ? rows[4].pc : 0, 9);
+    // from the BNEQZ on , IF and ID of the first rows are outside the window
+    rows = pipe_rows(std::vector<TraceCycle>(back.begin() + 4, back.end()), 104, 1, true);
+    check("window rows", rows.size(), 4);
+    check("window first", rows.size() ? rows[0].pc : 0, 2);
+
+    // cut short in the middle of a word
+    std::string bytes = file_bytes(path);
+    FILE *f = fopen(path.c_str(), "wb");
+    fwrite(bytes.data(), 1, bytes.size() - 2, f);
+    fclose(f);
+    TraceReader cut;
+    check("open cut", cut.open(path), 1);
+    size_t n = 0;
+    while (cut.next(c)) n++;
+    check("cut cycles", n, run.size() - 1);
+    check("truncated", cut.truncated(), 1);
+    remove(path.c_str());
+
+    if (errors == 0) printf("PASS\n");
+    else printf("FAIL : %d mismatches\n", errors);
+    return errors != 0;
+}
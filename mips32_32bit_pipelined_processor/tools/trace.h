@@ -0,0 +1,239 @@
+// Commit trace : a compact binary record of an RTL run , one record per
+// cycle , written by the Verilator harness (--trace FILE) and read by
+// mips_trace. A few bytes a cycle instead of every signal in a VCD.
+//
+// File : an 8-byte header , "MTRC" , a version byte , TRACE_* flags and two
+// zero bytes , then the cycles in order until HALTED. A cycle is
+//   u8   flags      retired count (bits 1:0) , C_HAZARD , C_MDU , C_MEM ,
+//                   C_FETCH (stall reasons , from the counters) , C_FLUSH ,
+//                   C_TRAP
+//   u8   stages     two bits each for IF , ID , EX , MEM (IF in bits 1:0) :
+//                   S_EMPTY , S_HELD (the same instruction as last cycle) ,
+//                   S_NEXT (a new one at the stage's last PC + 1) , S_PC
+//   u32  pc         for each S_PC stage , in stage order
+//   u32  pc         of the redirecting instruction , with C_FLUSH
+//   per retired instruction (WB , first slot first)
+//     u8   slot     dest register (4:0) , R_DEST , R_NEXT (PC is the last
+//                   retired PC + 1) , R_LATE (MDU slot : written back later)
+//     u32  pc       without R_NEXT
+//     u32  ir
+//     u32  value    with R_DEST , the register after WB
+// All words little-endian. A stage holds the instruction it works on in the
+// cycle : with the two-phase MIPS IF and ID (clk1 , clk2) , then EX and MEM ,
+// share a cycle , with MIPS_1clk each stage has its own.
+#ifndef MIPS_TRACE_H
+#define MIPS_TRACE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace mips {
+
+enum TraceFlag : uint8_t { TRACE_TWO_PHASE = 1 };
+enum TraceStage { ST_IF = 0, ST_ID = 1, ST_EX = 2, ST_MEM = 3, ST_WB = 4 };
+
+const uint8_t C_HAZARD = 0x04, C_MDU = 0x08, C_MEM = 0x10, C_FETCH = 0x20, C_FLUSH = 0x40, C_TRAP = 0x80;
+const uint8_t S_EMPTY = 0, S_HELD = 1, S_NEXT = 2, S_PC = 3;
+const uint8_t R_DEST = 0x20, R_NEXT = 0x40, R_LATE = 0x80;
+
+struct TraceSlot {
+    uint32_t pc = 0, ir = 0;
+    int dest = -1;          // register written at WB , -1 for none or late
+    uint32_t value = 0;
+    bool late = false;      // MDU slot , its result comes back later
+};
+
+struct TraceCycle {
+    uint8_t flags = 0;      // C_* , without the retired count
+    bool valid[4] = {};     // IF .. MEM hold an instruction ...
+    bool held[4] = {};      // ... the one they held last cycle
+    uint32_t pc[4] = {};
+    uint32_t flush_pc = 0;  // with C_FLUSH
+    int retired = 0;
+    TraceSlot slot[2];
+};
+
+class TraceWriter {
+public:
+    bool open(const std::string &path, uint8_t trace_flags) {
+        f = fopen(path.c_str(), "wb");
+        if (!f) return false;
+        const uint8_t head[8] = {'M', 'T', 'R', 'C', 1, trace_flags, 0, 0};
+        fwrite(head, 1, 8, f);
+        return true;
+    }
+    void write(const TraceCycle &c) {
+        uint8_t codes = 0;
+        for (int s = 0; s < 4; s++) {
+            uint8_t code = !c.valid[s] ? S_EMPTY : (c.held[s] && last_valid[s] && c.pc[s] == last_pc[s]) ? S_HELD :
+                           (last_valid[s] && c.pc[s] == last_pc[s] + 1) ? S_NEXT : S_PC;
+            codes |= code << (2 * s);
+        }
+        byte((uint8_t)((c.flags & 0xfc) | c.retired));
+        byte(codes);
+        for (int s = 0; s < 4; s++) {
+            if (((codes >> (2 * s)) & 3) == S_PC) word(c.pc[s]);
+            if (c.valid[s]) last_pc[s] = c.pc[s];
+            last_valid[s] = c.valid[s];
+        }
+        if (c.flags & C_FLUSH) word(c.flush_pc);
+        for (int k = 0; k < c.retired; k++) {
+            const TraceSlot &r = c.slot[k];
+            bool dest = r.dest >= 0 && !r.late, next = r.pc == last_retired + 1;
+            byte((uint8_t)((dest ? r.dest : 0) | (dest ? R_DEST : 0) | (next ? R_NEXT : 0) | (r.late ? R_LATE : 0)));
+            if (!next) word(r.pc);
+            word(r.ir);
+            if (dest) word(r.value);
+            last_retired = r.pc;
+        }
+    }
+    bool close() {
+        bool ok = f && fclose(f) == 0;
+        f = nullptr;
+        return ok;
+    }
+    ~TraceWriter() { if (f) fclose(f); }
+
+private:
+    void byte(uint8_t b) { fputc(b, f); }
+    void word(uint32_t w) {
+        const uint8_t b[4] = {(uint8_t)w, (uint8_t)(w >> 8), (uint8_t)(w >> 16), (uint8_t)(w >> 24)};
+        fwrite(b, 1, 4, f);
+    }
+    FILE *f = nullptr;
+    uint32_t last_pc[4] = {};
+    bool last_valid[4] = {};
+    uint32_t last_retired = 0xffffffff;
+};
+
+class TraceReader {
+public:
+    // Returns false (with *err) if the file cannot be read or is no trace.
+    bool open(const std::string &path, std::string *err = nullptr) {
+        f = fopen(path.c_str(), "rb");
+        uint8_t head[8];
+        if (!f || fread(head, 1, 8, f) != 8 || head[0] != 'M' || head[1] != 'T' || head[2] != 'R' ||
+            head[3] != 'C' || head[4] != 1) {
+            if (err) *err = f ? path + " is not a version 1 commit trace" : "cannot open " + path;
+            return false;
+        }
+        flags = head[5];
+        return true;
+    }
+    // The next cycle , false at the end of the trace (truncated() tells a
+    // record cut short).
+    bool next(TraceCycle &c) {
+        int b = fgetc(f);
+        if (b == EOF) return false;
+        c = TraceCycle();
+        c.flags = (uint8_t)(b & 0xfc);
+        c.retired = b & 3;
+        int codes = fgetc(f);
+        if (codes == EOF) return cut();
+        for (int s = 0; s < 4; s++) {
+            uint8_t code = (codes >> (2 * s)) & 3;
+            c.valid[s] = code != S_EMPTY;
+            c.held[s] = code == S_HELD;
+            if (code == S_PC && !word(&last_pc[s])) return cut();
+            else if (code == S_NEXT) last_pc[s]++;
+            c.pc[s] = c.valid[s] ? last_pc[s] : 0;
+        }
+        if ((c.flags & C_FLUSH) && !word(&c.flush_pc)) return cut();
+        for (int k = 0; k < c.retired; k++) {
+            TraceSlot &r = c.slot[k];
+            int s = fgetc(f);
+            if (s == EOF) return cut();
+            r.pc = last_retired + 1;
+            if (!(s & R_NEXT) && !word(&r.pc)) return cut();
+            if (!word(&r.ir)) return cut();
+            r.late = s & R_LATE;
+            if (s & R_DEST) {
+                r.dest = s & 31;
+                if (!word(&r.value)) return cut();
+            }
+            last_retired = r.pc;
+        }
+        return true;
+    }
+    bool two_phase() const { return flags & TRACE_TWO_PHASE; }
+    bool truncated() const { return cut_short; }
+    ~TraceReader() { if (f) fclose(f); }
+
+private:
+    bool word(uint32_t *w) {
+        uint8_t b[4];
+        if (fread(b, 1, 4, f) != 4) return false;
+        *w = b[0] | b[1] << 8 | b[2] << 16 | (uint32_t)b[3] << 24;
+        return true;
+    }
+    bool cut() { cut_short = true; return false; }
+    FILE *f = nullptr;
+    uint8_t flags = 0;
+    uint32_t last_pc[4] = {};
+    uint32_t last_retired = 0xffffffff;
+    bool cut_short = false;
+};
+
+// One retired instruction of a pipeline diagram : the cycles it spent in
+// each stage , first[s] > last[s] where it was not seen (e.g. IF and ID
+// before the window).
+struct PipeRow {
+    uint32_t pc = 0, ir = 0;
+    uint64_t first[5], last[5];
+};
+
+// Rebuilds the stage cycles of every instruction retired in cycles
+// [from , cycles.size()) , cycles[0] being cycle base. Each stage is walked
+// back from WB : the latest stretch in the stage before that starts no later
+// than the next stage's first cycle (the same cycle where the two share one ,
+// as IF / ID and EX / MEM do on the two-phase MIPS) must be the same PC ; for
+// IF , which the fetch queue lets run ahead , the latest with the same PC.
+inline std::vector<PipeRow> pipe_rows(const std::vector<TraceCycle> &cycles, uint64_t base, size_t from, bool two_phase) {
+    // stretches of one instruction per stage : start , end , pc
+    struct Stretch { size_t start, end; uint32_t pc; };
+    std::vector<Stretch> runs[4];
+    for (size_t i = 0; i < cycles.size(); i++)
+        for (int s = 0; s < 4; s++) {
+            if (!cycles[i].valid[s]) continue;
+            if (cycles[i].held[s] && !runs[s].empty() && runs[s].back().end == i - 1 && runs[s].back().pc == cycles[i].pc[s])
+                runs[s].back().end = i;
+            else
+                runs[s].push_back({i, i, cycles[i].pc[s]});
+        }
+    const bool shared[4] = {two_phase, false, two_phase, false};   // stage s shares its last cycle with s + 1
+    std::vector<PipeRow> rows;
+    for (size_t i = from; i < cycles.size(); i++)
+        for (int k = 0; k < cycles[i].retired; k++) {
+            PipeRow row;
+            row.pc = cycles[i].slot[k].pc;
+            row.ir = cycles[i].slot[k].ir;
+            for (int s = 0; s < 5; s++) row.first[s] = 1, row.last[s] = 0;
+            row.first[ST_WB] = row.last[ST_WB] = base + i;
+            size_t bound = i;   // first cycle of the stage after
+            // a pair's second slot was not traced through IF .. MEM , its first slot's stages stand for it
+            uint32_t pc = k ? cycles[i].slot[0].pc : row.pc;
+            for (int s = ST_MEM; s >= ST_IF; s--) {
+                const Stretch *hit = nullptr;
+                for (size_t r = runs[s].size(), seen = 0; r-- > 0 && seen < 16;) {
+                    const Stretch &st = runs[s][r];
+                    if (st.start > bound || (!shared[s] && st.start == bound)) continue;
+                    if (st.pc == pc) hit = &st;
+                    // IF runs ahead into the fetch queue , look past the words fetched behind it
+                    if (hit || s != ST_IF) break;
+                    seen++;
+                }
+                if (!hit) break;
+                row.first[s] = base + hit->start;
+                row.last[s] = base + hit->end;
+                bound = hit->start;
+            }
+            rows.push_back(row);
+        }
+    return rows;
+}
+
+} // namespace mips
+
+#endif
@@ -0,0 +1,228 @@
+// mips_trace : reads a commit trace of the Verilator harness (--trace).
+//
+//   mips_trace trace.bin [--hot N] [--stages CYCLE:COUNT] [--pipe INSTR:COUNT]
+//
+// Prints the totals (cycles , instructions , CPI , stall cycles by reason ,
+// flushes , traps , trace bytes per cycle) and the N hottest instructions
+// (default 10) : times retired , stall cycles charged to them and redirects
+// they caused , the sum as a share of all cycles. A hazard or MDU stall is
+// charged to the instruction held in ID , a data-cache stall to the one in
+// MEM , an I-cache stall to the PC IF waits on.
+// --stages prints COUNT cycles from CYCLE , one line each with what IF , ID ,
+// EX , MEM and WB work on ('=' : held from the cycle before) and the stall ,
+// flush and trap reasons.
+// --pipe draws COUNT retired instructions from the INSTR-th (from 0) , one
+// row each with the stage letters F D X M W under the cycles they spent
+// there (lower case : held). On the two-phase MIPS F / D and X / M share a
+// cycle.
+// Instructions are disassembled from the words retired in the trace ; a PC
+// that never retired (a wrong path) shows as '?'.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "asm.h"
+#include "trace.h"
+
+using namespace mips;
+
+namespace {
+
+struct Hot {
+    uint64_t retired = 0, stalls = 0, flushes = 0;
+};
+
+void usage() {
+    fprintf(stderr, "usage: mips_trace trace.bin [--hot N] [--stages CYCLE:COUNT] [--pipe INSTR:COUNT]\n");
+    exit(2);
+}
+
+bool range(const char *s, uint64_t *first, uint64_t *count) {
+    unsigned long long a, b;
+    if (sscanf(s, "%llu:%llu", &a, &b) != 2) return false;
+    *first = a;
+    *count = b;
+    return true;
+}
+
+std::string mnemonic(const std::map<uint32_t, uint32_t> &words, uint32_t pc) {
+    auto w = words.find(pc);
+    if (w == words.end()) return "?";
+    std::string d = disassemble(w->second, pc);
+    return d.substr(0, d.find(' '));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string path;
+    size_t hot_n = 10;
+    uint64_t stage_first = 0, stage_count = 0, pipe_first = 0, pipe_count = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> const char * { if (i + 1 >= argc) usage(); return argv[++i]; };
+        if (a == "--hot") hot_n = strtoul(next(), nullptr, 0);
+        else if (a == "--stages") { if (!range(next(), &stage_first, &stage_count)) usage(); }
+        else if (a == "--pipe") { if (!range(next(), &pipe_first, &pipe_count)) usage(); }
+        else if (a[0] != '-' && path.empty()) path = a;
+        else usage();
+    }
+    if (path.empty()) usage();
+
+    TraceReader in;
+    std::string err;
+    if (!in.open(path, &err)) {
+        fprintf(stderr, "%s\n", err.c_str());
+        return 2;
+    }
+
+    // one pass : totals , hotspots , the words retired at each PC , and the
+    // cycles the two windows need (--pipe keeps PIPE_BEFORE cycles ahead of
+    // its first instruction's WB for the stages before)
+    const size_t PIPE_BEFORE = 256;
+    std::map<uint32_t, uint32_t> words;
+    std::map<uint32_t, Hot> hot;
+    uint64_t cycles = 0, retired = 0, flushes = 0, traps = 0;
+    uint64_t stalls[4] = {};   // hazard , MDU , data cache , instruction cache
+    std::vector<TraceCycle> stage_win;
+    std::deque<TraceCycle> pipe_win;
+    uint64_t pipe_base = 0;    // cycle of pipe_win[0]
+    size_t pipe_from = 0;      // index in pipe_win of the cycle retiring instruction pipe_first ...
+    uint64_t pipe_skip = 0;    // ... after this many (its pair's first slot)
+    bool pipe_started = false;
+    TraceCycle c;
+    while (in.next(c)) {
+        const uint8_t reason[4] = {C_HAZARD, C_MDU, C_MEM, C_FETCH};
+        const int stage[4] = {ST_ID, ST_ID, ST_MEM, ST_IF};
+        for (int k = 0; k < 4; k++)
+            if (c.flags & reason[k]) {
+                stalls[k]++;
+                if (c.valid[stage[k]]) hot[c.pc[stage[k]]].stalls++;
+            }
+        if (c.flags & C_FLUSH) {
+            flushes++;
+            hot[c.flush_pc].flushes++;
+        }
+        if (c.flags & C_TRAP) traps++;
+        for (int k = 0; k < c.retired; k++) {
+            words[c.slot[k].pc] = c.slot[k].ir;
+            hot[c.slot[k].pc].retired++;
+        }
+
+        if (cycles >= stage_first && cycles < stage_first + stage_count) stage_win.push_back(c);
+        if (pipe_count && retired < pipe_first + pipe_count) {
+            if (!pipe_started && retired + c.retired > pipe_first) {
+                pipe_started = true;
+                pipe_from = pipe_win.size();
+                pipe_skip = pipe_first - retired;
+            }
+            pipe_win.push_back(c);
+            if (!pipe_started && pipe_win.size() > PIPE_BEFORE) {
+                pipe_win.pop_front();
+                pipe_base++;
+            }
+        }
+        retired += c.retired;
+        cycles++;
+    }
+    if (in.truncated()) fprintf(stderr, "%s : the last record is cut short\n", path.c_str());
+
+    FILE *f = fopen(path.c_str(), "rb");
+    long bytes = 0;
+    if (f && !fseek(f, 0, SEEK_END)) bytes = ftell(f);
+    if (f) fclose(f);
+    printf("%llu cycles , %llu instructions , CPI %.2f , %s\n", (unsigned long long)cycles,
+           (unsigned long long)retired, retired ? (double)cycles / retired : 0.0,
+           in.two_phase() ? "MIPS (two-phase)" : "MIPS_1clk");
+    printf("stall cycles : %llu hazard , %llu MDU , %llu data cache , %llu instruction cache ; %llu flushes , "
+           "%llu traps\n", (unsigned long long)stalls[0], (unsigned long long)stalls[1],
+           (unsigned long long)stalls[2], (unsigned long long)stalls[3], (unsigned long long)flushes,
+           (unsigned long long)traps);
+    printf("trace : %ld bytes , %.2f per cycle\n", bytes, cycles ? (double)bytes / cycles : 0.0);
+
+    // HOTSPOTS
+    if (hot_n) {
+        std::vector<std::pair<uint32_t, Hot>> top(hot.begin(), hot.end());
+        auto cost = [](const Hot &h) { return h.retired + h.stalls + h.flushes; };
+        std::stable_sort(top.begin(), top.end(), [&](const std::pair<uint32_t, Hot> &a, const std::pair<uint32_t, Hot> &b) {
+            return cost(a.second) > cost(b.second);
+        });
+        printf("\n      pc  instruction            retired   stalls  flushes   share %%\n");
+        for (size_t i = 0; i < top.size() && i < hot_n; i++) {
+            auto w = words.find(top[i].first);
+            std::string d = w == words.end() ? "?" : disassemble(w->second, top[i].first);
+            const Hot &h = top[i].second;
+            printf("%8x  %-20s %9llu %8llu %8llu %9.1f\n", top[i].first, d.c_str(), (unsigned long long)h.retired,
+                   (unsigned long long)h.stalls, (unsigned long long)h.flushes,
+                   cycles ? 100.0 * cost(h) / cycles : 0.0);
+        }
+    }
+
+    // STAGES
+    if (!stage_win.empty()) {
+        printf("\n   cycle  %-12s  %-12s  %-12s  %-12s  %-12s  events\n", "IF", "ID", "EX", "MEM", "WB");
+        for (size_t i = 0; i < stage_win.size(); i++) {
+            const TraceCycle &s = stage_win[i];
+            printf("%8llu", (unsigned long long)(stage_first + i));
+            for (int k = 0; k < 4; k++) {
+                std::string cell;
+                if (s.valid[k]) {
+                    char pc[16];
+                    snprintf(pc, sizeof pc, "%x ", s.pc[k]);
+                    cell = pc + mnemonic(words, s.pc[k]) + (s.held[k] ? " =" : "");
+                }
+                printf("  %-12s", cell.c_str());
+            }
+            std::string wb;
+            for (int k = 0; k < s.retired; k++) {
+                char pc[16];
+                snprintf(pc, sizeof pc, "%s%x", k ? "+" : "", s.slot[k].pc);
+                wb += pc;
+            }
+            if (s.retired == 1) wb += " " + mnemonic(words, s.slot[0].pc);
+            printf("  %-12s ", wb.c_str());
+            if (s.flags & C_HAZARD) printf(" hazard");
+            if (s.flags & C_MDU) printf(" mdu");
+            if (s.flags & C_MEM) printf(" dcache");
+            if (s.flags & C_FETCH) printf(" icache");
+            if (s.flags & C_FLUSH) printf(" flush(%x)", s.flush_pc);
+            if (s.flags & C_TRAP) printf(" trap");
+            printf("\n");
+        }
+    }
+
+    // PIPELINE DIAGRAM
+    if (pipe_started) {
+        std::vector<TraceCycle> win(pipe_win.begin(), pipe_win.end());
+        std::vector<PipeRow> rows = pipe_rows(win, pipe_base, pipe_from, in.two_phase());
+        std::vector<PipeRow> shown;
+        for (size_t i = pipe_skip; i < rows.size() && shown.size() < pipe_count; i++) shown.push_back(rows[i]);
+        uint64_t lo = ~0ull, hi = 0;
+        for (const PipeRow &r : shown) {
+            for (int s = 0; s < 5; s++)
+                if (r.first[s] <= r.last[s]) {
+                    if (r.first[s] < lo) lo = r.first[s];
+                    if (r.last[s] > hi) hi = r.last[s];
+                }
+        }
+        const int width = in.two_phase() ? 2 : 1;
+        printf("\n      pc  instruction           cycle %llu\n", (unsigned long long)lo);
+        for (const PipeRow &r : shown) {
+            std::string line((size_t)(hi - lo + 1) * width, ' ');
+            for (int s = 0; s < 5; s++)
+                for (uint64_t t = r.first[s]; t <= r.last[s]; t++) {
+                    size_t at = (size_t)(t - lo) * width;
+                    while (at < (size_t)(t - lo + 1) * width - 1 && line[at] != ' ') at++;
+                    line[at] = (t == r.first[s] ? "FDXMW" : "fdxmw")[s];
+                }
+            printf("%8x  %-20s  %s\n", r.pc, disassemble(r.ir, r.pc).c_str(), line.c_str());
+        }
+    }
+    return in.truncated() ? 1 : 0;
+}